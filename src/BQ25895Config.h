@@ -3,6 +3,7 @@
 
 #include <Wire.h>
 #include <Arduino.h>
+#include "Log.h"
 
 // Forward-Deklaration für Log-Funktionen
 void addBqLog(const String& message);
@@ -57,12 +58,10 @@ public:
             Wire.begin(SDA_PIN, SCL_PIN);
             Wire.setClock(50000); // Reduziere I2C-Geschwindigkeit auf 50kHz
             delay(500);
-            Serial.println("🔋 Initialisiere BQ25895...");
-            addBqLog("Initialisiere BQ25895...");
+            LOGI(LOG_TAG_CHARGER, "🔋 Initialisiere BQ25895...");
 
             if (!isConnected()) {
-                Serial.println("❌ BQ25895 nicht erreichbar!");
-                addBqLog("ERROR: BQ25895 nicht erreichbar!");
+                LOGE(LOG_TAG_CHARGER, "❌ BQ25895 nicht erreichbar!");
                 return;
             }
 
@@ -78,8 +77,7 @@ public:
 
             // Prüfe, ob der Chip nach dem Reset erreichbar ist
             if (!isConnected()) {
-                Serial.println("❌ BQ25895 nach Reset nicht erreichbar!");
-                addBqLog("ERROR: BQ25895 nach Reset nicht erreichbar!");
+                LOGE(LOG_TAG_CHARGER, "❌ BQ25895 nach Reset nicht erreichbar!");
                 return;
             }
 
@@ -88,20 +86,18 @@ public:
                 addBqLog("Fehler beim Aktivieren des ADC");
             }
             delay(100);
-            Serial.println("🛠️ ADC aktiviert, TS-Überwachung aktiviert");
-            addBqLog("ADC aktiviert, TS-Überwachung aktiviert");
+            LOGI(LOG_TAG_CHARGER, "🛠️ ADC aktiviert, TS-Überwachung aktiviert");
             
             // Prüfe ADC-Status
             uint8_t reg07 = readRegister(0x07);
-            Serial.printf("ADC Status nach Aktivierung (REG07): 0x%02X\n", reg07);
+            LOGD(LOG_TAG_CHARGER, "ADC Status nach Aktivierung (REG07): 0x%02X", reg07);
             
             // Register 0x06: IR-Kompensation und Thermische Regulierung aktivieren
             if (!writeRegister(0x06, 0x32)) { // Thermische Regulierung aktivieren
                 addBqLog("Fehler beim Aktivieren der thermischen Regulierung");
             }
             delay(100);
-            Serial.println("🛠️ Thermische Regulierung aktiviert");
-            addBqLog("Thermische Regulierung aktiviert");
+            LOGI(LOG_TAG_CHARGER, "🛠️ Thermische Regulierung aktiviert");
             
             // FAULT Register zurücksetzen
             uint8_t fault = readRegister(0x0C);
@@ -127,8 +123,7 @@ public:
                 addBqLog("Fehler beim Setzen der SYS min voltage");
             }
             delay(100);
-            Serial.println("⚙️ SYS min voltage auf 3.3V gesetzt");
-            addBqLog("SYS min voltage auf 3.3V gesetzt");
+            LOGI(LOG_TAG_CHARGER, "⚙️ SYS min voltage auf 3.3V gesetzt");
 
             if (!writeRegister(0x01, 0x3C)) { // Safety Timer deaktivieren
                 addBqLog("Fehler beim Deaktivieren des Safety Timers");
@@ -137,8 +132,7 @@ public:
                 addBqLog("Fehler beim Deaktivieren des Watchdogs");
             }
             delay(100);
-            Serial.println("⏱️ Watchdog deaktiviert");
-            addBqLog("Safety Timer und Watchdog deaktiviert");
+            LOGI(LOG_TAG_CHARGER, "⏱️ Safety Timer und Watchdog deaktiviert");
             
             // Kontinuierliche Ladung aktivieren und STAT-Pin-Blinken deaktivieren
             uint8_t reg0A = readRegister(0x0A);
@@ -148,8 +142,7 @@ public:
                     addBqLog("Fehler beim Deaktivieren des STAT-Pin-Blinkens");
                 }
                 delay(100);
-                Serial.println("🔧 STAT-Pin-Blinken deaktiviert");
-                addBqLog("STAT-Pin-Blinken deaktiviert");
+                LOGI(LOG_TAG_CHARGER, "🔧 STAT-Pin-Blinken deaktiviert");
             }
             
             // Nochmals Fehler zurücksetzen
@@ -158,14 +151,12 @@ public:
 
             // Teste Spannungsmessung direkt nach Initialisierung
             float vbat = getVBAT();
-            Serial.printf("Initiale Spannungsmessung: %.3fV\n", vbat);
+            LOGD(LOG_TAG_CHARGER, "Initiale Spannungsmessung: %.3fV", vbat);
 
-            Serial.println("✅ Setup abgeschlossen.");
-            addBqLog("Setup erfolgreich abgeschlossen");
+            LOGI(LOG_TAG_CHARGER, "✅ Setup erfolgreich abgeschlossen");
             printStatus();
         } catch (...) {
-            Serial.println("❌ Schwerwiegender Fehler bei BQ25895-Initialisierung");
-            addBqLog("KRITISCHER FEHLER: Schwerwiegender Fehler bei BQ25895-Initialisierung");
+            LOGE(LOG_TAG_CHARGER, "❌ Schwerwiegender Fehler bei BQ25895-Initialisierung");
         }
     }
 
@@ -184,8 +175,7 @@ public:
 
         if (vbusNow != lastVBUSState) {
             if (vbusNow) {
-                Serial.println("🔌 VBUS wieder verfügbar → Ladebetrieb");
-                addBqLog("VBUS erkannt - Wechsel in Ladebetrieb");
+                LOGI(LOG_TAG_CHARGER, "🔌 VBUS erkannt - Wechsel in Ladebetrieb");
                 delay(100);
                 
                 // Fehler zurücksetzen
@@ -193,15 +183,13 @@ public:
                 
                 // REMOVED: forceDPDMDetection() um Charging-Resets zu verhindern
                 // Das forced protocol resettet den Ladevorgang ständig
-                Serial.println("ℹ️ DPDM-Erkennung übersprungen um Charging-Resets zu vermeiden");
-                addBqLog("DPDM-Erkennung übersprungen um Charging-Resets zu vermeiden");
+                LOGD(LOG_TAG_CHARGER, "DPDM-Erkennung übersprungen um Charging-Resets zu vermeiden");
                 delay(200);
                 
                 // Ladeparameter neu setzen
                 setChargingParams();
             } else {
-                Serial.println("🔋 Kein VBUS → Entladebetrieb");
-                addBqLog("VBUS entfernt - Wechsel in Entladebetrieb");
+                LOGI(LOG_TAG_CHARGER, "🔋 VBUS entfernt - Wechsel in Entladebetrieb");
             }
             lastVBUSState = vbusNow;
         }
@@ -212,7 +200,7 @@ public:
             // Fehler überprüfen und zurücksetzen wenn nötig
             uint8_t fault = readRegister(0x0C);
             if (fault != 0) {
-                addBqLog("Periodische Prüfung - Fehler gefunden: 0x" + String(fault, HEX));
+                LOGW(LOG_TAG_CHARGER, "Periodische Prüfung - Fehler gefunden: 0x%02X", fault);
                 clearFaults();
                 
                 // Ladeparameter neu setzen nach Fehler
@@ -227,8 +215,7 @@ public:
         if (reg != 0xFF) {
             reg |= 0x80;
             (void)writeRegister(0x02, reg);
-            Serial.println("🔁 DPDM-Erkennung neu gestartet");
-            addBqLog("DPDM-Erkennung neu gestartet");
+            LOGI(LOG_TAG_CHARGER, "🔁 DPDM-Erkennung neu gestartet");
         }
     }
 
@@ -247,17 +234,14 @@ public:
             // Standard-Ladestrom setzen - KORRIGIERT: Register 0x02 für Charge Current
             // 2048mA / 64mA = 32 = 0x20
             (void)writeRegister(0x02, 0x20);
-            addBqLog("Ladeparameter gesetzt: Input=1500mA, Charge=2048mA (Register 0x02)");
+            LOGI(LOG_TAG_CHARGER, "Ladeparameter gesetzt: Input=1500mA, Charge=2048mA (Register 0x02)");
         }
         
         // Jetzt die Register kontrollieren
         uint8_t reg00 = readRegister(0x00);
         uint8_t reg02 = readRegister(0x02);  // Korrigiert: 0x02 statt 0x04
         
-        addBqLog("Lade-Register überprüft: REG00=0x" + String(reg00, HEX) + 
-                 ", REG02=0x" + String(reg02, HEX) + " (Charge Current)");
-        
-        Serial.println("⚡ Ladeparameter neu gesetzt");
+        LOGI(LOG_TAG_CHARGER, "⚡ Lade-Register überprüft: REG00=0x%02X, REG02=0x%02X (Charge Current)", reg00, reg02);
     }
 
     bool setChargeCurrent(int currentMA) {
@@ -276,7 +260,7 @@ public:
         } else {
             // Maximum auf 2A begrenzen für Sicherheit
             limitedCurrent = 2000;
-            Serial.printf("WARNUNG: Ladestrom auf 2A begrenzt (angefordert: %dmA)\n", currentMA);
+            LOGW(LOG_TAG_CHARGER, "Ladestrom auf 2A begrenzt (angefordert: %dmA)", currentMA);
         }
         
         // KRITISCH: Speichere den angeforderten Wert für spätere Verwendung
@@ -291,7 +275,7 @@ public:
         // Register 0x02 lesen und nur die Ladestrom-Bits ändern (Bits 6:0)
         uint8_t reg02 = readRegister(0x02);
         if (reg02 == 0xFF) {
-            Serial.println("Fehler beim Lesen von Register 0x02 (CHARGE_CURRENT_CTRL)");
+            LOGE(LOG_TAG_CHARGER, "Fehler beim Lesen von Register 0x02 (CHARGE_CURRENT_CTRL)");
             return false;
         }
         
@@ -301,54 +285,40 @@ public:
         bool success = writeRegister(0x02, newReg02);
         
         if (success) {
-            Serial.printf("Ladestrom erfolgreich auf %dmA gesetzt (Register 0x02: 0x%02X)\n", limitedCurrent, newReg02);
+            LOGD(LOG_TAG_CHARGER, "Ladestrom erfolgreich auf %dmA gesetzt (Register 0x02: 0x%02X)", limitedCurrent, newReg02);
             
             // Verifikation: Register zurücklesen
             uint8_t verification = readRegister(0x02);
             if (verification != newReg02) {
-                Serial.printf("WARNUNG: Verifikation fehlgeschlagen! Erwartet: 0x%02X, Gelesen: 0x%02X\n", newReg02, verification);
+                LOGW(LOG_TAG_CHARGER, "Ladestrom-Verifikation fehlgeschlagen! Erwartet: 0x%02X, Gelesen: 0x%02X", newReg02, verification);
             } else {
-                Serial.println("Ladestrom-Einstellung verifiziert");
+                LOGV(LOG_TAG_CHARGER, "Ladestrom-Einstellung verifiziert");
             }
         } else {
-            Serial.printf("Fehler beim Setzen des Ladestroms auf %dmA\n", limitedCurrent);
+            LOGE(LOG_TAG_CHARGER, "Fehler beim Setzen des Ladestroms auf %dmA", limitedCurrent);
         }
         
         return success;
     }
 
     void printStatus() {
-        Serial.println("====== BQ25895 Status ======");
-        addBqLog("--- BQ25895 Status ---");
+        LOGI(LOG_TAG_CHARGER, "--- BQ25895 Status ---");
         uint8_t status = readRegister(0x0B);
         uint8_t fault  = readRegister(0x0C);
         
-        Serial.print("VBUS Status (0x0B): 0x"); 
-        Serial.println(status, HEX);
-        addBqLog("VBUS Status (0x0B): 0x" + String(status, HEX));
-        
-        Serial.print("FAULT (0x0C): 0x"); 
-        Serial.println(fault, HEX);
-        addBqLog("FAULT (0x0C): 0x" + String(fault, HEX));
+        LOGI(LOG_TAG_CHARGER, "VBUS Status (0x0B): 0x%02X", status);
+        LOGI(LOG_TAG_CHARGER, "FAULT (0x0C): 0x%02X", fault);
         
         // VBUS Status anzeigen
         if ((status >> 5) & 0x07) {
-            Serial.println("🔌 VBUS erkannt");
-            addBqLog("VBUS erkannt");
+            LOGI(LOG_TAG_CHARGER, "🔌 VBUS erkannt");
         } else {
-            Serial.println("❌ Kein VBUS erkannt");
-            addBqLog("Kein VBUS erkannt");
+            LOGI(LOG_TAG_CHARGER, "❌ Kein VBUS erkannt");
         }
 
-        // Temperatur-Status ausgeben
-        String tempStatus = getTemperatureStatus();
-        Serial.println("🌡️ Temperatur: " + tempStatus);
-        addBqLog("Temperatur: " + tempStatus);
-
-        // Lade-Status ausgeben
-        String chargeStatus = getChargeStatus();
-        Serial.println("⚡ Ladestatus: " + chargeStatus);
-        addBqLog("Ladestatus: " + chargeStatus);
+        // Temperatur- und Lade-Status ausgeben
+        LOGI(LOG_TAG_CHARGER, "🌡️ Temperatur: %s", getTemperatureStatus().c_str());
+        LOGI(LOG_TAG_CHARGER, "⚡ Ladestatus: %s", getChargeStatus().c_str());
 
         // Fehler prüfen
         if (fault != 0x00) {
@@ -370,11 +340,9 @@ public:
                 }
             }
             
-            Serial.println("⚠️ FAULT vorhanden! " + faultText);
-            addBqLog("Fehler erkannt: " + faultText);
+            LOGW(LOG_TAG_CHARGER, "⚠️ Fehler erkannt: %s", faultText.c_str());
         } else {
-            Serial.println("✅ Kein Fehler");
-            addBqLog("Kein Fehler erkannt");
+            LOGI(LOG_TAG_CHARGER, "✅ Kein Fehler erkannt");
         }
 
         // Spannungen und Ströme ausgeben
@@ -384,20 +352,15 @@ public:
         float ichg = getICHG();
         float iin = getIIN();
         
-        Serial.printf("VBAT: %.2fV, VSYS: %.2fV, VBUS: %.2fV\n", vbat, vsys, vbus);
-        Serial.printf("ICHG: %.3fA, IIN: %.3fA\n", ichg, iin);
-        
-        addBqLog("VBAT: " + String(vbat, 2) + "V, VSYS: " + String(vsys, 2) + "V, VBUS: " + String(vbus, 2) + "V");
-        addBqLog("ICHG: " + String(ichg * 1000, 0) + "mA, IIN: " + String(iin * 1000, 0) + "mA");
-        
-        Serial.println("=============================");
-        addBqLog("--- Ende Status ---");
+        LOGI(LOG_TAG_CHARGER, "VBAT: %.2fV, VSYS: %.2fV, VBUS: %.2fV", vbat, vsys, vbus);
+        LOGI(LOG_TAG_CHARGER, "ICHG: %.0fmA, IIN: %.0fmA", ichg * 1000, iin * 1000);
+        LOGI(LOG_TAG_CHARGER, "--- Ende Status ---");
     }
 
     String getTemperatureStatus() {
         uint8_t status = readRegister(0x0B);
         if (status == 0xFF) {
-            addBqLog("Fehler beim Lesen des Temperatur-Status (Register 0x0B)");
+            LOGW(LOG_TAG_CHARGER, "Fehler beim Lesen des Temperatur-Status (Register 0x0B)");
             return "Fehler";
         }
         
@@ -433,17 +396,13 @@ public:
             // VBAT ADC: 2.304V + ADC_Code × 20mV
             float voltage = 2.304f + (regVal * 0.02f);
             
-            // DEBUG: Nur gelegentlich ausgeben um serielle Schnittstelle nicht zu überlasten
-            static unsigned long lastVbatDebug = 0;
-            if (millis() - lastVbatDebug > 10000) { // Alle 10 Sekunden
-                Serial.printf("🔍 VBAT DEBUG: Register=0x%02X (%d), Berechnet=%.3fV\n", regVal, regVal, voltage);
-                lastVbatDebug = millis();
-            }
+            // Jede Messung - nur in Builds mit BADGE_LOG_LEVEL >= VERBOSE vorhanden
+            LOGV(LOG_TAG_CHARGER, "🔍 VBAT: Register=0x%02X (%d), Berechnet=%.3fV", regVal, regVal, voltage);
             
             return voltage;
         }
         
-        Serial.printf("❌ FEHLER: VBAT-Register lesen fehlgeschlagen (0x%02X)\n", regVal);
+        LOGE(LOG_TAG_CHARGER, "❌ VBAT-Register lesen fehlgeschlagen (0x%02X)", regVal);
         return -1.0f;
     }
 
@@ -483,12 +442,8 @@ public:
             // VBUS ADC: 2.6V + ADC_Code × 64mV (korrekte Formel!)
             float vbus = 2.6f + (regVal * 0.064f);
             
-            // DEBUG: Nur gelegentlich ausgeben um serielle Schnittstelle nicht zu überlasten
-            static unsigned long lastVbusDebug = 0;
-            if (millis() - lastVbusDebug > 15000) { // Alle 15 Sekunden
-                Serial.printf("🔍 VBUS DEBUG: Register=0x%02X (%d), Roh=%.2fV\n", regVal, regVal, vbus);
-                lastVbusDebug = millis();
-            }
+            // Jede Messung - nur in Builds mit BADGE_LOG_LEVEL >= VERBOSE vorhanden
+            LOGV(LOG_TAG_CHARGER, "🔍 VBUS: Register=0x%02X (%d), Roh=%.2fV", regVal, regVal, vbus);
             
             return vbus;
         }
@@ -535,6 +490,17 @@ public:
         return -1.0f;
     }
 
+    // NTC-Spannung (TS) in Prozent von REGN, ohne Debug-Ausgaben (für Telemetrie)
+    float getTSPercent() {
+        uint8_t regVal = readRegister(0x10);
+        if (regVal == 0xFF) {
+            return -1.0f;
+        }
+
+        // TSPCT: 21% + ADC_Code × 0.465%
+        return 21.0f + ((regVal & 0x7F) * 0.465f);
+    }
+
     String getChargeStatus() {
         uint8_t status = readRegister(0x0B);
         if (status == 0xFF) {
@@ -556,42 +522,38 @@ public:
     float getTemperature() {
         // Versuche kontinuierliches Lesen, manchmal schlägt ein einzelnes Lesen fehl
         for (int attempt = 0; attempt < 3; attempt++) {
-            Serial.printf("Temperatur-Leseversuch %d/3\n", attempt + 1);
+            LOGV(LOG_TAG_CHARGER, "Temperatur-Leseversuch %d/3", attempt + 1);
             
             // Prüfe ADC-Status
             uint8_t reg07 = readRegister(0x07);
-            Serial.printf("ADC Status (REG07): 0x%02X\n", reg07);
+            LOGV(LOG_TAG_CHARGER, "ADC Status (REG07): 0x%02X", reg07);
             
             if (reg07 != 0xFF) {
                 if (!(reg07 & 0x80)) { // ADC nicht aktiv
-                    Serial.println("ADC nicht aktiv, aktiviere...");
+                    LOGD(LOG_TAG_CHARGER, "ADC nicht aktiv, aktiviere...");
                     (void)writeRegister(0x07, reg07 | 0x80); // ADC aktivieren
                     delay(100); // Warte auf ADC-Start
                     
                     // Prüfe ADC-Status nach Aktivierung
                     reg07 = readRegister(0x07);
-                    Serial.printf("ADC Status nach Aktivierung (REG07): 0x%02X\n", reg07);
+                    LOGD(LOG_TAG_CHARGER, "ADC Status nach Aktivierung (REG07): 0x%02X", reg07);
                 }
             }
 
             // Versuche zuerst das MSB zu lesen
-            Serial.println("Lese Temperatur MSB...");
             uint8_t msb = readRegister(REG_18_ADC_DIE_TEMP_MSB);
-            Serial.printf("Temperatur MSB (0x%02X): 0x%02X\n", REG_18_ADC_DIE_TEMP_MSB, msb);
             
             if (msb == 0xFF) {
-                Serial.println("Fehler beim Lesen des MSB");
+                LOGD(LOG_TAG_CHARGER, "Fehler beim Lesen des Temperatur-MSB");
                 delay(100);
                 continue;
             }
             
             // Dann das LSB
-            Serial.println("Lese Temperatur LSB...");
             uint8_t lsb = readRegister(REG_19_ADC_DIE_TEMP_LSB);
-            Serial.printf("Temperatur LSB (0x%02X): 0x%02X\n", REG_19_ADC_DIE_TEMP_LSB, lsb);
             
             if (lsb == 0xFF) {
-                Serial.println("Fehler beim Lesen des LSB");
+                LOGD(LOG_TAG_CHARGER, "Fehler beim Lesen des Temperatur-LSB");
                 delay(100);
                 continue;
             }
@@ -600,15 +562,13 @@ public:
             uint16_t raw = ((msb << 8) | lsb) >> 6;
             float temp = 0.465f * raw - 273.15f; // 0.465°C pro LSB, Offset -273.15°C
             
-            // Debug-Ausgabe
-            Serial.printf("Temperatur Debug: MSB=0x%02X, LSB=0x%02X, Raw=%d, Temp=%.1f°C\n", 
-                        msb, lsb, raw, temp);
+            // Jede Messung - nur in Builds mit BADGE_LOG_LEVEL >= VERBOSE vorhanden
+            LOGV(LOG_TAG_CHARGER, "🌡️ Temperatur: MSB=0x%02X, LSB=0x%02X, Raw=%d, Temp=%.1f°C", msb, lsb, raw, temp);
             
             return temp;
         }
         
-        Serial.println("⚠️ Fehler beim Lesen der Temperatur-Register nach mehreren Versuchen");
-        addBqLog("ERROR: Kann Temperatur-Register nach mehreren Versuchen nicht lesen");
+        LOGE(LOG_TAG_CHARGER, "⚠️ Kann Temperatur-Register nach mehreren Versuchen nicht lesen");
         return -1.0f;
     }
 
@@ -629,8 +589,7 @@ public:
                 return false;
             }
         } catch (...) {
-            Serial.println("❌ Fehler bei I2C-Kommunikation");
-            addBqLog("KRITISCHER FEHLER: I2C-Kommunikation fehlgeschlagen");
+            LOGE(LOG_TAG_CHARGER, "❌ I2C-Kommunikation fehlgeschlagen");
             return false;
         }
     }
@@ -648,15 +607,14 @@ public:
             byte error = Wire.endTransmission();
             
             if (error != 0) {
-                Serial.printf("❌ I2C Fehler beim Schreiben von Register 0x%02X: %d\n", reg, error);
+                LOGE(LOG_TAG_CHARGER, "❌ I2C Fehler beim Schreiben von Register 0x%02X: %d", reg, error);
                 return false;
             }
             
-            Serial.printf("Register 0x%02X = 0x%02X geschrieben\n", reg, value);
+            LOGV(LOG_TAG_CHARGER, "Register 0x%02X = 0x%02X geschrieben", reg, value);
             return true;
         } catch (...) {
-            Serial.println("❌ Fehler beim Schreiben an I2C");
-            addBqLog("ERROR: Kann Register 0x" + String(reg, HEX) + " nicht schreiben");
+            LOGE(LOG_TAG_CHARGER, "❌ Kann Register 0x%02X nicht schreiben", reg);
             return false;
         }
     }
@@ -0,0 +1,217 @@
+#include "Boot.h"
+#include "Log.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/event_groups.h>
+#include <esp_timer.h>
+
+// Unter dem LED-Task (Priorität 2), damit Animationen flüssig bleiben
+#define BOOT_STAGE_PRIORITY 1
+
+struct BootStageSlot {
+    BootStage stage;
+    const char* name;
+    BootStageFunction function;
+    uint32_t dependsOn;
+    bool scheduled;
+    bool finished;
+    volatile bool ok;
+    int64_t queuedUs;
+    int64_t startUs;
+    int64_t endUs;
+};
+
+static BootStageSlot slots[BOOT_STAGE_COUNT];
+static EventGroupHandle_t bootEvents = NULL;
+
+// Jede Stufe wird in jedem Boot eingeplant (nicht benötigte enden sofort)
+#define BOOT_ALL_STAGES (BOOT_BIT(BOOT_STAGE_COUNT) - 1)
+
+static volatile int64_t firstFrameUs = 0;
+static volatile int64_t completeUs = 0;
+static volatile bool bootFinished = false;   // 64-Bit-Zeit ist nicht atomar lesbar
+static portMUX_TYPE bootMux = portMUX_INITIALIZER_UNLOCKED;
+
+static float toMs(int64_t us) {
+    return us / 1000.0f;
+}
+
+static void logSummary() {
+    LOGI("BOOT", "🚀 Boot abgeschlossen nach %lu ms (erster LED-Frame nach %lu ms)",
+         (unsigned long)(completeUs / 1000), (unsigned long)(firstFrameUs / 1000));
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+        const BootStageSlot& slot = slots[i];
+        if (!slot.scheduled) {
+            continue;
+        }
+        LOGI("BOOT", "   %-8s Start %5lu ms, gewartet %5lu ms, Dauer %5lu ms%s",
+             slot.name, (unsigned long)(slot.startUs / 1000),
+             (unsigned long)((slot.startUs - slot.queuedUs) / 1000),
+             (unsigned long)((slot.endUs - slot.startUs) / 1000),
+             slot.ok ? "" : " (fehlgeschlagen)");
+    }
+}
+
+static void finishStage(BootStageSlot& slot, bool ok) {
+    portENTER_CRITICAL(&bootMux);
+    bool already = slot.finished;
+    slot.finished = true;
+    portEXIT_CRITICAL(&bootMux);
+    if (already) {
+        return;
+    }
+
+    slot.ok = ok;
+    slot.endUs = esp_timer_get_time();
+    LOGD("BOOT", "Stufe %s fertig in %lu ms%s", slot.name,
+         (unsigned long)((slot.endUs - slot.startUs) / 1000), slot.ok ? "" : " (fehlgeschlagen)");
+
+    EventBits_t bits = xEventGroupSetBits(bootEvents, BOOT_BIT(slot.stage));
+
+    // Nur die letzte fertige Stufe meldet den Abschluss
+    bool report = false;
+    portENTER_CRITICAL(&bootMux);
+    if (!bootFinished && (bits & BOOT_ALL_STAGES) == BOOT_ALL_STAGES) {
+        completeUs = slot.endUs;
+        bootFinished = true;
+        report = true;
+    }
+    portEXIT_CRITICAL(&bootMux);
+
+    if (report) {
+        logSummary();
+    }
+}
+
+static void runStage(BootStageSlot& slot) {
+    slot.startUs = esp_timer_get_time();
+    bool ok = false;
+    try {
+        ok = slot.function();
+    } catch (...) {
+        LOGE("BOOT", "Fehler in Boot-Stufe %s, fahre fort...", slot.name);
+    }
+    finishStage(slot, ok);
+}
+
+static void bootStageTask(void* parameter) {
+    BootStageSlot& slot = *static_cast<BootStageSlot*>(parameter);
+
+    if (slot.dependsOn != 0) {
+        xEventGroupWaitBits(bootEvents, slot.dependsOn, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    runStage(slot);
+    vTaskDelete(NULL);
+}
+
+static BootStageSlot* scheduleStage(BootStage stage, const char* name,
+                                    BootStageFunction function, uint32_t dependsOn) {
+    if (bootEvents == NULL || stage >= BOOT_STAGE_COUNT || slots[stage].scheduled) {
+        return nullptr;
+    }
+
+    BootStageSlot& slot = slots[stage];
+    slot.stage = stage;
+    slot.name = name;
+    slot.function = function;
+    slot.dependsOn = dependsOn;
+    slot.ok = false;
+    slot.finished = false;
+    slot.queuedUs = esp_timer_get_time();
+    slot.scheduled = true;
+    return &slot;
+}
+
+void bootBegin() {
+    if (bootEvents == NULL) {
+        bootEvents = xEventGroupCreate();
+    }
+}
+
+bool bootRunStage(BootStage stage, const char* name, BootStageFunction function) {
+    BootStageSlot* slot = scheduleStage(stage, name, function, 0);
+    if (slot == nullptr) {
+        return false;
+    }
+    runStage(*slot);
+    return slot->ok;
+}
+
+void bootStartStage(BootStage stage, const char* name, BootStageFunction function,
+                    uint32_t dependsOn, uint32_t stackSize) {
+    BootStageSlot* slot = scheduleStage(stage, name, function, dependsOn);
+    if (slot == nullptr) {
+        return;
+    }
+
+    if (xTaskCreate(bootStageTask, name, stackSize, slot, BOOT_STAGE_PRIORITY, NULL) != pdPASS) {
+        // Kein Speicher für einen eigenen Task: dann eben hier und jetzt
+        LOGW("BOOT", "Task für Boot-Stufe %s nicht erstellt - führe sie direkt aus", name);
+        if (dependsOn != 0) {
+            xEventGroupWaitBits(bootEvents, dependsOn, pdFALSE, pdTRUE, portMAX_DELAY);
+        }
+        runStage(*slot);
+    }
+}
+
+void bootBeginStage(BootStage stage, const char* name) {
+    BootStageSlot* slot = scheduleStage(stage, name, nullptr, 0);
+    if (slot != nullptr) {
+        slot->startUs = slot->queuedUs;
+    }
+}
+
+void bootFinishStage(BootStage stage, bool ok) {
+    if (bootEvents == NULL || stage >= BOOT_STAGE_COUNT || !slots[stage].scheduled) {
+        return;
+    }
+    finishStage(slots[stage], ok);
+}
+
+bool bootStageDone(BootStage stage) {
+    if (bootEvents == NULL) {
+        return false;
+    }
+    return (xEventGroupGetBits(bootEvents) & BOOT_BIT(stage)) != 0;
+}
+
+bool bootComplete() {
+    return bootFinished;
+}
+
+void bootMarkFirstFrame() {
+    if (firstFrameUs == 0) {
+        firstFrameUs = esp_timer_get_time();
+    }
+}
+
+BootStageTiming getBootTiming(BootStage stage) {
+    BootStageTiming timing = {};
+    if (stage >= BOOT_STAGE_COUNT) {
+        return timing;
+    }
+
+    const BootStageSlot& slot = slots[stage];
+    timing.name = slot.name;
+    timing.scheduled = slot.scheduled;
+    timing.done = bootStageDone(stage);
+    timing.ok = timing.done && slot.ok;
+    if (slot.scheduled) {
+        timing.queuedMs = toMs(slot.queuedUs);
+        if (slot.startUs != 0) {
+            timing.startMs = toMs(slot.startUs);
+        }
+        if (timing.done) {
+            timing.durationMs = toMs(slot.endUs - slot.startUs);
+        }
+    }
+    return timing;
+}
+
+float getBootFirstFrameMs() {
+    return toMs(firstFrameUs);
+}
+
+float getBootTotalMs() {
+    return bootFinished ? toMs(completeUs) : 0;
+}
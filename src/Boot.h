@@ -0,0 +1,71 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <Arduino.h>
+
+// Gestufter, paralleler Boot.
+// Die LEDs starten synchron in setup() mit dem zuletzt gespeicherten Zustand
+// aus dem NVS. Alles Langsame (SPIFFS, Ladegerät, Display, WLAN, OTA) läuft
+// danach als eigene Tasks, die nur auf die Stufen warten, die sie wirklich
+// brauchen. Jede Stufe meldet sich über ein Bit in einer Event-Gruppe fertig.
+
+enum BootStage {
+    BOOT_STAGE_LEDS = 0,    // FastLED und LED-Tasks (synchron)
+    BOOT_STAGE_STORAGE,     // SPIFFS, Telemetrie-Verlauf, Einstellungen
+    BOOT_STAGE_CHARGER,     // BQ25895
+    BOOT_STAGE_DISPLAY,     // E-Ink-Display und Display-Task
+    BOOT_STAGE_WIFI,        // Funkmodus setzen bzw. Access Point starten
+    BOOT_STAGE_CONNECT,     // Mit dem WLAN verbinden (nur Client-Modus)
+    BOOT_STAGE_NETWORK,     // Webserver, UDP-Steuerung, Zeit-Sync, Mesh
+    BOOT_STAGE_OTA,         // OTA-Checkin
+    BOOT_STAGE_COUNT
+};
+
+#define BOOT_BIT(stage) ((uint32_t)1 << (stage))
+
+// Eine Stufe; Rückgabe false = fehlgeschlagen (abhängige Stufen laufen trotzdem)
+typedef bool (*BootStageFunction)();
+
+// Zeiten einer Stufe in Millisekunden seit dem Reset
+struct BootStageTiming {
+    const char* name;
+    bool scheduled;         // Stufe wurde gestartet oder eingeplant
+    bool done;
+    bool ok;
+    float queuedMs;         // Eingeplant
+    float startMs;          // Abhängigkeiten erfüllt, Stufe läuft
+    float durationMs;       // Laufzeit der Stufe selbst
+};
+
+// Event-Gruppe anlegen (als Erstes in setup())
+void bootBegin();
+
+// Stufe direkt im aufrufenden Task ausführen
+bool bootRunStage(BootStage stage, const char* name, BootStageFunction function);
+
+// Stufe als eigenen Task starten; sie wartet auf alle Stufen in dependsOn (BOOT_BIT-Maske)
+void bootStartStage(BootStage stage, const char* name, BootStageFunction function,
+                    uint32_t dependsOn, uint32_t stackSize);
+
+// Stufe ohne eigenen Task: beginnt jetzt, abgeschlossen wird sie später von
+// einem Ereignis (z.B. WLAN verbunden) mit bootFinishStage(). Mehrfaches
+// Abschließen ist harmlos.
+void bootBeginStage(BootStage stage, const char* name);
+void bootFinishStage(BootStage stage, bool ok);
+
+// Stufe abgeschlossen (egal ob erfolgreich)?
+bool bootStageDone(BootStage stage);
+
+// Alle Stufen abgeschlossen? (setup() plant jede Stufe ein - nicht benötigte
+// Stufen wie CONNECT im AP-Modus kehren sofort zurück)
+bool bootComplete();
+
+// Vom LED-Task nach dem ersten ausgegebenen Frame aufrufen
+void bootMarkFirstFrame();
+
+// Auswertung für die Web-UI
+BootStageTiming getBootTiming(BootStage stage);
+float getBootFirstFrameMs();   // 0 = noch kein Frame
+float getBootTotalMs();        // 0 = Boot läuft noch
+
+#endif // BOOT_H
@@ -10,6 +10,9 @@
 #include "BQ25895CONFIG.h"
 #include "Settings.h"
 #include "Globals.h"
+#include "UdpControl.h"  // Feldmaske UDP_FIELD_*
+#include "WiFiManager.h"
+#include "EspNowMesh.h"
 
 // Externe Variablen aus main.cpp - die globalen LED-Variablen sind jetzt in Globals.h
 extern bool saveSettings();
@@ -25,7 +28,6 @@ extern unsigned long brightLedOffTime;
 // Externe Variablen
 extern bool displayAvailable;
 extern DisplayContent displayContent;
-extern QueueHandle_t displayQueue;
 extern BQ25895* charger;
 extern void testDisplay();
 extern void clearDisplay();
@@ -69,23 +71,14 @@ void checkButtons() {
                     // Aktuell im Client-Modus -> zu AP-Modus wechseln
                     Serial.println("Mode-Button: Wechsle zu AP-Modus (3s)");
                     wifiConnectEnabled = false;
-                    WiFi.disconnect();
-                    WiFi.mode(WIFI_AP);
-                    WiFi.softAP(apName.c_str(), apPassword.length() > 0 ? apPassword.c_str() : NULL);
-                    wifiEnabled = true;
+                    wifiManagerStartAccessPoint();
                     Serial.println("AP-Modus aktiviert: " + apName);
                 } else {
                     // Aktuell im AP-Modus -> zu Client-Modus wechseln
                     Serial.println("Mode-Button: Wechsle zu Client-Modus (3s)");
                     wifiConnectEnabled = true;
-                    WiFi.softAPdisconnect(true);
-                    WiFi.mode(WIFI_STA);
-                    if (wifiSSID.length() > 0) {
-                        WiFi.begin(wifiSSID.c_str(), wifiPassword.c_str());
-                        Serial.println("Client-Modus aktiviert, verbinde mit: " + wifiSSID);
-                    } else {
-                        Serial.println("Client-Modus aktiviert, aber keine WiFi-Daten konfiguriert");
-                    }
+                    wifiManagerStartClient();  // Ohne WLAN-Daten bleibt der eigene AP aktiv
+                    Serial.println("Client-Modus aktiviert, verbinde mit: " + wifiSSID);
                 }
                 
                 // Einstellungen speichern
@@ -121,6 +114,9 @@ void checkButtons() {
                     // EINFACH: Direkte Ausgabe ohne Threading-Komplexität
                     Serial.printf("BUTTON (Core 1): Modus geändert zu: %d\n", currentMode);
                     
+                    // Badges in der Nähe mitnehmen
+                    meshBroadcastState(UDP_FIELD_MODE);
+                    
                     // LED-Feedback aktivieren
                     modeLedActive = true;
                     modeLedOffTime = currentTime + 1000; // 1 Sekunde an
@@ -143,6 +139,7 @@ void checkButtons() {
             
             // EINFACH: Direkte Ausgabe ohne Threading-Komplexität
             Serial.printf("BUTTON (Core 1): Farben geändert - Primär: %d, Sekundär: %d\n", primaryHue, secondaryHue);
+            meshBroadcastState(UDP_FIELD_PRIMARY | UDP_FIELD_SECONDARY);
             
             // LED-Feedback aktivieren
             colorLedActive = true;
@@ -167,6 +164,7 @@ void checkButtons() {
             
             // EINFACH: Direkte Ausgabe ohne Threading-Komplexität
             Serial.printf("BUTTON (Core 1): Helligkeit geändert zu: %d\n", brightness);
+            meshBroadcastState(UDP_FIELD_BRIGHTNESS);
             
             // LED-Feedback aktivieren
             brightLedActive = true;
@@ -4,6 +4,8 @@
 #include "esp_task_wdt.h"
 #include <Fonts/FreeMonoBold18pt7b.h>  // Größere Schrift für den Namen
 #include "BQ25895CONFIG.h"  // Wichtig!
+#include "ImageConvert.h"
+#include "Log.h"
 #include <GxEPD2_BW.h>
 #include <Fonts/FreeMonoBold9pt7b.h>
 #include <Fonts/FreeSans9pt7b.h>
@@ -51,33 +53,30 @@ bool preferBWPartialUpdate = true; // Standard: Verwende optimiertes BW-Update
 // Display-Inhalte
 DisplayContent displayContent = {"ArdyMoon", "", "", "", false, true};
 
-// Task Handle und Queue
+// Task Handle
 TaskHandle_t displayTaskHandle = NULL;
-QueueHandle_t displayQueue = NULL;
-
-// Zusätzliche Task für nicht-blockierendes Display-Update
-TaskHandle_t displayUpdateTaskHandle = NULL;
-
-// Zusätzlicher Status für Display-Updates
-enum DisplayUpdateStep {
-    STEP_BEGIN,
-    STEP_SET_WINDOW,
-    STEP_FIRST_PAGE,
-    STEP_DRAW_CONTENT,
-    STEP_NEXT_PAGE,
-    STEP_COMPLETE
-};
 
-// Globale Variablen für den Update-Zustand
-DisplayUpdateStep currentUpdateStep = STEP_BEGIN;
-unsigned long lastUpdateTime = 0;
-const unsigned long UPDATE_INTERVAL = 50; // 50ms zwischen Update-Schritten
+// Display-Scheduler: offene Anfragen werden zusammengeführt statt eingereiht.
+// Sender blockieren nie - sie setzen nur Bits und wecken den Display-Task.
+static portMUX_TYPE displaySchedulerMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t pendingCommands = 0;        // Ein Bit pro DisplayCommand
+static uint32_t pendingRegions = 0;         // Zusätzlich neu zu zeichnende Bereiche
+static uint32_t pendingContentVersion = 0;  // Inhaltsversion zum Zeitpunkt der Anfrage
+static bool pendingManualRefresh = false;   // Tastendruck: ohne Änderung volles Refresh
+static uint32_t displayContentVersion = 0;  // Wird bei jeder Inhaltsänderung erhöht
+static DisplayStats displayStats = {};
+
+// Wartezeit auf weitere Anfragen, bevor ein Refresh startet
+#define DISPLAY_COALESCE_MS 50
+
+// Von GxEPD2 gemessene BUSY-Wartezeit des aktuellen Refreshs
+static uint32_t busyWaitMs = 0;
+static unsigned long lastBusyCallback = 0;
 
 // Flag zum Tracking, ob Display-Update angefordert wurde
 bool displayUpdateRequested = false;
 
 // Funktionsdeklarationen 
-void updateDisplayTask(void *parameter);
 void drawDisplayContent();
 void updateDisplay();
 void updateBatteryStatus(bool forceUpdate);  // Standardargument entfernt
@@ -130,8 +129,8 @@ void drawDisplayContent() {
         hasImage = true;
         
         // Versuche das echte Bild zu laden und anzuzeigen
-        Serial.printf("🖼️ Lade Bild: %s\n", displayContent.imagePath.c_str());
-        Serial.printf("📍 Bildposition: x=%d, y=%d, Größe=%dx%d\n", IMAGE_X_POS, IMAGE_Y_POS, IMAGE_SIZE, IMAGE_SIZE);
+        LOGD("DISP", "🖼️ Lade Bild: %s (x=%d, y=%d, Größe=%dx%d)",
+             displayContent.imagePath.c_str(), IMAGE_X_POS, IMAGE_Y_POS, IMAGE_SIZE, IMAGE_SIZE);
         
         // Rahmen um das Bild zeichnen
         display.drawRect(IMAGE_X_POS - 1, IMAGE_Y_POS - 1, IMAGE_SIZE + 2, IMAGE_SIZE + 2, fgColor);
@@ -141,7 +140,7 @@ void drawDisplayContent() {
         
         if (!imageLoaded) {
             // Fallback: Platzhalter-Symbol wenn Dekodierung fehlschlägt
-            Serial.println("❌ Bitmap-Dekodierung fehlgeschlagen, zeige Fallback-Symbol");
+            LOGW("DISP", "❌ Bitmap-Dekodierung fehlgeschlagen, zeige Fallback-Symbol");
             display.fillRect(IMAGE_X_POS, IMAGE_Y_POS, IMAGE_SIZE, IMAGE_SIZE, bgColor);
             
             // Einfaches Kamera-Symbol als Fallback
@@ -153,15 +152,11 @@ void drawDisplayContent() {
             display.fillCircle(centerX, centerY, 6, fgColor);
             display.fillCircle(centerX, centerY, 4, bgColor);
             display.fillRect(centerX - 16, centerY - 10, 6, 4, fgColor);
-            
-            Serial.println("📷 Fallback-Kamera-Symbol angezeigt");
         } else {
-            Serial.println("✅ Bild erfolgreich geladen und angezeigt");
+            LOGV("DISP", "✅ Bild erfolgreich geladen und angezeigt");
         }
-    } else {
-        Serial.printf("❌ Kein Bild gefunden: imagePath='%s', exists=%s\n", 
-                     displayContent.imagePath.c_str(), 
-                     SPIFFS.exists(displayContent.imagePath) ? "ja" : "nein");
+    } else if (displayContent.imagePath.length() > 0) {
+        LOGD("DISP", "❌ Bild nicht gefunden: %s", displayContent.imagePath.c_str());
     }
     
     // Beschreibung mit Unicode-Support - KORRIGIERT: Ermögliche 3 Zeilen
@@ -221,79 +216,168 @@ void drawDisplayContent() {
     // Entferne Akku-Symbol (wird nicht mehr angezeigt)
 }
 
-// Task-Funktion für nicht-blockierendes Display-Update
-void updateDisplayTask(void *parameter) {
-    Serial.println("Display-Update-Task gestartet");
-    
-    // Einfache Zustände ohne switch/case
-    int state = 0;
-    unsigned long lastTime = millis();
-    const unsigned long DELAY = 50; // 50ms zwischen Schritten
-    bool isComplete = false;
-    
-    // Event-Loop
-    while (!isComplete) {
-        // Pause zwischen den Schritten
-        if (millis() - lastTime < DELAY) {
-            vTaskDelay(pdMS_TO_TICKS(10));
-            continue;
-        }
-        
-        lastTime = millis();
-        esp_task_wdt_reset(); // Watchdog zurücksetzen
-        
-        // Zustandsmaschine mit if/else
-        if (state == 0) {
-            // Initialisierung
-            Serial.println("Display-Update: Starte");
-            state = 1;
-        }
-        else if (state == 1) {
-            // Fenster setzen
-            Serial.println("Display-Update: Setze Fenster");
-            display.setFullWindow();
-            state = 2;
-        }
-        else if (state == 2) {
-            // Erste Seite beginnen
-            Serial.println("Display-Update: Erste Seite");
-            display.firstPage();
-            state = 3;
-        }
-        else if (state == 3) {
-            // Inhalt zeichnen
-            Serial.println("Display-Update: Zeichne Inhalt");
-            drawDisplayContent();
-            state = 4;
+// Bereichsdefinitionen passend zum Layout in drawDisplayContent()
+struct DisplayRegion {
+    const char* name;
+    int16_t x, y, w, h;
+};
+
+static const DisplayRegion displayRegions[REGION_COUNT] = {
+    { "Name",         0, 0, DISPLAY_WIDTH, LINE_Y_POS + 1 },
+    { "Beschreibung", 0, LINE_Y_POS + 1, IMAGE_X_POS - 2, TELEGRAM_Y_POS - 18 - LINE_Y_POS },
+    { "Telegram",     0, TELEGRAM_Y_POS - 17, DISPLAY_WIDTH, DISPLAY_HEIGHT - (TELEGRAM_Y_POS - 17) },
+    { "Bild",         IMAGE_X_POS - 1, IMAGE_Y_POS - 1, IMAGE_SIZE + 2, IMAGE_SIZE + 2 }
+};
+
+// Hashes des zuletzt auf das Panel geschriebenen Inhalts
+static uint32_t shownRegionHashes[REGION_COUNT] = {0};
+static bool shownRegionHashesValid = false;
+static uint8_t partialRefreshCount = 0;
+static uint32_t displayImageRevision = 0;
+
+// Inhalte ändern sich aus Web-Server, loop() und Display-Task
+static void bumpDisplayContentVersion() {
+    portENTER_CRITICAL(&displaySchedulerMux);
+    displayContentVersion++;
+    portEXIT_CRITICAL(&displaySchedulerMux);
+}
+
+void markDisplayImageChanged() {
+    displayImageRevision++;
+    bumpDisplayContentVersion();
+}
+
+// FNV-1a über beliebige Bytes
+static uint32_t fnv1a(uint32_t hash, const void* data, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+static uint32_t fnv1a(uint32_t hash, const String& text) {
+    return fnv1a(hash, text.c_str(), text.length() + 1);
+}
+
+static bool displayHasImage() {
+    return displayContent.imagePath.length() > 0 && SPIFFS.exists(displayContent.imagePath);
+}
+
+// Berechnet den Hash jedes Bereichs aus genau den Daten, die ihn beeinflussen
+static void computeRegionHashes(uint32_t hashes[REGION_COUNT]) {
+    const uint32_t seed = 2166136261UL;
+    bool hasImage = displayHasImage();
+    uint8_t flags[2] = { displayContent.invertColors, hasImage };
+
+    // Die Invertierung ändert den Hintergrund aller Bereiche
+    uint32_t base = fnv1a(seed, &flags[0], 1);
+
+    hashes[REGION_NAME] = fnv1a(fnv1a(base, displayContent.name), &displayContent.nameColorRed, 1);
+    // Beschreibung und Telegram hängen über Zeilenbreite/Position vom Bild ab
+    hashes[REGION_DESCRIPTION] = fnv1a(fnv1a(base, displayContent.description), &flags[1], 1);
+    hashes[REGION_TELEGRAM] = fnv1a(fnv1a(base, displayContent.telegram), &flags[1], 1);
+    uint32_t imageHash = fnv1a(fnv1a(base, displayContent.imagePath), &flags[1], 1);
+    hashes[REGION_IMAGE] = fnv1a(imageHash, &displayImageRevision, sizeof(displayImageRevision));
+}
+
+uint32_t getChangedDisplayRegions() {
+    if (!shownRegionHashesValid) {
+        return REGION_MASK_ALL;
+    }
+    uint32_t hashes[REGION_COUNT];
+    computeRegionHashes(hashes);
+
+    uint32_t mask = 0;
+    for (int i = 0; i < REGION_COUNT; i++) {
+        if (hashes[i] != shownRegionHashes[i]) {
+            mask |= (1UL << i);
         }
-        else if (state == 4) {
-            // Nächste Seite
-            Serial.println("Display-Update: Nächste Seite");
-            if (display.nextPage() == false) {
-                // Fertig - keine weiteren Seiten
-                Serial.println("Display-Update: Keine weiteren Seiten, Update abgeschlossen");
-                isComplete = true;
-            } else {
-                // Es gibt noch mehr Seiten, zurück zum Inhalt zeichnen
-                Serial.println("Display-Update: Weitere Seite vorhanden, zeichne Inhalt");
-                state = 3;
-            }
+    }
+    return mask;
+}
+
+bool renderDisplay(bool forceFull, uint32_t forceRegions) {
+    if (!displayAvailable) {
+        LOGE("DISP", "Display nicht verfügbar - kann nicht aktualisieren");
+        return false;
+    }
+
+    uint32_t hashes[REGION_COUNT];
+    computeRegionHashes(hashes);
+    uint32_t changed = getChangedDisplayRegions() | (forceRegions & REGION_MASK_ALL);
+
+    bool full = forceFull || !fullDisplayInitialized || !shownRegionHashesValid ||
+                partialRefreshCount >= DISPLAY_FULL_REFRESH_EVERY;
+
+    if (!full && changed == 0) {
+        LOGD("DISP", "🖼️ Display-Inhalt unverändert - kein Refresh nötig");
+        return false;
+    }
+
+    // Umschließendes Rechteck aller geänderten Bereiche -> ein einziges Refresh
+    int16_t x0 = DISPLAY_WIDTH, y0 = DISPLAY_HEIGHT, x1 = 0, y1 = 0;
+    if (!full) {
+        for (int i = 0; i < REGION_COUNT; i++) {
+            if (!(changed & (1UL << i))) continue;
+            const DisplayRegion& r = displayRegions[i];
+            LOGD("DISP", "🖼️ Bereich geändert: %s", r.name);
+            x0 = min(x0, r.x);
+            y0 = min(y0, r.y);
+            x1 = max(x1, (int16_t)(r.x + r.w));
+            y1 = max(y1, (int16_t)(r.y + r.h));
         }
-        else {
-            // Unbekannter Zustand
-            Serial.println("Display-Update: Unbekannter Zustand, breche ab");
-            isComplete = true;
+        int32_t area = (int32_t)(x1 - x0) * (y1 - y0);
+        if (area * 100 > (int32_t)DISPLAY_WIDTH * DISPLAY_HEIGHT * DISPLAY_PARTIAL_MAX_AREA_PERCENT) {
+            full = true;
         }
-        
-        // Kurze Pause für andere Tasks
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
-    
-    Serial.println("Display-Update-Task beendet");
-    
-    // Task beenden
-    displayUpdateTaskHandle = NULL;
-    vTaskDelete(NULL);
+
+    if (full) {
+        updateDisplay();
+    } else {
+        partialBWUpdate(x0, y0, x1 - x0, y1 - y0, true);
+    }
+
+    memcpy(shownRegionHashes, hashes, sizeof(shownRegionHashes));
+    shownRegionHashesValid = true;
+    return true;
+}
+
+// Schlüssel des aktuell im Framebuffer liegenden Inhalts
+static uint32_t cachedContentKey = 0;
+static bool displayCacheValid = false;
+
+static uint32_t currentContentKey() {
+    uint32_t hashes[REGION_COUNT];
+    computeRegionHashes(hashes);
+    return fnv1a(2166136261UL, hashes, sizeof(hashes));
+}
+
+void invalidateDisplayCache() {
+    displayCacheValid = false;
+}
+
+// Baut das Layout im Seitenpuffer von GxEPD2 nur neu auf, wenn sich
+// displayContent geändert hat. DISPLAY_TYPE hat eine einzige Seite über die
+// volle Höhe, der Puffer hält also immer das komplette Bild (kein eigener
+// Framebuffer nötig). firstPage() löscht diesen Puffer - wer ihn dafür nutzt,
+// muss invalidateDisplayCache() aufrufen.
+static void composeDisplayPlanes() {
+    uint32_t key = currentContentKey();
+    if (displayCacheValid && key == cachedContentKey) {
+        LOGV("DISP", "🖼️ Framebuffer aktuell - kein Neuaufbau nötig");
+        return;
+    }
+
+    unsigned long start = millis();
+    display.setFullWindow();
+    drawDisplayContent();
+
+    cachedContentKey = key;
+    displayCacheValid = true;
+    LOGD("DISP", "🖼️ Framebuffer neu aufgebaut (%lu ms)", millis() - start);
 }
 
 // Diese Funktion lädt die Display-Inhalte aus SPIFFS
@@ -305,7 +389,7 @@ bool loadDisplayContent() {
 
     File file = SPIFFS.open("/display.json", "r");
     if (!file) {
-        Serial.println("Failed to open display.json for reading");
+        LOGE("DISP", "display.json kann nicht gelesen werden");
         return false;
     }
 
@@ -314,7 +398,7 @@ bool loadDisplayContent() {
     file.close();
 
     if (error) {
-        Serial.println("Failed to parse display.json");
+        LOGE("DISP", "display.json ist ungültig: %s", error.c_str());
         return false;
     }
 
@@ -335,7 +419,6 @@ void saveDisplayContent() {
 }
 
 void saveDisplayContent(bool sendUpdate) {
-    Serial.println("saveDisplayContent() aufgerufen");
     
     StaticJsonDocument<512> doc;
     doc["name"] = displayContent.name;
@@ -345,43 +428,183 @@ void saveDisplayContent(bool sendUpdate) {
     doc["invertColors"] = displayContent.invertColors;
     doc["nameColorRed"] = displayContent.nameColorRed;
     
-    Serial.println("Speichere Display-Inhalte in SPIFFS: Name=" + displayContent.name + 
-                  ", Beschreibung=" + displayContent.description + 
-                  ", Telegram=" + displayContent.telegram);
+    LOGD("DISP", "Speichere Display-Inhalte: Name=%s, Beschreibung=%s, Telegram=%s",
+         displayContent.name.c_str(), displayContent.description.c_str(), displayContent.telegram.c_str());
     
     File file = SPIFFS.open("/display.json", "w");
     if (!file) {
-        Serial.println("ERROR: Failed to open display.json for writing");
+        LOGE("DISP", "display.json kann nicht geschrieben werden");
         return;
     }
     
     size_t bytesWritten = serializeJson(doc, file);
     if (bytesWritten == 0) {
-        Serial.println("ERROR: Failed to write to display.json");
+        LOGE("DISP", "Schreiben von display.json fehlgeschlagen");
     } else {
-        Serial.println("Display-Inhalte erfolgreich in SPIFFS gespeichert (" + String(bytesWritten) + " Bytes)");
+        LOGD("DISP", "Display-Inhalte gespeichert (%u Bytes)", (unsigned)bytesWritten);
     }
     
     file.close();
     
-    // Display aktualisieren nur wenn gewünscht
-    if (sendUpdate && displayQueue != NULL) {
-        Serial.println("Sende CMD_UPDATE Kommando an Display-Queue");
-        DisplayCommand cmd = CMD_UPDATE;
-        if (xQueueSend(displayQueue, &cmd, pdMS_TO_TICKS(100)) == pdPASS) {
-            Serial.println("CMD_UPDATE Kommando erfolgreich gesendet!");
+    bumpDisplayContentVersion();
+    
+    // Display aktualisieren nur wenn gewünscht (blockiert nie)
+    if (sendUpdate) {
+        if (requestDisplayCommand(CMD_UPDATE)) {
+            LOGD("DISP", "CMD_UPDATE an Display-Scheduler übergeben");
         } else {
-            Serial.println("ERROR: CMD_UPDATE Kommando konnte nicht gesendet werden!");
+            LOGE("DISP", "Display-Task läuft nicht - kann kein Update senden!");
         }
-    } else if (!sendUpdate) {
-        Serial.println("Display-Update übersprungen (sendUpdate=false)");
+    }
+}
+
+// Nimmt eine Anfrage an, ohne zu blockieren. Gleiche offene Anfragen werden zusammengeführt.
+bool requestDisplayCommand(DisplayCommand cmd, uint32_t regionMask) {
+    if (displayTaskHandle == NULL) {
+        return false;
+    }
+
+    uint32_t bit = 1UL << cmd;
+    portENTER_CRITICAL(&displaySchedulerMux);
+    if (pendingCommands & bit) {
+        displayStats.coalesced++;
+    }
+    if (cmd == CMD_CLEAR) {
+        // Löschen verwirft ältere, noch nicht ausgeführte Updates
+        pendingCommands &= ~(1UL << CMD_UPDATE);
+        pendingRegions = 0;
+        pendingManualRefresh = false;
+    }
+    pendingCommands |= bit;
+    pendingRegions |= regionMask;
+    pendingContentVersion = displayContentVersion;
+    displayStats.requests++;
+    portEXIT_CRITICAL(&displaySchedulerMux);
+
+    xTaskNotifyGive(displayTaskHandle);
+    return true;
+}
+
+DisplayStats getDisplayStats() {
+    DisplayStats copy;
+    portENTER_CRITICAL(&displaySchedulerMux);
+    copy = displayStats;
+    portEXIT_CRITICAL(&displaySchedulerMux);
+    return copy;
+}
+
+// Wird von GxEPD2 wiederholt aufgerufen, solange das Panel BUSY meldet -
+// anstelle von delay(1), daher hier selbst abgeben (Idle-Task, Watchdog)
+static void displayBusyCallback(const void*) {
+    unsigned long now = millis();
+    if (lastBusyCallback != 0 && now - lastBusyCallback < 20) {
+        busyWaitMs += now - lastBusyCallback;
+    }
+    lastBusyCallback = now;
+    vTaskDelay(1);
+}
+
+// Hochgeladenes Rohbild einmalig in das native Ebenenformat umwandeln.
+// Läuft im Display-Task, damit der Web-Server nie auf den Decoder wartet.
+static void prepareUploadedImage() {
+    String source = displayContent.imagePath;
+    if (source.length() == 0 || isEpdImagePath(source) || !SPIFFS.exists(source)) {
+        return;
+    }
+    
+    if (convertImageToEpd(source, EPD_IMAGE_PATH, IMAGE_SIZE)) {
+        // Rohdatei wird nicht mehr gebraucht
+        SPIFFS.remove(source);
+        displayContent.imagePath = EPD_IMAGE_PATH;
+        markDisplayImageChanged();
+        saveDisplayContent(false);
     } else {
-        Serial.println("ERROR: displayQueue ist NULL - kann kein Update senden!");
+        LOGW("DISP", "❌ Bildkonvertierung fehlgeschlagen, zeige Platzhalter: %s", source.c_str());
+    }
+}
+
+// Führt ein Kommando aus und misst Dauer und BUSY-Wartezeit.
+// version: Inhaltsversion der ausgeführten Anfrage
+static void runDisplayCommand(DisplayCommand cmd, uint32_t regions, bool manual, uint32_t version) {
+    unsigned long start = millis();
+    busyWaitMs = 0;
+    lastBusyCallback = 0;
+    bool refreshed = true;
+    bool full = true;
+
+    switch (cmd) {
+        case CMD_INIT:
+            LOGD("DISP", "CMD_INIT (Display-Test)");
+            shownRegionHashesValid = false;  // Panel zeigt nicht mehr das Layout
+            invalidateDisplayCache();        // firstPage() überschreibt den Puffer
+            display.setFullWindow();
+            display.firstPage();
+            do {
+                display.fillScreen(GxEPD_WHITE);
+                display.setCursor(10, 30);
+                display.print("Display Test");
+            } while (display.nextPage());
+            fullDisplayInitialized = true;
+            break;
+
+        case CMD_CLEAR:
+            LOGD("DISP", "CMD_CLEAR (Display leeren)");
+            invalidateDisplayCache();
+            display.setFullWindow();
+            display.firstPage();
+            do {
+                display.fillScreen(displayContent.invertColors ? GxEPD_BLACK : GxEPD_WHITE);
+            } while (display.nextPage());
+            fullDisplayInitialized = false; // Nach dem Löschen muss neu initialisiert werden
+            shownRegionHashesValid = false;
+            break;
+
+        case CMD_UPLOAD_IMAGE:
+            LOGD("DISP", "CMD_UPLOAD_IMAGE (neues Bild)");
+            prepareUploadedImage();
+            markDisplayImageChanged();
+            regions |= (1UL << REGION_IMAGE);
+            // fall through - weiter wie ein normales Update
+        case CMD_UPDATE: {
+            LOGD("DISP", "CMD_UPDATE (Display aktualisieren)");
+            uint8_t partialsBefore = partialRefreshCount;
+            // Tastendruck ohne Änderung: volles Refresh gegen Ghosting
+            bool forceFull = manual && (getChangedDisplayRegions() | regions) == 0;
+            refreshed = renderDisplay(forceFull, regions);
+            full = partialRefreshCount <= partialsBefore;
+            break;
+        }
+
+        default:
+            LOGW("DISP", "Unbekanntes Kommando: %d", (int)cmd);
+            refreshed = false;
+            break;
+    }
+
+    if (!refreshed) {
+        return;
+    }
+
+    uint32_t duration = millis() - start;
+    portENTER_CRITICAL(&displaySchedulerMux);
+    displayStats.refreshes++;
+    if (full) {
+        displayStats.fullRefreshes++;
     }
+    displayStats.lastRefreshMs = duration;
+    displayStats.lastBusyMs = busyWaitMs;
+    if (duration > displayStats.maxRefreshMs) {
+        displayStats.maxRefreshMs = duration;
+    }
+    displayStats.renderedVersion = version;
+    portEXIT_CRITICAL(&displaySchedulerMux);
+
+    LOGI("DISP", "⏱️ Display-Refresh (%s): %lu ms, davon BUSY %lu ms",
+         full ? "voll" : "partiell", (unsigned long)duration, (unsigned long)busyWaitMs);
 }
 
 void displayTask(void *parameter) {
-    Serial.println("displayTask gestartet");
+    LOGD("DISP", "displayTask gestartet");
     
     // Display initialisieren
     display.init(115200);
@@ -390,81 +613,64 @@ void displayTask(void *parameter) {
     display.setFont(&FreeMonoBold9pt7b);
     
     // Display-Inhalte laden
-    Serial.println("Lade Display-Inhalte aus SPIFFS...");
+    LOGD("DISP", "Lade Display-Inhalte aus SPIFFS...");
     if (loadDisplayContent()) {
-        Serial.println("Display-Inhalte erfolgreich geladen");
+        LOGD("DISP", "Display-Inhalte erfolgreich geladen");
     } else {
-        Serial.println("Fehler beim Laden der Display-Inhalte, verwende Standardwerte");
+        LOGW("DISP", "Fehler beim Laden der Display-Inhalte, verwende Standardwerte");
     }
     
-    // Kommando-Queue für Display-Updates
-    DisplayCommand cmd;
-    Serial.println("Display-Task wartet auf Kommandos...");
+    // Bilder aus älteren Firmware-Versionen liegen noch als Rohdatei vor
+    prepareUploadedImage();
+    
+    // BUSY-Wartezeit messen
+    display.epd2.setBusyCallback(displayBusyCallback);
+    
+    LOGD("DISP", "Display-Task wartet auf Anfragen...");
     
     while(true) {
-        // Auf Kommandos warten, nicht automatisch den Akku-Status updaten
-        if(xQueueReceive(displayQueue, &cmd, pdMS_TO_TICKS(1000))) {
-            Serial.print("Display-Task hat Kommando empfangen: ");
-            
-            switch(cmd) {
-                case CMD_INIT:
-                    Serial.println("CMD_INIT (Display-Test)");
-                    // Display-Test durchführen
-                    display.setFullWindow();
-                    display.firstPage();
-                    do {
-                        display.fillScreen(GxEPD_WHITE);
-                        display.setCursor(10, 30);
-                        display.print("Display Test");
-                    } while (display.nextPage());
-                    fullDisplayInitialized = true;
-                    break;
-                    
-                case CMD_UPDATE:
-                    Serial.println("CMD_UPDATE (Display aktualisieren)");
-                    // Direktes vollständiges Update
-                    updateDisplay();
-                    break;
-                    
-                case CMD_CLEAR:
-                    Serial.println("CMD_CLEAR (Display leeren)");
-                    // Display leeren
-                    display.setFullWindow();
-                    display.firstPage();
-                    do {
-                        display.fillScreen(displayContent.invertColors ? GxEPD_BLACK : GxEPD_WHITE);
-                    } while (display.nextPage());
-                    fullDisplayInitialized = false; // Nach dem Löschen muss neu initialisiert werden
-                    break;
-                    
-                default:
-                    Serial.println("Unbekanntes Kommando: " + String(cmd));
-                    break;
-            }
+        // Schlafen bis eine Anfrage eintrifft - kein Polling
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        // Kurz sammeln, damit schnell aufeinanderfolgende Anfragen zu einem Refresh werden
+        vTaskDelay(pdMS_TO_TICKS(DISPLAY_COALESCE_MS));
+        ulTaskNotifyTake(pdTRUE, 0);
+        
+        portENTER_CRITICAL(&displaySchedulerMux);
+        uint32_t commands = pendingCommands;
+        uint32_t regions = pendingRegions;
+        bool manual = pendingManualRefresh;
+        uint32_t version = pendingContentVersion;
+        pendingCommands = 0;
+        pendingRegions = 0;
+        pendingManualRefresh = false;
+        portEXIT_CRITICAL(&displaySchedulerMux);
+        
+        // Reihenfolge nach Priorität: Test, Löschen, Bild, Update
+        const DisplayCommand order[] = { CMD_INIT, CMD_CLEAR, CMD_UPLOAD_IMAGE, CMD_UPDATE };
+        bool contentDrawn = false;
+        for (DisplayCommand cmd : order) {
+            if (!(commands & (1UL << cmd))) continue;
+            // Ein Bild-Kommando zeichnet bereits den kompletten Inhalt
+            if (cmd == CMD_UPDATE && contentDrawn) continue;
+            runDisplayCommand(cmd, regions, manual, version);
+            contentDrawn = contentDrawn || cmd == CMD_UPLOAD_IMAGE;
         }
-        
-        // Kurze Pause
-        vTaskDelay(pdMS_TO_TICKS(50));
     }
 }
 
 void startDisplayTask() {
-    // Wenn Task oder Queue bereits existieren, erst löschen
+    // Wenn der Task bereits existiert, erst löschen
     if (displayTaskHandle != NULL) {
         vTaskDelete(displayTaskHandle);
         displayTaskHandle = NULL;
     }
-    if (displayQueue != NULL) {
-        vQueueDelete(displayQueue);
-        displayQueue = NULL;
-    }
     
-    // Display-Queue erstellen
-    displayQueue = xQueueCreate(3, sizeof(DisplayCommand));
-    if (displayQueue == NULL) {
-        Serial.println("Fehler beim Erstellen der Display-Queue");
-        return;
-    }
+    portENTER_CRITICAL(&displaySchedulerMux);
+    pendingCommands = 0;
+    pendingRegions = 0;
+    pendingManualRefresh = false;
+    portEXIT_CRITICAL(&displaySchedulerMux);
     
     // Display-Task auf Core 0 starten
     BaseType_t result = xTaskCreatePinnedToCore(
@@ -478,9 +684,8 @@ void startDisplayTask() {
     );
     
     if (result != pdPASS) {
-        Serial.println("Fehler beim Erstellen des Display-Tasks");
-        vQueueDelete(displayQueue);
-        displayQueue = NULL;
+        LOGE("DISP", "Fehler beim Erstellen des Display-Tasks");
+        displayTaskHandle = NULL;
     }
 }
 
@@ -496,17 +701,17 @@ bool checkDisplayAvailable() {
         
         // SSD1680 Controller Konfiguration für partielles Update - wichtig!
         if (display.epd2.hasFastPartialUpdate) {
-            Serial.println("Fast Partial Update unterstützt! Aktiviere diese Option.");
+            LOGD("DISP", "Fast Partial Update unterstützt");
             // Der SSD1680 unterstützt partielles Update, aber nur für Schwarz/Weiß
             
             // Kleine Verzögerung für bessere Stabilität
             delay(100);
         } else {
-            Serial.println("Fast Partial Update wird nicht unterstützt oder ist deaktiviert.");
+            LOGD("DISP", "Fast Partial Update wird nicht unterstützt oder ist deaktiviert");
         }
         
         displayAvailable = true;
-        Serial.println("WeAct E-Ink Display gefunden!");
+        LOGI("DISP", "WeAct E-Ink Display gefunden");
         
         // Display-Task nur starten, wenn noch nicht gestartet
         if (displayTaskHandle == NULL) {
@@ -514,7 +719,7 @@ bool checkDisplayAvailable() {
         }
         
     } catch (...) {
-        Serial.println("Fehler bei der Display-Initialisierung");
+        LOGE("DISP", "Fehler bei der Display-Initialisierung");
         displayAvailable = false;
     }
     
@@ -529,6 +734,7 @@ void initDisplay() {
         display.setTextColor(GxEPD_BLACK);
         display.setFont(&FreeMonoBold9pt7b);
         
+        invalidateDisplayCache();
         display.setFullWindow();
         display.firstPage();
         do {
@@ -543,112 +749,83 @@ void initDisplay() {
         delay(2000);
         
     } catch (...) {
-        Serial.println("Fehler bei der Display-Konfiguration");
+        LOGE("DISP", "Fehler bei der Display-Konfiguration");
         displayAvailable = false;
     }
 }
 
 void updateDisplay() {
-    Serial.println("updateDisplay() Funktion aufgerufen");
-    
     if (!displayAvailable) {
-        Serial.println("ERROR: Display nicht verfügbar - kann nicht aktualisieren");
+        LOGE("DISP", "Display nicht verfügbar - kann nicht aktualisieren");
         return;
     }
 
-    Serial.println("Display ist verfügbar, starte Update-Prozess...");
-    Serial.println("Display-Inhalte: Name=" + displayContent.name + 
-                  ", Beschreibung=" + displayContent.description + 
-                  ", Telegram=" + displayContent.telegram +
-                  ", Invertiert=" + String(displayContent.invertColors));
+    LOGD("DISP", "Volles Update: Name=%s, Beschreibung=%s, Telegram=%s, Invertiert=%d",
+         displayContent.name.c_str(), displayContent.description.c_str(),
+         displayContent.telegram.c_str(), (int)displayContent.invertColors);
     
-    // WICHTIG: Wir führen ein vollständiges Update durch - direkter Ansatz
-    display.setFullWindow();
-    display.firstPage();
-    do {
-        drawDisplayContent();
-    } while (display.nextPage());
+    // Vollständiges Update aus dem gecachten Seitenpuffer
+    composeDisplayPlanes();
+    display.display(false);
     
     // Display wurde vollständig aktualisiert
     fullDisplayInitialized = true;
-    Serial.println("✅ Vollständiges Display-Update abgeschlossen");
+    partialRefreshCount = 0;
+    LOGD("DISP", "✅ Vollständiges Display-Update abgeschlossen");
 }
 
 void testDisplay() {
-    Serial.println("Display-Test angefordert...");
+    LOGD("DISP", "Display-Test angefordert");
     
     if (!displayAvailable) {
-        Serial.println("FEHLER: Display nicht verfügbar für Test!");
+        LOGE("DISP", "Display nicht verfügbar für Test");
         return;
     }
     
-    if (displayQueue != NULL) {
-        Serial.println("Sende CMD_INIT Kommando an Display-Queue...");
-        DisplayCommand cmd = CMD_INIT;
-        if (xQueueSend(displayQueue, &cmd, pdMS_TO_TICKS(500)) == pdPASS) {
-            Serial.println("CMD_INIT Kommando erfolgreich gesendet");
-        } else {
-            Serial.println("FEHLER: CMD_INIT Kommando konnte nicht gesendet werden - Queue voll?");
-            // Fallback: Direktes Zeichnen versuchen
-            Serial.println("Versuche direktes Zeichnen als Fallback...");
-            display.setFullWindow();
-            display.firstPage();
-            do {
-                display.fillScreen(GxEPD_WHITE);
-                display.setCursor(10, 30);
-                display.print("Display Test");
-            } while (display.nextPage());
-        }
+    if (requestDisplayCommand(CMD_INIT)) {
+        LOGD("DISP", "CMD_INIT an Display-Scheduler übergeben");
     } else {
-        Serial.println("FEHLER: Display-Queue nicht initialisiert");
+        LOGE("DISP", "Display-Task läuft nicht");
     }
 }
 
 void clearDisplay() {
-    Serial.println("Display-Löschen angefordert...");
+    LOGD("DISP", "Display-Löschen angefordert");
     
     if (!displayAvailable) {
-        Serial.println("FEHLER: Display nicht verfügbar für Löschen!");
+        LOGE("DISP", "Display nicht verfügbar für Löschen");
         return;
     }
     
-    if (displayQueue != NULL) {
-        Serial.println("Sende CMD_CLEAR Kommando an Display-Queue...");
-        DisplayCommand cmd = CMD_CLEAR;
-        if (xQueueSend(displayQueue, &cmd, pdMS_TO_TICKS(500)) == pdPASS) {
-            Serial.println("CMD_CLEAR Kommando erfolgreich gesendet");
-        } else {
-            Serial.println("FEHLER: CMD_CLEAR Kommando konnte nicht gesendet werden - Queue voll?");
-            // Fallback: Direktes Löschen versuchen
-            Serial.println("Versuche direktes Löschen als Fallback...");
-            display.setFullWindow();
-            display.firstPage();
-            do {
-                display.fillScreen(displayContent.invertColors ? GxEPD_BLACK : GxEPD_WHITE);
-            } while (display.nextPage());
-        }
+    if (requestDisplayCommand(CMD_CLEAR)) {
+        LOGD("DISP", "CMD_CLEAR an Display-Scheduler übergeben");
     } else {
-        Serial.println("FEHLER: Display-Queue nicht initialisiert");
+        LOGE("DISP", "Display-Task läuft nicht");
     }
 }
 
 // Funktion zum Aktualisieren des Displays bei Tastendruck
 void updateDisplayOnButtonPress() {
     if (!displayAvailable) {
-        Serial.println("❌ Display nicht verfügbar für Update durch Tastendruck");
+        LOGW("DISP", "❌ Display nicht verfügbar für Update durch Tastendruck");
         return;
     }
     
-    Serial.println("🔄 Display-Update durch Tastendruck angefordert");
+    LOGD("DISP", "🔄 Display-Update durch Tastendruck angefordert");
     
-    // Vollständiges Display-Update durchführen - verwende drawDisplayContent() für Unicode-Support
-    display.setFullWindow();
-    display.firstPage();
-    do {
-        drawDisplayContent();  // Verwende die Unicode-fähige Funktion
-    } while (display.nextPage());
+    // Geänderte Bereiche partiell aktualisieren; ohne Änderung dient der
+    // Tastendruck als manuelle Ghosting-Bereinigung (volles Refresh).
+    // Der Display-Task übernimmt das Zeichnen, der Loop blockiert nicht.
+    if (displayTaskHandle != NULL) {
+        portENTER_CRITICAL(&displaySchedulerMux);
+        pendingManualRefresh = true;
+        portEXIT_CRITICAL(&displaySchedulerMux);
+        requestDisplayCommand(CMD_UPDATE);
+    } else {
+        renderDisplay(getChangedDisplayRegions() == 0);
+    }
     
-    Serial.println("✅ Display-Update durch Tastendruck abgeschlossen");
+    LOGV("DISP", "✅ Display-Update durch Tastendruck angestoßen");
     
     // Aktualisiere den Zeitpunkt des letzten Updates
     lastBatteryUpdateTime = millis();
@@ -660,7 +837,7 @@ void updateBatteryStatus(bool forceUpdate) {
     
     // Wichtig: Wenn das Display noch nicht vollständig initialisiert wurde, müssen wir zuerst ein vollständiges Update machen
     if (!fullDisplayInitialized) {
-        Serial.println("⚠️ Erster Aufruf - volles Display-Update erforderlich");
+        LOGD("DISP", "⚠️ Erster Aufruf - volles Display-Update erforderlich");
         // Beim ersten Mal vollständiges Update durchführen
         updateDisplay();
         return; // Nach dem vollständigen Update beenden
@@ -675,415 +852,85 @@ void updateBatteryStatus(bool forceUpdate) {
 // Neue Funktion für das Zeichnen des Akku-Inhalts
 void updateAkkuDisplayContent() {
     // Da wir das Akku-Symbol nicht mehr anzeigen, führen wir einfach ein normales Display-Update durch
-    Serial.println("🔄 Akku-Update nicht mehr nötig, führe normales Display-Update durch");
+    LOGV("DISP", "🔄 Akku-Update nicht mehr nötig, aktualisiere geänderte Bereiche");
     
-    // Vollständiges Display-Update durchführen
-    display.setFullWindow();
-    display.firstPage();
-    do {
-        // Hintergrund
-        uint16_t bgColor = displayContent.invertColors ? GxEPD_BLACK : GxEPD_WHITE;
-        display.fillScreen(bgColor);
-        
-        // Zeichne den gesamten Display-Inhalt (ohne Akku-Symbol)
-        drawDisplayContent();
-    } while (display.nextPage());
+    // Nur geänderte Bereiche aktualisieren
+    renderDisplay(false);
     
     // Timer zurücksetzen
     lastBatteryUpdateTime = millis();
-    Serial.println("✅ Display vollständig aktualisiert");
+    LOGV("DISP", "✅ Display aktualisiert");
 }
 
 // Neue Funktion: Spezielles partielles Update nur mit Schwarz/Weiß-Farben
 // Optimiert für SSD1680-Controller, die nur Schwarz/Weiß partiell aktualisieren können
 void partialBWUpdate(int16_t x, int16_t y, int16_t w, int16_t h, bool forceUpdate) {
     if (!displayAvailable) {
-        Serial.println("❌ Display nicht verfügbar für partielles BW-Update");
+        LOGW("DISP", "❌ Display nicht verfügbar für partielles BW-Update");
         return;
     }
     
     if (!fullDisplayInitialized) {
-        Serial.println("⚠️ Vollständiges Display-Update erforderlich vor partiellem BW-Update");
+        LOGD("DISP", "⚠️ Vollständiges Display-Update erforderlich vor partiellem BW-Update");
         updateDisplay();
         return;
     }
     
-    Serial.printf("🔄 Partielles BW-Update für Bereich: x=%d, y=%d, w=%d, h=%d\n", x, y, w, h);
-    
-    // Setze das Fenster für partielles Update
-    display.setPartialWindow(x, y, w, h);
-    
-    // Beginne die Seiten-basierte Aktualisierung
-    display.firstPage();
+    LOGD("DISP", "🔄 Partielles BW-Update für Bereich: x=%d, y=%d, w=%d, h=%d", x, y, w, h);
     
-    // Hier würde normalerweise der Inhalt gezeichnet werden
-    // Dies ist aber Aufgabe des Aufrufers, der die Zeichenfunktion
-    // zwischen firstPage() und nextPage() ausführen muss
+    // Nur das Fenster aus dem gecachten Seitenpuffer übertragen
+    // (displayWindow rechnet die Rotation um, der Treiber richtet x auf 8 Pixel aus)
+    composeDisplayPlanes();
+    display.displayWindow(x, y, w, h);
+    display.powerOff();
     
-    // Diese Funktion wartet normalerweise auf den nächsten Seitenaufruf,
-    // der in der aufrufenden Funktion als do-while Schleife implementiert ist:
-    // do { /* Zeichenoperationen */ } while (display.nextPage());
-    
-    // Hinweis: Für optimiertes BW-Update mit dem SSD1680-Controller
-    // wird empfohlen, nur GxEPD_BLACK und GxEPD_WHITE zu verwenden,
-    // nicht GxEPD_RED, da dies zu Anzeigefehlern führen kann.
-    
-    Serial.println("➡️ Partielles BW-Update gestartet");
+    partialRefreshCount++;
+    LOGV("DISP", "✅ Partielles Update abgeschlossen (%d seit letztem vollen Refresh)", partialRefreshCount);
 }
 
-// Funktion zur Dekodierung und Anzeige von 1-Bit Bitmaps
+// Vorkonvertiertes Bild (.epd, siehe ImageConvert.h) als Bitmap-Blit zeichnen
 bool drawBitmapFromFile(const String& filePath, int16_t x, int16_t y, uint16_t fgColor, uint16_t bgColor) {
-    Serial.printf("🖼️ Versuche Bild zu laden: %s\n", filePath.c_str());
-    
-    // Debug: Liste alle SPIFFS-Dateien auf
-    Serial.println("📂 SPIFFS-Dateien:");
-    File root = SPIFFS.open("/");
-    File file = root.openNextFile();
-    while(file) {
-        Serial.printf("   - %s (%d Bytes)\n", file.name(), file.size());
-        file = root.openNextFile();
-    }
-    root.close();
-    
-    // Prüfe ob Datei existiert
-    if (!SPIFFS.exists(filePath)) {
-        Serial.printf("❌ Datei existiert nicht: %s\n", filePath.c_str());
+    if (!isEpdImagePath(filePath)) {
+        // Rohdateien werden im Display-Task konvertiert, bis dahin Platzhalter
+        LOGD("DISP", "⚠️ Bild noch nicht konvertiert: %s", filePath.c_str());
         return false;
     }
     
     File imageFile = SPIFFS.open(filePath, "r");
     if (!imageFile) {
-        Serial.printf("❌ Kann Bilddatei nicht öffnen: %s\n", filePath.c_str());
+        LOGE("DISP", "❌ Kann Bilddatei nicht öffnen: %s", filePath.c_str());
         return false;
     }
     
-    size_t fileSize = imageFile.size();
-    Serial.printf("📁 Dateigröße: %d Bytes\n", fileSize);
-    
-    // Prüfe Dateierweiterung
-    bool isJpg = filePath.endsWith(".jpg") || filePath.endsWith(".jpeg") || filePath.endsWith(".JPG") || filePath.endsWith(".JPEG");
-    
-    if (isJpg) {
-        Serial.println("🖼️ JPG-Datei erkannt - zeige einfaches Platzhalter-Symbol");
-        
-        imageFile.close();
-        
-        // Für JPG-Dateien: Zeige ein einfaches Bild-Symbol
-        // Da JPG-Dekodierung sehr komplex ist, zeigen wir ein stilisiertes Bild-Symbol
-        
-        // Hintergrund füllen
-        display.fillRect(x, y, IMAGE_SIZE, IMAGE_SIZE, bgColor);
-        
-        // Einfaches Bild-Symbol zeichnen
-        int centerX = x + IMAGE_SIZE / 2;
-        int centerY = y + IMAGE_SIZE / 2;
-        
-        // Rahmen
-        display.drawRect(x + 8, y + 8, IMAGE_SIZE - 16, IMAGE_SIZE - 16, fgColor);
-        display.drawRect(x + 9, y + 9, IMAGE_SIZE - 18, IMAGE_SIZE - 18, fgColor);
-        
-        // Berge/Landschaft
-        display.drawLine(x + 12, y + 45, x + 25, y + 30, fgColor);
-        display.drawLine(x + 25, y + 30, x + 35, y + 40, fgColor);
-        display.drawLine(x + 35, y + 40, x + 45, y + 25, fgColor);
-        display.drawLine(x + 45, y + 25, x + 52, y + 35, fgColor);
-        
-        // Sonne
-        display.fillCircle(x + 45, y + 20, 4, fgColor);
-        
-        // Text "JPG"
-        display.setCursor(x + 20, y + 55);
-        display.setTextSize(1);
-        display.print("JPG");
-        
-        Serial.println("✅ JPG-Platzhalter erfolgreich angezeigt");
-        return true;
-    }
-    
-    // Erste 54 Bytes lesen um BMP-Header zu prüfen
-    uint8_t header[54];
-    size_t headerRead = imageFile.read(header, 54);
-    
-    if (headerRead < 54) {
-        Serial.printf("❌ Kann nur %d von 54 Header-Bytes lesen\n", headerRead);
+    uint8_t header[EPD_IMAGE_HEADER_SIZE];
+    if (imageFile.read(header, sizeof(header)) != sizeof(header) ||
+        memcmp(header, EPD_IMAGE_MAGIC, 4) != 0) {
+        LOGE("DISP", "❌ Ungültiger Bild-Header: %s", filePath.c_str());
         imageFile.close();
         return false;
     }
     
-    // Debug: Erste Bytes ausgeben
-    Serial.printf("🔍 Erste 4 Bytes: 0x%02X 0x%02X 0x%02X 0x%02X\n", 
-                  header[0], header[1], header[2], header[3]);
-    
-    // BMP-Signatur prüfen
-    if (header[0] != 'B' || header[1] != 'M') {
-        Serial.printf("❌ Keine BMP-Signatur gefunden (0x%02X 0x%02X statt 'BM')\n", header[0], header[1]);
-        
-        // Versuche als Raw-Bitmap zu behandeln
-        Serial.println("🔄 Versuche als Raw 1-Bit Bitmap...");
-        imageFile.seek(0); // Zurück zum Anfang
-        
-        // Raw 1-Bit Bitmap: 64x64 = 512 Bytes
-        if (fileSize >= 512) {
-            uint8_t buffer[8]; // 8 Bytes = 64 Pixel pro Zeile
-            
-            for (int row = 0; row < 64; row++) {
-                size_t bytesRead = imageFile.read(buffer, 8);
-                if (bytesRead != 8) {
-                    Serial.printf("❌ Zeile %d: Nur %d von 8 Bytes gelesen\n", row, bytesRead);
-                    break;
-                }
-                
-                for (int col = 0; col < 64; col++) {
-                    int byteIndex = col / 8;
-                    int bitIndex = 7 - (col % 8); // MSB first
-                    bool pixelOn = (buffer[byteIndex] >> bitIndex) & 1;
-                    
-                    if (pixelOn) {
-                        display.drawPixel(x + col, y + row, fgColor);
-                    } else {
-                        display.drawPixel(x + col, y + row, bgColor);
-                    }
-                }
-            }
-            
-            imageFile.close();
-            Serial.println("✅ Raw Bitmap erfolgreich geladen");
-            return true;
-        } else {
-            Serial.printf("❌ Datei zu klein für Raw Bitmap (%d < 512 Bytes)\n", fileSize);
-            imageFile.close();
-            return false;
-        }
-    }
-    
-    // BMP-Header analysieren
-    uint32_t dataOffset = *(uint32_t*)&header[10];
-    uint32_t dibHeaderSize = *(uint32_t*)&header[14];
-    uint32_t width = *(uint32_t*)&header[18];
-    uint32_t height = *(uint32_t*)&header[22];
-    uint16_t bitsPerPixel = *(uint16_t*)&header[28];
-    uint32_t compression = *(uint32_t*)&header[30];
-    
-    Serial.printf("📊 BMP-Info:\n");
-    Serial.printf("   - Daten-Offset: %d\n", dataOffset);
-    Serial.printf("   - DIB-Header-Größe: %d\n", dibHeaderSize);
-    Serial.printf("   - Größe: %dx%d\n", width, height);
-    Serial.printf("   - Bits pro Pixel: %d\n", bitsPerPixel);
-    Serial.printf("   - Kompression: %d\n", compression);
-    
-    // Validierung
-    if (compression != 0) {
-        Serial.printf("❌ Komprimierte BMPs werden nicht unterstützt (Kompression: %d)\n", compression);
+    uint16_t width = header[4] | (header[5] << 8);
+    uint16_t height = header[6] | (header[7] << 8);
+    if (width == 0 || height == 0 || width > IMAGE_SIZE || height > IMAGE_SIZE) {
+        LOGE("DISP", "❌ Ungültige Bildgröße: %ux%u", width, height);
         imageFile.close();
         return false;
     }
     
-    if (bitsPerPixel != 1 && bitsPerPixel != 8 && bitsPerPixel != 24 && bitsPerPixel != 32) {
-        Serial.printf("❌ Nicht unterstützte Farbtiefe: %d bpp\n", bitsPerPixel);
-        imageFile.close();
+    // Beide Ebenen in einem Rutsch lesen (bei 64x64 je 512 Bytes)
+    static uint8_t planes[2][(IMAGE_SIZE + 7) / 8 * IMAGE_SIZE];
+    size_t planeSize = (size_t)((width + 7) / 8) * height;
+    bool complete = imageFile.read(planes[0], planeSize) == planeSize &&
+                    imageFile.read(planes[1], planeSize) == planeSize;
+    imageFile.close();
+    if (!complete) {
+        LOGE("DISP", "❌ Bilddatei unvollständig: %s", filePath.c_str());
         return false;
     }
     
-    // Zu Datenbereich springen
-    imageFile.seek(dataOffset);
-    Serial.printf("🔄 Springe zu Daten-Offset: %d\n", dataOffset);
-    
-    if (bitsPerPixel == 1) {
-        // 1-Bit BMP (Monochrom)
-        int bytesPerRow = (width + 7) / 8;
-        int paddedBytesPerRow = (bytesPerRow + 3) & ~3; // 4-Byte-Ausrichtung
-        
-        Serial.printf("📏 Bytes pro Zeile: %d, mit Padding: %d\n", bytesPerRow, paddedBytesPerRow);
-        
-        uint8_t* rowBuffer = (uint8_t*)malloc(paddedBytesPerRow);
-        if (!rowBuffer) {
-            Serial.println("❌ Speicher-Allokation fehlgeschlagen");
-            imageFile.close();
-            return false;
-        }
-        
-        // BMP ist von unten nach oben gespeichert
-        for (int row = height - 1; row >= 0; row--) {
-            size_t bytesRead = imageFile.read(rowBuffer, paddedBytesPerRow);
-            if (bytesRead != paddedBytesPerRow) {
-                Serial.printf("❌ Zeile %d: Nur %d von %d Bytes gelesen\n", row, bytesRead, paddedBytesPerRow);
-                break;
-            }
-            
-            // Nur die ersten 64 Pixel und 64 Zeilen anzeigen
-            if (row < IMAGE_SIZE) {
-                for (int col = 0; col < width && col < IMAGE_SIZE; col++) {
-                    int byteIndex = col / 8;
-                    int bitIndex = 7 - (col % 8); // MSB first
-                    bool pixelOn = (rowBuffer[byteIndex] >> bitIndex) & 1;
-                    
-                    // BMP 1-Bit: 0 = schwarz, 1 = weiß
-                    // Für E-Paper: schwarz = fgColor, weiß = bgColor
-                    if (!pixelOn) { // 0 = schwarz
-                        display.drawPixel(x + col, y + (IMAGE_SIZE - 1 - row), fgColor);
-                    } else { // 1 = weiß
-                        display.drawPixel(x + col, y + (IMAGE_SIZE - 1 - row), bgColor);
-                    }
-                }
-            }
-        }
-        
-        free(rowBuffer);
-        imageFile.close();
-        Serial.println("✅ 1-Bit BMP erfolgreich geladen");
-        return true;
-    }
-    else if (bitsPerPixel == 8) {
-        // 8-Bit BMP (Graustufen oder indiziert)
-        Serial.println("🔄 Lade 8-Bit BMP als Graustufen...");
-        
-        // Palette überspringen (256 * 4 Bytes)
-        imageFile.seek(dataOffset);
-        
-        int bytesPerRow = width;
-        int paddedBytesPerRow = (bytesPerRow + 3) & ~3;
-        
-        uint8_t* rowBuffer = (uint8_t*)malloc(paddedBytesPerRow);
-        if (!rowBuffer) {
-            Serial.println("❌ Speicher-Allokation fehlgeschlagen");
-            imageFile.close();
-            return false;
-        }
-        
-        for (int row = height - 1; row >= 0; row--) {
-            size_t bytesRead = imageFile.read(rowBuffer, paddedBytesPerRow);
-            if (bytesRead != paddedBytesPerRow) break;
-            
-            if (row < IMAGE_SIZE) {
-                for (int col = 0; col < width && col < IMAGE_SIZE; col++) {
-                    uint8_t grayValue = rowBuffer[col];
-                    // Schwellwert bei 128: < 128 = schwarz, >= 128 = weiß
-                    if (grayValue < 128) {
-                        display.drawPixel(x + col, y + (IMAGE_SIZE - 1 - row), fgColor);
-                    } else {
-                        display.drawPixel(x + col, y + (IMAGE_SIZE - 1 - row), bgColor);
-                    }
-                }
-            }
-        }
-        
-        free(rowBuffer);
-        imageFile.close();
-        Serial.println("✅ 8-Bit BMP erfolgreich geladen");
-        return true;
-    }
-    else if (bitsPerPixel == 24) {
-        // 24-Bit BMP (RGB)
-        Serial.println("🔄 Lade 24-Bit BMP als RGB...");
-        
-        int bytesPerRow = width * 3;
-        int paddedBytesPerRow = (bytesPerRow + 3) & ~3;
-        
-        uint8_t* rowBuffer = (uint8_t*)malloc(paddedBytesPerRow);
-        if (!rowBuffer) {
-            Serial.println("❌ Speicher-Allokation fehlgeschlagen");
-            imageFile.close();
-            return false;
-        }
-        
-        for (int row = height - 1; row >= 0; row--) {
-            size_t bytesRead = imageFile.read(rowBuffer, paddedBytesPerRow);
-            if (bytesRead != paddedBytesPerRow) break;
-            
-            if (row < IMAGE_SIZE) {
-                for (int col = 0; col < width && col < IMAGE_SIZE; col++) {
-                    int pixelIndex = col * 3;
-                    uint8_t blue = rowBuffer[pixelIndex];
-                    uint8_t green = rowBuffer[pixelIndex + 1];
-                    uint8_t red = rowBuffer[pixelIndex + 2];
-                    
-                    // RGB zu Graustufen: 0.299*R + 0.587*G + 0.114*B
-                    uint8_t gray = (uint8_t)(0.299f * red + 0.587f * green + 0.114f * blue);
-                    
-                    // VEREINFACHTER ANSATZ: Einfacher Schwellwert ohne Dithering
-                    // Das verhindert die Streifen-Artefakte
-                    bool isBlack = gray < 128;
-                    
-                    // KORRIGIERT: Bildorientierung - BMP ist von unten nach oben, aber wir wollen es richtig herum
-                    int displayRow = row; // Verwende row direkt, nicht invertiert
-                    if (isBlack) {
-                        display.drawPixel(x + col, y + displayRow, fgColor);
-                    } else {
-                        display.drawPixel(x + col, y + displayRow, bgColor);
-                    }
-                }
-            }
-        }
-        
-        free(rowBuffer);
-        imageFile.close();
-        Serial.println("✅ 24-Bit BMP erfolgreich geladen");
-        return true;
-    }
-    else if (bitsPerPixel == 32) {
-        // 32-Bit BMP (RGBA oder RGBX)
-        Serial.println("🔄 Lade 32-Bit BMP als RGBA...");
-        
-        int bytesPerRow = width * 4;
-        int paddedBytesPerRow = (bytesPerRow + 3) & ~3;
-        
-        Serial.printf("📏 32-Bit: Bytes pro Zeile: %d, mit Padding: %d\n", bytesPerRow, paddedBytesPerRow);
-        
-        uint8_t* rowBuffer = (uint8_t*)malloc(paddedBytesPerRow);
-        if (!rowBuffer) {
-            Serial.println("❌ Speicher-Allokation fehlgeschlagen");
-            imageFile.close();
-            return false;
-        }
-        
-        int processedRows = 0;
-        for (int row = height - 1; row >= 0; row--) {
-            size_t bytesRead = imageFile.read(rowBuffer, paddedBytesPerRow);
-            if (bytesRead != paddedBytesPerRow) {
-                Serial.printf("⚠️ Zeile %d: Nur %d von %d Bytes gelesen\n", row, bytesRead, paddedBytesPerRow);
-                break;
-            }
-            
-            if (row < IMAGE_SIZE) {
-                processedRows++;
-                for (int col = 0; col < width && col < IMAGE_SIZE; col++) {
-                    int pixelIndex = col * 4;
-                    uint8_t blue = rowBuffer[pixelIndex];
-                    uint8_t green = rowBuffer[pixelIndex + 1];
-                    uint8_t red = rowBuffer[pixelIndex + 2];
-                    uint8_t alpha = rowBuffer[pixelIndex + 3];
-                    
-                    // Alpha-Blending mit weißem Hintergrund
-                    float alphaF = alpha / 255.0f;
-                    uint8_t blendedRed = (uint8_t)(red * alphaF + 255 * (1 - alphaF));
-                    uint8_t blendedGreen = (uint8_t)(green * alphaF + 255 * (1 - alphaF));
-                    uint8_t blendedBlue = (uint8_t)(blue * alphaF + 255 * (1 - alphaF));
-                    
-                    // RGB zu Graustufen mit Alpha-Berücksichtigung
-                    uint8_t gray = (uint8_t)(0.299f * blendedRed + 0.587f * blendedGreen + 0.114f * blendedBlue);
-                    
-                    // VEREINFACHTER ANSATZ: Einfacher Schwellwert ohne Dithering
-                    // Das verhindert die Streifen-Artefakte
-                    bool isBlack = gray < 128;
-                    
-                    // KORRIGIERT: Bildorientierung - BMP ist von unten nach oben, aber wir wollen es richtig herum
-                    int displayRow = row; // Verwende row direkt, nicht invertiert
-                    if (isBlack) {
-                        display.drawPixel(x + col, y + displayRow, fgColor);
-                    } else {
-                        display.drawPixel(x + col, y + displayRow, bgColor);
-                    }
-                }
-            }
-        }
-        
-        free(rowBuffer);
-        imageFile.close();
-        Serial.printf("✅ 32-Bit BMP mit Alpha-Blending erfolgreich geladen (%d Zeilen verarbeitet)\n", processedRows);
-        return true;
-    }
-    
-    imageFile.close();
-    Serial.printf("❌ Unbekanntes BMP-Format: %d bpp\n", bitsPerPixel);
-    return false;
+    // Schwarz-Ebene inklusive Hintergrund, danach Rot darüber
+    display.drawBitmap(x, y, planes[0], width, height, fgColor, bgColor);
+    display.drawBitmap(x, y, planes[1], width, height, GxEPD_RED);
+    return true;
 }
@@ -59,15 +59,49 @@ struct DisplayContent {
 
 extern DisplayContent displayContent;
 
-// Display Task Handles
+// Layout-Bereiche für partielle Updates (Koordinaten im Querformat)
+enum DisplayRegionId {
+    REGION_NAME = 0,     // Name oben inkl. Trennlinie
+    REGION_DESCRIPTION,  // Beschreibung (bis zu 3 Zeilen)
+    REGION_TELEGRAM,     // Telegram-Handle unten
+    REGION_IMAGE,        // Bild rechts inkl. Rahmen
+    REGION_COUNT
+};
+#define REGION_MASK_ALL ((1UL << REGION_COUNT) - 1)
+
+// Nach jeder n-ten partiellen Aktualisierung ein volles Refresh gegen Ghosting
+#define DISPLAY_FULL_REFRESH_EVERY 10
+// Ab diesem Flächenanteil (in %) lohnt sich ein partielles Update nicht mehr
+#define DISPLAY_PARTIAL_MAX_AREA_PERCENT 60
+
+// Display Task Handle
 extern TaskHandle_t displayTaskHandle;
-extern QueueHandle_t displayQueue;
-extern TaskHandle_t displayUpdateTaskHandle;  // Für nicht-blockierendes Update
+
+// Laufzeitstatistik des Display-Schedulers
+struct DisplayStats {
+    uint32_t requests;        // Angenommene Anfragen
+    uint32_t coalesced;       // Mit einer offenen Anfrage zusammengeführt
+    uint32_t refreshes;       // Ausgeführte Refreshes
+    uint32_t fullRefreshes;   // Davon vollständige Refreshes
+    uint32_t lastRefreshMs;   // Dauer des letzten Refreshs
+    uint32_t lastBusyMs;      // Davon gewartet auf BUSY des Panels
+    uint32_t maxRefreshMs;    // Längstes Refresh seit Boot
+    uint32_t renderedVersion; // Zuletzt gezeichnete Inhaltsversion
+};
 
 // Funktionsdeklarationen
 bool checkDisplayAvailable();
 void initDisplay();
 void updateDisplay();
+// Zeichnet nur geänderte Bereiche neu (forceFull = vollständiges Refresh).
+// Gibt true zurück, wenn das Panel tatsächlich aktualisiert wurde.
+bool renderDisplay(bool forceFull, uint32_t forceRegions = 0);
+// Bitmaske der Bereiche, deren Inhalt sich seit dem letzten Refresh geändert hat
+uint32_t getChangedDisplayRegions();
+// Muss nach jedem Bild-Upload/-Löschen aufgerufen werden (Bildpfad bleibt oft gleich)
+void markDisplayImageChanged();
+// Verwirft den gecachten Framebuffer (nächstes Refresh baut ihn neu auf)
+void invalidateDisplayCache();
 void updateBatteryStatus(bool forceUpdate = false);  // Partielles Update für Akkustatus
 // Neue Funktion: Spezielles optimiertes Update nur mit Schwarz/Weiß-Farben
 void partialBWUpdate(int16_t x, int16_t y, int16_t w, int16_t h, bool forceUpdate = false);
@@ -75,14 +109,15 @@ void partialBWUpdate(int16_t x, int16_t y, int16_t w, int16_t h, bool forceUpdat
 void updateDisplayOnButtonPress();
 // Neue Funktion: Aktualisiert den Akku-Inhalt
 void updateAkkuDisplayContent();
-void updateDisplayTask(void *parameter);  // Nicht-blockierende Update-Task
 void displayTask(void *parameter);
+// Übergibt ein Kommando an den Display-Task - blockiert nie, führt gleiche Anfragen zusammen
+bool requestDisplayCommand(DisplayCommand cmd, uint32_t regionMask = 0);
+DisplayStats getDisplayStats();
 void startDisplayTask();
 bool loadDisplayContent();
 void saveDisplayContent();
 void saveDisplayContent(bool sendUpdate);  // Neue Überladung: Optional ohne Display-Update
 void drawBatteryStatus(float voltage);
-bool uploadImage(uint8_t* imageData, size_t length);
 bool drawBitmapFromFile(const String& filePath, int16_t x, int16_t y, uint16_t fgColor, uint16_t bgColor);
 void testDisplay();
 void clearDisplay();
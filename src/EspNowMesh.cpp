@@ -0,0 +1,444 @@
+#include "EspNowMesh.h"
+#include "UdpControl.h"  // Feldmaske UDP_FIELD_*
+#include "TimeSync.h"
+#include "Settings.h"
+#include "Globals.h"
+#include "Log.h"
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#define MESH_QUEUE_LENGTH 16
+#define MESH_SEEN_SLOTS 32
+#define MESH_SEEN_TIMEOUT_MS 30000
+#define MESH_PENDING_SLOTS 6
+
+// Token-Bucket für alle Sendungen (eigene und weitergeleitete):
+// Spitzen bis 8 Pakete, im Mittel höchstens 5 pro Sekunde
+#define MESH_BUCKET_CAPACITY 8
+#define MESH_BUCKET_REFILL_MS 200
+
+// Zufällige Wartezeit vor dem Weiterleiten, damit Nachbarn nicht gleichzeitig senden
+#define MESH_RELAY_JITTER_MIN_MS 1
+#define MESH_RELAY_JITTER_MAX_MS 8
+
+// Wellen werden pro Hop verzögert, damit man sie wandern sieht
+#define MESH_WAVE_HOP_MS 150
+#define MESH_WAVE_DURATION_MS 600
+
+// So oft prüfen, ob ESP-NOW (neu) gestartet werden muss
+#define MESH_CHECK_MS 2000
+
+extern bool wifiEnabled;  // main.cpp - WiFi per Boot-Button eingeschaltet
+
+struct MeshQueueItem {
+    MeshPacket packet;
+    int64_t receivedAt;     // esp_timer_get_time() beim Empfang bzw. Erzeugen
+    bool local;             // Von diesem Badge erzeugt
+};
+
+struct MeshSeen {
+    uint32_t origin;
+    uint16_t messageId;
+    uint32_t seenAt;
+};
+
+struct MeshPending {
+    bool used;
+    MeshPacket packet;
+    int64_t receivedAt;
+    int64_t dueAt;
+};
+
+static const uint8_t broadcastAddress[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+
+static QueueHandle_t meshQueue = NULL;
+static TaskHandle_t meshTaskHandle = NULL;
+static volatile bool meshRunning = false;
+static bool meshOwnsRadio = false;         // Funkmodul nur für das Mesh eingeschaltet
+static wifi_mode_t meshRadioMode = WIFI_MODE_NULL;
+
+static uint32_t nodeId = 0;
+static uint16_t nextMessageId = 0;
+static portMUX_TYPE meshMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Nur im Mesh-Task benutzt
+static MeshSeen seenMessages[MESH_SEEN_SLOTS];
+static uint8_t seenNext = 0;
+static MeshPending pendingRelays[MESH_PENDING_SLOTS];
+static uint8_t bucketTokens = MESH_BUCKET_CAPACITY;
+static uint32_t bucketRefilled = 0;
+static volatile uint32_t meshDropped = 0;   // Rate-Limit oder keine freien Slots
+
+// Laufende Welle (LED-Task liest)
+static volatile bool waveActive = false;
+static volatile uint32_t waveStartMs = 0;
+static volatile uint8_t waveHue = 0;
+
+static void fillHeader(MeshPacket& packet, uint8_t type) {
+    memset(&packet, 0, sizeof(packet));
+    packet.magic[0] = MESH_MAGIC_0;
+    packet.magic[1] = MESH_MAGIC_1;
+    packet.version = MESH_VERSION;
+    packet.type = type;
+    packet.origin = nodeId;
+    packet.ttl = MESH_DEFAULT_TTL;
+
+    portENTER_CRITICAL(&meshMux);
+    packet.messageId = nextMessageId++;
+    portEXIT_CRITICAL(&meshMux);
+}
+
+static void startWave(uint8_t hue) {
+    waveHue = hue;
+    waveStartMs = millis();
+    waveActive = true;
+}
+
+// true, wenn (Ursprung, ID) kürzlich schon verarbeitet wurde; sonst merken
+static bool alreadySeen(uint32_t origin, uint16_t messageId) {
+    uint32_t now = millis();
+    for (int i = 0; i < MESH_SEEN_SLOTS; i++) {
+        const MeshSeen& entry = seenMessages[i];
+        if (entry.seenAt != 0 && entry.origin == origin && entry.messageId == messageId &&
+            now - entry.seenAt < MESH_SEEN_TIMEOUT_MS) {
+            return true;
+        }
+    }
+
+    MeshSeen& slot = seenMessages[seenNext];
+    slot.origin = origin;
+    slot.messageId = messageId;
+    slot.seenAt = now ? now : 1;
+    seenNext = (seenNext + 1) % MESH_SEEN_SLOTS;
+    return false;
+}
+
+static bool takeToken() {
+    uint32_t now = millis();
+    uint32_t refill = (now - bucketRefilled) / MESH_BUCKET_REFILL_MS;
+    if (refill > 0) {
+        bucketTokens = bucketTokens + refill > MESH_BUCKET_CAPACITY ? MESH_BUCKET_CAPACITY : bucketTokens + refill;
+        bucketRefilled += refill * MESH_BUCKET_REFILL_MS;
+    }
+    if (bucketTokens >= MESH_BUCKET_CAPACITY) {
+        bucketRefilled = now;  // Voller Eimer sammelt nichts an
+    }
+
+    if (bucketTokens == 0) {
+        return false;
+    }
+    bucketTokens--;
+    return true;
+}
+
+static void transmit(MeshPacket& packet, int64_t receivedAt) {
+    if (!meshRunning) {
+        return;
+    }
+    if (!takeToken()) {
+        meshDropped++;
+        LOGV("MESH", "Paket %08lX/%u verworfen (Rate-Limit)", (unsigned long)packet.origin, packet.messageId);
+        return;
+    }
+
+    // Beat-Phase um die Zeit im Badge (Warteschlange, Jitter, Hop-Verzögerung) vorrücken
+    if (packet.fields & MESH_FIELD_PHASE) {
+        packet.phaseMs += (uint32_t)((esp_timer_get_time() - receivedAt) / 1000);
+    }
+
+    esp_err_t result = esp_now_send(broadcastAddress, (const uint8_t*)&packet, sizeof(packet));
+    if (result != ESP_OK) {
+        LOGD("MESH", "Senden fehlgeschlagen: %d", (int)result);
+    }
+}
+
+static void applyMeshState(const MeshPacket& packet, int64_t receivedAt) {
+    if (packet.fields & UDP_FIELD_MODE) {
+        currentMode = packet.mode > 24 ? 24 : packet.mode;  // 25 Modi (0-24)
+    }
+    if (packet.fields & UDP_FIELD_PRIMARY) {
+        primaryHue = packet.primaryHue;
+    }
+    if (packet.fields & UDP_FIELD_SECONDARY) {
+        secondaryHue = packet.secondaryHue;
+    }
+    if (packet.fields & UDP_FIELD_BRIGHTNESS) {
+        brightness = packet.brightness < 12 ? 12 : packet.brightness;  // Mindesthelligkeit wie in der WebUI
+    }
+    if (packet.fields & UDP_FIELD_SPEED) {
+        animSpeed = packet.speed == 0 ? 1 : packet.speed;
+    }
+    if (packet.fields & MESH_FIELD_PHASE) {
+        timeSyncMeshHint(packet.phaseMs + (uint32_t)((esp_timer_get_time() - receivedAt) / 1000));
+    }
+}
+
+static void scheduleRelay(const MeshPacket& packet, int64_t receivedAt) {
+    for (int i = 0; i < MESH_PENDING_SLOTS; i++) {
+        MeshPending& slot = pendingRelays[i];
+        if (slot.used) {
+            continue;
+        }
+
+        uint32_t delayMs = packet.type == MESH_TYPE_WAVE
+            ? MESH_WAVE_HOP_MS
+            : MESH_RELAY_JITTER_MIN_MS + esp_random() % (MESH_RELAY_JITTER_MAX_MS - MESH_RELAY_JITTER_MIN_MS + 1);
+
+        slot.packet = packet;
+        slot.packet.ttl--;
+        slot.packet.hops++;
+        slot.receivedAt = receivedAt;
+        slot.dueAt = receivedAt + (int64_t)delayMs * 1000;
+        slot.used = true;
+        return;
+    }
+    meshDropped++;  // Alle Slots belegt - Nachbarn leiten ohnehin weiter
+}
+
+static void handleItem(MeshQueueItem& item) {
+    MeshPacket& packet = item.packet;
+
+    if (item.local) {
+        alreadySeen(packet.origin, packet.messageId);  // Echo der Nachbarn ignorieren
+        transmit(packet, item.receivedAt);
+        return;
+    }
+
+    if (packet.origin == nodeId || alreadySeen(packet.origin, packet.messageId)) {
+        return;
+    }
+
+    if (packet.type == MESH_TYPE_STATE) {
+        applyMeshState(packet, item.receivedAt);
+    } else if (packet.type == MESH_TYPE_WAVE) {
+        startWave(packet.primaryHue);
+    }
+    LOGD("MESH", "Paket %08lX/%u Typ %u nach %u Hops, Felder 0x%02X",
+         (unsigned long)packet.origin, packet.messageId, packet.type, packet.hops, packet.fields);
+
+    if (packet.ttl > 1) {
+        scheduleRelay(packet, item.receivedAt);
+    }
+}
+
+// Verarbeitet Empfang, eigene Pakete und fällige Weiterleitungen
+static void meshTask(void* parameter) {
+    MeshQueueItem item;
+
+    while (true) {
+        // Bis zur nächsten fälligen Weiterleitung warten
+        TickType_t wait = portMAX_DELAY;
+        int64_t now = esp_timer_get_time();
+        for (int i = 0; i < MESH_PENDING_SLOTS; i++) {
+            if (!pendingRelays[i].used) {
+                continue;
+            }
+            int64_t remaining = pendingRelays[i].dueAt - now;
+            TickType_t ticks = remaining <= 0 ? 0 : pdMS_TO_TICKS((remaining + 999) / 1000);
+            if (ticks < wait) {
+                wait = ticks;
+            }
+        }
+
+        if (xQueueReceive(meshQueue, &item, wait) == pdTRUE) {
+            handleItem(item);
+        }
+
+        now = esp_timer_get_time();
+        for (int i = 0; i < MESH_PENDING_SLOTS; i++) {
+            MeshPending& slot = pendingRelays[i];
+            if (slot.used && slot.dueAt <= now) {
+                transmit(slot.packet, slot.receivedAt);
+                slot.used = false;
+            }
+        }
+    }
+}
+
+// Läuft im WiFi-Task - nur prüfen und einreihen
+static void onMeshReceive(const uint8_t* mac, const uint8_t* data, int length) {
+    if (length < (int)sizeof(MeshPacket) || meshQueue == NULL) {
+        return;
+    }
+
+    MeshQueueItem item;
+    memcpy(&item.packet, data, sizeof(MeshPacket));
+    if (item.packet.magic[0] != MESH_MAGIC_0 || item.packet.magic[1] != MESH_MAGIC_1 ||
+        item.packet.version != MESH_VERSION) {
+        return;
+    }
+    item.receivedAt = esp_timer_get_time();
+    item.local = false;
+    xQueueSend(meshQueue, &item, 0);
+}
+
+static void stopMesh() {
+    if (!meshRunning) {
+        return;
+    }
+    meshRunning = false;
+    esp_now_unregister_recv_cb();
+    esp_now_deinit();
+    LOGI("MESH", "ESP-NOW-Mesh beendet");
+}
+
+static bool startMesh(wifi_mode_t mode) {
+    if (esp_now_init() != ESP_OK) {
+        LOGW("MESH", "ESP-NOW konnte nicht initialisiert werden");
+        return false;
+    }
+    esp_now_register_recv_cb(onMeshReceive);
+
+    // Broadcast-Peer auf dem aktuellen Kanal (0) der aktiven Schnittstelle
+    esp_now_peer_info_t peer;
+    memset(&peer, 0, sizeof(peer));
+    memcpy(peer.peer_addr, broadcastAddress, sizeof(broadcastAddress));
+    peer.channel = 0;
+    peer.ifidx = mode == WIFI_AP ? WIFI_IF_AP : WIFI_IF_STA;
+    peer.encrypt = false;
+    if (esp_now_add_peer(&peer) != ESP_OK) {
+        LOGW("MESH", "ESP-NOW Broadcast-Peer konnte nicht angelegt werden");
+        esp_now_unregister_recv_cb();
+        esp_now_deinit();
+        return false;
+    }
+
+    uint8_t channel = 0;
+    wifi_second_chan_t second;
+    esp_wifi_get_channel(&channel, &second);
+
+    meshRunning = true;
+    LOGI("MESH", "🕸️ ESP-NOW-Mesh aktiv auf Kanal %u (ID %08lX)%s",
+         channel, (unsigned long)nodeId, meshOwnsRadio ? " - ohne WLAN" : "");
+    return true;
+}
+
+void initEspNowMesh() {
+    if (meshQueue != NULL) {
+        return;
+    }
+
+    // ID aus den unteren MAC-Bytes - wie bei der Zeit-Synchronisation
+    nodeId = (uint32_t)(ESP.getEfuseMac() >> 16);
+    nextMessageId = (uint16_t)esp_random();  // Neustart kollidiert nicht mit alten IDs
+
+    meshQueue = xQueueCreate(MESH_QUEUE_LENGTH, sizeof(MeshQueueItem));
+    if (meshQueue == NULL) {
+        LOGE("MESH", "Mesh-Warteschlange konnte nicht angelegt werden");
+        return;
+    }
+
+    BaseType_t result = xTaskCreate(meshTask, "EspNowMesh", 3072, NULL, 3, &meshTaskHandle);
+    if (result != pdPASS) {
+        LOGE("MESH", "Mesh-Task konnte nicht gestartet werden");
+        vQueueDelete(meshQueue);
+        meshQueue = NULL;
+        meshTaskHandle = NULL;
+        return;
+    }
+
+    espNowMeshTick();
+}
+
+void espNowMeshTick() {
+    static unsigned long lastCheck = 0;
+    if (lastCheck != 0 && millis() - lastCheck < MESH_CHECK_MS) {
+        return;
+    }
+    lastCheck = millis();
+
+    static uint32_t reportedDrops = 0;
+    uint32_t dropped = meshDropped;
+    if (dropped != reportedDrops) {
+        LOGD("MESH", "%lu Mesh-Pakete nicht gesendet (Rate-Limit/Slots voll)",
+             (unsigned long)(dropped - reportedDrops));
+        reportedDrops = dropped;
+    }
+
+    bool wanted = settings.espNowMeshEnabled && meshQueue != NULL;
+    wifi_mode_t mode = WiFi.getMode();
+
+    if (wanted && mode == WIFI_OFF) {
+        // WiFi ist aus: Funkmodul nur für ESP-NOW einschalten, ohne Verbindung
+        WiFi.mode(WIFI_STA);
+        esp_wifi_set_channel(MESH_CHANNEL, WIFI_SECOND_CHAN_NONE);
+        meshOwnsRadio = true;
+        mode = WIFI_STA;
+    } else if (meshOwnsRadio && !wanted && !wifiEnabled &&
+               mode == WIFI_STA && WiFi.status() != WL_CONNECTED) {
+        // Mesh abgeschaltet: Funkmodul wieder aus, wie vorher
+        stopMesh();
+        WiFi.mode(WIFI_OFF);
+        meshOwnsRadio = false;
+        meshRadioMode = WIFI_MODE_NULL;
+        return;
+    } else if (meshOwnsRadio && (wifiEnabled || WiFi.status() == WL_CONNECTED)) {
+        meshOwnsRadio = false;  // WiFi wurde eingeschaltet - Funkmodul gehört wieder dem WLAN
+    }
+
+    // Nach Moduswechseln (oder WiFi-Neustart) ist ESP-NOW nicht mehr gültig
+    bool healthy = meshRunning && mode == meshRadioMode && esp_now_is_peer_exist(broadcastAddress);
+    if (wanted && mode != WIFI_OFF && healthy) {
+        return;
+    }
+
+    stopMesh();
+    meshRadioMode = WIFI_MODE_NULL;
+    if (wanted && mode != WIFI_OFF && startMesh(mode)) {
+        meshRadioMode = mode;
+    }
+}
+
+void meshBroadcastState(uint8_t fields) {
+    if (meshQueue == NULL || !meshRunning) {
+        return;
+    }
+
+    MeshQueueItem item;
+    fillHeader(item.packet, MESH_TYPE_STATE);
+    item.packet.fields = fields | MESH_FIELD_PHASE;
+    item.packet.mode = currentMode;
+    item.packet.primaryHue = primaryHue;
+    item.packet.secondaryHue = secondaryHue;
+    item.packet.brightness = brightness;
+    item.packet.speed = animSpeed;
+    item.packet.phaseMs = syncedMillis();
+    item.receivedAt = esp_timer_get_time();
+    item.local = true;
+    xQueueSend(meshQueue, &item, 0);
+}
+
+void meshTriggerWave(uint8_t hue) {
+    startWave(hue);
+
+    if (meshQueue == NULL || !meshRunning) {
+        return;
+    }
+
+    MeshQueueItem item;
+    fillHeader(item.packet, MESH_TYPE_WAVE);
+    item.packet.primaryHue = hue;
+    item.receivedAt = esp_timer_get_time();
+    item.local = true;
+    xQueueSend(meshQueue, &item, 0);
+}
+
+uint8_t meshWaveLevel(uint8_t& hue) {
+    if (!waveActive) {
+        return 0;
+    }
+
+    uint32_t elapsed = millis() - waveStartMs;
+    if (elapsed >= MESH_WAVE_DURATION_MS) {
+        waveActive = false;
+        return 0;
+    }
+
+    hue = waveHue;
+    return 255 - (uint8_t)(elapsed * 255 / MESH_WAVE_DURATION_MS);
+}
@@ -0,0 +1,69 @@
+#ifndef ESP_NOW_MESH_H
+#define ESP_NOW_MESH_H
+
+#include <Arduino.h>
+
+// Badge-zu-Badge-Effekte per ESP-NOW - ohne Access Point und ohne WLAN-Verbindung.
+// Kurze Zustandspakete (Modus, Farben, Beat-Phase) werden per Broadcast
+// gesendet und von jedem Empfänger mit TTL weitergeflutet:
+//
+// - Duplikate erkennt jedes Badge an (Ursprung, Nachrichten-ID)
+// - Weiterleitungen und eigene Pakete teilen sich einen Token-Bucket
+// - Eine "Welle" wird pro Hop verzögert weitergegeben und läuft so sichtbar
+//   durch eine Menschenmenge
+//
+// Ist WiFi aus, hält das Mesh nur das Funkmodul im Station-Modus auf Kanal
+// MESH_CHANNEL (keine Verbindung, kein Webserver). Mit WLAN-Verbindung oder
+// Access Point läuft ESP-NOW auf dem Kanal des Netzes mit - Badges hören sich
+// dann nur, wenn sie auf demselben Kanal sind.
+
+#define MESH_CHANNEL 1
+
+#define MESH_MAGIC_0 'B'
+#define MESH_MAGIC_1 'M'
+#define MESH_VERSION 1
+
+// Pakettypen
+#define MESH_TYPE_STATE 0x01   // Felder laut Maske übernehmen
+#define MESH_TYPE_WAVE  0x02   // Lichtwelle in Farbe primaryHue
+
+#define MESH_DEFAULT_TTL 4
+
+// Feldmaske: UDP_FIELD_* aus UdpControl.h plus
+#define MESH_FIELD_PHASE 0x20   // phaseMs gültig
+
+// Ein Paket, 24 Bytes, Little Endian
+struct __attribute__((packed)) MeshPacket {
+    uint8_t magic[2];       // "BM"
+    uint8_t version;        // MESH_VERSION
+    uint8_t type;           // MESH_TYPE_*
+    uint32_t origin;        // Badge, das die Nachricht erzeugt hat
+    uint16_t messageId;     // Pro Ursprung fortlaufend
+    uint8_t ttl;            // Verbleibende Weiterleitungen
+    uint8_t hops;           // Bisherige Weiterleitungen
+    uint8_t fields;         // UDP_FIELD_* / MESH_FIELD_*
+    uint8_t mode;
+    uint8_t primaryHue;
+    uint8_t secondaryHue;
+    uint8_t brightness;
+    uint8_t reserved;
+    uint16_t speed;         // animSpeed in ms
+    uint32_t phaseMs;       // Gemeinsame Animationszeit beim Senden
+};
+
+// Task und Warteschlange anlegen (Funkmodul startet espNowMeshTick)
+void initEspNowMesh();
+
+// Zyklisch aus loop() aufrufen: Start/Stop nach Einstellung und WiFi-Wechseln
+void espNowMeshTick();
+
+// Aktuellen Zustand an Badges in der Nähe senden (fields = UDP_FIELD_*)
+void meshBroadcastState(uint8_t fields);
+
+// Welle auslösen - läuft lokal sofort und wandert dann Hop für Hop weiter
+void meshTriggerWave(uint8_t hue);
+
+// Für den LED-Task: Stärke der laufenden Welle (0 = keine) und ihre Farbe
+uint8_t meshWaveLevel(uint8_t& hue);
+
+#endif // ESP_NOW_MESH_H
@@ -18,9 +18,6 @@ extern String deviceID;                  // Geräte-ID für OTA (MAC-Adresse)
 extern const char* firmwareVersion;      // Firmware Version (in Globals.cpp definieren!)
 extern String dynamicVersion;            // Dynamische Version für OTA-Updates
 extern const char* hardwaretype;         // Hardware-Typ
-extern const char* otaCheckinUrl;        // OTA Checkin URL
-
-// Externe Funktionsdeklarationen
-extern void checkForOTAUpdate();
+extern const char* otaCheckinUrl;        // OTA Checkin URL (Checkins macht der OtaAgent)
 
 #endif // GLOBALS_H 
\ No newline at end of file
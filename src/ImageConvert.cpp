@@ -0,0 +1,631 @@
+#include "ImageConvert.h"
+#include "Log.h"
+#include <SPIFFS.h>
+#include <JPEGDEC.h>
+#include <PNGdec.h>
+#include <new>
+
+// Zwischenpuffer der Konvertierung: Zielbild in RGB888 plus Abtasttabellen
+struct ConvertTarget {
+    uint16_t size;                  // Kantenlänge des (quadratischen) Zielbilds
+    int32_t srcWidth;               // Breite der dekodierten Quelle
+    int32_t srcHeight;              // Höhe der dekodierten Quelle
+    int16_t srcXForDst[IMAGE_CONVERT_MAX_SIZE];  // Quellspalte je Zielspalte (-1 = Rand)
+    int16_t srcYForDst[IMAGE_CONVERT_MAX_SIZE];  // Quellzeile je Zielzeile (-1 = Rand)
+    uint8_t* rgb;                   // size * size * 3 Bytes, mit Weiß vorbelegt
+    uint16_t* lineBuffer;           // Zeilenpuffer für den PNG-Decoder
+    PNG* png;                       // Aktiver PNG-Decoder (für getLineAsRGB565)
+};
+
+// Datei für die Decoder-Callbacks. Konvertiert wird nur im Display-Task,
+// daher reicht eine einzige Instanz.
+static File decoderFile;
+
+// Abtasttabellen berechnen: Seitenverhältnis erhalten, zentrieren, Rest bleibt weiß
+static void setupTarget(ConvertTarget& t, int32_t srcW, int32_t srcH) {
+    t.srcWidth = srcW;
+    t.srcHeight = srcH;
+
+    int32_t dstW = t.size;
+    int32_t dstH = t.size;
+    if (srcW >= srcH) {
+        dstH = max((int32_t)1, srcH * t.size / srcW);
+    } else {
+        dstW = max((int32_t)1, srcW * t.size / srcH);
+    }
+    int32_t offsetX = (t.size - dstW) / 2;
+    int32_t offsetY = (t.size - dstH) / 2;
+
+    // Nächster Nachbar: Mitte des Zielpixels auf die Quelle abbilden
+    for (int32_t d = 0; d < t.size; d++) {
+        int32_t relX = d - offsetX;
+        int32_t relY = d - offsetY;
+        t.srcXForDst[d] = (relX < 0 || relX >= dstW) ? -1 : (int16_t)(((2 * relX + 1) * srcW) / (2 * dstW));
+        t.srcYForDst[d] = (relY < 0 || relY >= dstH) ? -1 : (int16_t)(((2 * relY + 1) * srcH) / (2 * dstH));
+    }
+}
+
+static inline void storePixel(ConvertTarget& t, int dx, int dy, uint8_t r, uint8_t g, uint8_t b) {
+    uint8_t* p = t.rgb + ((size_t)dy * t.size + dx) * 3;
+    p[0] = r;
+    p[1] = g;
+    p[2] = b;
+}
+
+// Block aus RGB565-Pixeln (JPEG-MCUs, PNG-Zeilen) ins Zielbild übernehmen
+static void putRgb565Block(ConvertTarget& t, int bx, int by, int bw, int bh, const uint16_t* pixels) {
+    for (int dy = 0; dy < t.size; dy++) {
+        int sy = t.srcYForDst[dy];
+        if (sy < by || sy >= by + bh) continue;
+        const uint16_t* row = pixels + (size_t)(sy - by) * bw;
+        for (int dx = 0; dx < t.size; dx++) {
+            int sx = t.srcXForDst[dx];
+            if (sx < bx || sx >= bx + bw) continue;
+            uint16_t c = row[sx - bx];
+            storePixel(t, dx, dy,
+                       ((c >> 11) & 0x1F) << 3,
+                       ((c >> 5) & 0x3F) << 2,
+                       (c & 0x1F) << 3);
+        }
+    }
+}
+
+// ========== BMP ==========
+
+static uint16_t readLE16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t readLE32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Einen Pixel aus einer BMP-Rohzeile lesen
+static void bmpPixel(const uint8_t* row, int x, uint16_t bpp, const uint8_t* palette,
+                     uint16_t paletteSize, uint8_t& r, uint8_t& g, uint8_t& b) {
+    if (bpp == 24 || bpp == 32) {
+        const uint8_t* p = row + x * (bpp / 8);
+        b = p[0];
+        g = p[1];
+        r = p[2];
+        return;
+    }
+
+    uint16_t index;
+    if (bpp == 8) {
+        index = row[x];
+    } else if (bpp == 4) {
+        index = (row[x / 2] >> ((x & 1) ? 0 : 4)) & 0x0F;
+    } else {
+        index = (row[x / 8] >> (7 - (x % 8))) & 0x01;
+    }
+
+    if (index < paletteSize) {
+        b = palette[index * 4];
+        g = palette[index * 4 + 1];
+        r = palette[index * 4 + 2];
+    } else {
+        // Ohne Palette: 1-Bit 0 = schwarz, sonst als Graustufe deuten
+        uint8_t gray = bpp == 1 ? (index ? 255 : 0) : (bpp == 4 ? index * 17 : index);
+        r = g = b = gray;
+    }
+}
+
+static bool decodeBmp(File& file, ConvertTarget& t) {
+    uint8_t header[54];
+    if (file.read(header, sizeof(header)) != sizeof(header)) {
+        LOGE("IMG", "❌ BMP-Header unvollständig");
+        return false;
+    }
+
+    uint32_t dataOffset = readLE32(&header[10]);
+    uint32_t dibHeaderSize = readLE32(&header[14]);
+    int32_t width = (int32_t)readLE32(&header[18]);
+    int32_t height = (int32_t)readLE32(&header[22]);
+    uint16_t bitsPerPixel = readLE16(&header[28]);
+    uint32_t compression = readLE32(&header[30]);
+    uint32_t colorsUsed = readLE32(&header[46]);
+
+    // Negative Höhe: Zeilen liegen von oben nach unten
+    bool topDown = height < 0;
+    if (topDown) {
+        height = -height;
+    }
+
+    LOGD("IMG", "📊 BMP: %ldx%ld, %u bpp, Kompression %lu",
+         (long)width, (long)height, bitsPerPixel, (unsigned long)compression);
+
+    // BI_RGB oder BI_BITFIELDS (nur mit Standard-Maske bei 32 bpp)
+    if (compression != 0 && !(compression == 3 && bitsPerPixel == 32)) {
+        LOGE("IMG", "❌ Komprimierte BMPs werden nicht unterstützt (Kompression: %lu)", (unsigned long)compression);
+        return false;
+    }
+    if (bitsPerPixel != 1 && bitsPerPixel != 4 && bitsPerPixel != 8 &&
+        bitsPerPixel != 24 && bitsPerPixel != 32) {
+        LOGE("IMG", "❌ Nicht unterstützte Farbtiefe: %u bpp", bitsPerPixel);
+        return false;
+    }
+    if (width <= 0 || height <= 0 || width > IMAGE_CONVERT_MAX_SOURCE || height > IMAGE_CONVERT_MAX_SOURCE) {
+        LOGE("IMG", "❌ Ungültige BMP-Größe: %ldx%ld", (long)width, (long)height);
+        return false;
+    }
+
+    // Palette (nur bis 8 bpp)
+    uint8_t palette[256 * 4];
+    uint16_t paletteSize = 0;
+    if (bitsPerPixel <= 8) {
+        paletteSize = colorsUsed > 0 ? min(colorsUsed, (uint32_t)(1UL << bitsPerPixel)) : (1UL << bitsPerPixel);
+        file.seek(14 + dibHeaderSize);
+        if (file.read(palette, paletteSize * 4) != (size_t)paletteSize * 4) {
+            paletteSize = 0;
+        }
+    }
+
+    size_t rowBytes = (((size_t)width * bitsPerPixel + 31) / 32) * 4;
+    uint8_t* row = (uint8_t*)malloc(rowBytes);
+    if (!row) {
+        LOGE("IMG", "❌ Speicher-Allokation fehlgeschlagen");
+        return false;
+    }
+
+    setupTarget(t, width, height);
+    file.seek(dataOffset);
+
+    bool ok = true;
+    for (int32_t i = 0; i < height; i++) {
+        if (file.read(row, rowBytes) != rowBytes) {
+            LOGW("IMG", "⚠️ BMP endet nach %ld Zeilen", (long)i);
+            ok = i > 0;
+            break;
+        }
+        int32_t sy = topDown ? i : height - 1 - i;
+        for (int dy = 0; dy < t.size; dy++) {
+            if (t.srcYForDst[dy] != sy) continue;
+            for (int dx = 0; dx < t.size; dx++) {
+                int sx = t.srcXForDst[dx];
+                if (sx < 0) continue;
+                uint8_t r, g, b;
+                bmpPixel(row, sx, bitsPerPixel, palette, paletteSize, r, g, b);
+                storePixel(t, dx, dy, r, g, b);
+            }
+        }
+    }
+
+    free(row);
+    return ok;
+}
+
+// ========== JPEG ==========
+
+static void* jpegOpen(const char* filename, int32_t* size) {
+    decoderFile = SPIFFS.open(filename, "r");
+    if (!decoderFile) {
+        return nullptr;
+    }
+    *size = decoderFile.size();
+    return &decoderFile;
+}
+
+static void jpegClose(void* handle) {
+    File* file = (File*)handle;
+    if (file && *file) {
+        file->close();
+    }
+}
+
+static int32_t jpegRead(JPEGFILE* handle, uint8_t* buffer, int32_t length) {
+    File* file = (File*)handle->fHandle;
+    return file->read(buffer, length);
+}
+
+static int32_t jpegSeek(JPEGFILE* handle, int32_t position) {
+    File* file = (File*)handle->fHandle;
+    return file->seek(position) ? position : -1;
+}
+
+static int jpegDraw(JPEGDRAW* draw) {
+    ConvertTarget* t = (ConvertTarget*)draw->pUser;
+    putRgb565Block(*t, draw->x, draw->y, draw->iWidth, draw->iHeight, draw->pPixels);
+    return 1;  // Weiter dekodieren
+}
+
+static bool decodeJpeg(const String& path, ConvertTarget& t) {
+    // Decoder-Objekt ist einige KB groß - nicht auf den Task-Stack legen
+    JPEGDEC* jpeg = new (std::nothrow) JPEGDEC();
+    if (!jpeg) {
+        LOGE("IMG", "❌ Speicher für JPEG-Decoder fehlt");
+        return false;
+    }
+
+    bool ok = false;
+    if (jpeg->open(path.c_str(), jpegOpen, jpegClose, jpegRead, jpegSeek, jpegDraw)) {
+        int32_t width = jpeg->getWidth();
+        int32_t height = jpeg->getHeight();
+        LOGD("IMG", "📊 JPEG: %ldx%ld", (long)width, (long)height);
+
+        if (width > 0 && height > 0 && width <= IMAGE_CONVERT_MAX_SOURCE && height <= IMAGE_CONVERT_MAX_SOURCE) {
+            // Größte Verkleinerung wählen, die noch mindestens die Zielgröße liefert -
+            // der Decoder überspringt dann den Großteil der IDCT-Arbeit
+            const int scales[] = { 8, 4, 2 };
+            const int options[] = { JPEG_SCALE_EIGHTH, JPEG_SCALE_QUARTER, JPEG_SCALE_HALF };
+            int scale = 1;
+            int decodeOptions = 0;
+            int32_t longSide = max(width, height);
+            for (int i = 0; i < 3; i++) {
+                if (longSide / scales[i] >= t.size) {
+                    scale = scales[i];
+                    decodeOptions = options[i];
+                    break;
+                }
+            }
+
+            setupTarget(t, max((int32_t)1, width / scale), max((int32_t)1, height / scale));
+            jpeg->setPixelType(RGB565_LITTLE_ENDIAN);
+            jpeg->setUserPointer(&t);
+            ok = jpeg->decode(0, 0, decodeOptions) == 1;
+            if (!ok) {
+                LOGE("IMG", "❌ JPEG-Dekodierung fehlgeschlagen (Fehler %d)", jpeg->getLastError());
+            }
+        } else {
+            LOGE("IMG", "❌ Ungültige JPEG-Größe: %ldx%ld", (long)width, (long)height);
+        }
+        jpeg->close();
+    } else {
+        LOGE("IMG", "❌ JPEG kann nicht geöffnet werden (Fehler %d, progressiv?)", jpeg->getLastError());
+    }
+
+    delete jpeg;
+    return ok;
+}
+
+// ========== PNG ==========
+
+static void* pngOpen(const char* filename, int32_t* size) {
+    return jpegOpen(filename, size);
+}
+
+static void pngClose(void* handle) {
+    jpegClose(handle);
+}
+
+static int32_t pngRead(PNGFILE* handle, uint8_t* buffer, int32_t length) {
+    File* file = (File*)handle->fHandle;
+    return file->read(buffer, length);
+}
+
+static int32_t pngSeek(PNGFILE* handle, int32_t position) {
+    File* file = (File*)handle->fHandle;
+    return file->seek(position) ? position : -1;
+}
+
+static void pngDraw(PNGDRAW* draw) {
+    ConvertTarget* t = (ConvertTarget*)draw->pUser;
+
+    // Zeilen ohne Abtastpunkt gar nicht erst umwandeln
+    bool needed = false;
+    for (int dy = 0; dy < t->size && !needed; dy++) {
+        needed = t->srcYForDst[dy] == draw->y;
+    }
+    if (!needed) {
+        return;
+    }
+
+    // Transparente Bereiche auf weißen Hintergrund mischen
+    t->png->getLineAsRGB565(draw, t->lineBuffer, PNG_RGB565_LITTLE_ENDIAN, 0x00FFFFFF);
+    putRgb565Block(*t, 0, draw->y, draw->iWidth, 1, t->lineBuffer);
+}
+
+static bool decodePng(const String& path, ConvertTarget& t) {
+    // Der PNG-Decoder enthält ein 32 KB Inflate-Fenster - nur bei Bedarf anlegen
+    PNG* png = new (std::nothrow) PNG();
+    if (!png) {
+        LOGE("IMG", "❌ Speicher für PNG-Decoder fehlt");
+        return false;
+    }
+
+    bool ok = false;
+    if (png->open(path.c_str(), pngOpen, pngClose, pngRead, pngSeek, pngDraw) == PNG_SUCCESS) {
+        int32_t width = png->getWidth();
+        int32_t height = png->getHeight();
+        LOGD("IMG", "📊 PNG: %ldx%ld, %d bpp", (long)width, (long)height, png->getBpp());
+
+        if (width > 0 && height > 0 && width <= IMAGE_CONVERT_MAX_SOURCE && height <= IMAGE_CONVERT_MAX_SOURCE) {
+            t.lineBuffer = (uint16_t*)malloc(width * sizeof(uint16_t));
+            if (t.lineBuffer) {
+                setupTarget(t, width, height);
+                t.png = png;
+                ok = png->decode(&t, 0) == PNG_SUCCESS;
+                if (!ok) {
+                    LOGE("IMG", "❌ PNG-Dekodierung fehlgeschlagen (Fehler %d)", png->getLastError());
+                }
+                free(t.lineBuffer);
+                t.lineBuffer = nullptr;
+                t.png = nullptr;
+            } else {
+                LOGE("IMG", "❌ Speicher für PNG-Zeile fehlt");
+            }
+        } else {
+            LOGE("IMG", "❌ Ungültige PNG-Größe: %ldx%ld", (long)width, (long)height);
+        }
+        png->close();
+    } else {
+        LOGE("IMG", "❌ PNG kann nicht geöffnet werden (Fehler %d)", png->getLastError());
+    }
+
+    delete png;
+    return ok;
+}
+
+// ========== Dithering und Ausgabe ==========
+
+// Palette des Panels
+enum EpdColor { EPD_COLOR_WHITE = 0, EPD_COLOR_BLACK, EPD_COLOR_RED };
+
+static const int16_t paletteRgb[3][3] = {
+    { 255, 255, 255 },
+    { 0, 0, 0 },
+    { 255, 0, 0 }
+};
+
+static EpdColor nearestColor(int16_t r, int16_t g, int16_t b) {
+    EpdColor best = EPD_COLOR_WHITE;
+    int32_t bestDistance = INT32_MAX;
+    for (int i = 0; i < 3; i++) {
+        int32_t dr = r - paletteRgb[i][0];
+        int32_t dg = g - paletteRgb[i][1];
+        int32_t db = b - paletteRgb[i][2];
+        // Grün wiegt für das Auge am stärksten
+        int32_t distance = 3 * dr * dr + 6 * dg * dg + db * db;
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = (EpdColor)i;
+        }
+    }
+    return best;
+}
+
+static inline int16_t clampChannel(int32_t value) {
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+// Floyd-Steinberg auf die drei Panelfarben, Ergebnis direkt in die Bit-Ebenen packen
+static void ditherToPlanes(const ConvertTarget& t, uint8_t* blackPlane, uint8_t* redPlane) {
+    const int size = t.size;
+    const int rowBytes = (size + 7) / 8;
+    memset(blackPlane, 0, rowBytes * size);
+    memset(redPlane, 0, rowBytes * size);
+
+    // Fehler der aktuellen und nächsten Zeile (mit je einer Randspalte links/rechts)
+    int16_t errorRows[2][(IMAGE_CONVERT_MAX_SIZE + 2) * 3];
+    memset(errorRows, 0, sizeof(errorRows));
+    int16_t* current = errorRows[0];
+    int16_t* next = errorRows[1];
+
+    for (int y = 0; y < size; y++) {
+        memset(next, 0, sizeof(errorRows[0]));
+        for (int x = 0; x < size; x++) {
+            const uint8_t* p = t.rgb + ((size_t)y * size + x) * 3;
+            int16_t* e = current + (x + 1) * 3;
+            int16_t value[3];
+            for (int c = 0; c < 3; c++) {
+                value[c] = clampChannel(p[c] + e[c] / 16);
+            }
+
+            EpdColor color = nearestColor(value[0], value[1], value[2]);
+            if (color == EPD_COLOR_BLACK) {
+                blackPlane[y * rowBytes + x / 8] |= 0x80 >> (x % 8);
+            } else if (color == EPD_COLOR_RED) {
+                redPlane[y * rowBytes + x / 8] |= 0x80 >> (x % 8);
+            }
+
+            // Fehler in 1/16 verteilen: 7 rechts, 3/5/1 in der nächsten Zeile
+            for (int c = 0; c < 3; c++) {
+                int16_t error = value[c] - paletteRgb[color][c];
+                current[(x + 2) * 3 + c] += error * 7;
+                next[x * 3 + c] += error * 3;
+                next[(x + 1) * 3 + c] += error * 5;
+                next[(x + 2) * 3 + c] += error;
+            }
+        }
+        int16_t* swap = current;
+        current = next;
+        next = swap;
+    }
+}
+
+static bool writeEpdFile(const String& dstPath, uint16_t size, const uint8_t* blackPlane,
+                         const uint8_t* redPlane, size_t planeSize) {
+    // Erst in eine Temp-Datei schreiben, damit ein Abbruch das alte Bild nicht zerstört
+    String tmpPath = dstPath + ".tmp";
+    File out = SPIFFS.open(tmpPath, "w");
+    if (!out) {
+        LOGE("IMG", "❌ Kann Zieldatei nicht öffnen: %s", tmpPath.c_str());
+        return false;
+    }
+
+    uint8_t header[EPD_IMAGE_HEADER_SIZE];
+    memcpy(header, EPD_IMAGE_MAGIC, 4);
+    header[4] = size & 0xFF;
+    header[5] = size >> 8;
+    header[6] = size & 0xFF;
+    header[7] = size >> 8;
+
+    bool ok = out.write(header, sizeof(header)) == sizeof(header) &&
+              out.write(blackPlane, planeSize) == planeSize &&
+              out.write(redPlane, planeSize) == planeSize;
+    out.close();
+
+    if (!ok) {
+        LOGE("IMG", "❌ Schreiben der Bilddatei fehlgeschlagen (SPIFFS voll?)");
+        SPIFFS.remove(tmpPath);
+        return false;
+    }
+
+    if (SPIFFS.exists(dstPath)) {
+        SPIFFS.remove(dstPath);
+    }
+    return SPIFFS.rename(tmpPath, dstPath);
+}
+
+bool isEpdImagePath(const String& path) {
+    return path.endsWith(".epd");
+}
+
+static void writeLE16(uint8_t* p, uint16_t value) {
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+}
+
+static void writeLE32(uint8_t* p, uint32_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = (value >> 16) & 0xFF;
+    p[3] = value >> 24;
+}
+
+bool writeEpdAsBmp(const String& path, Print& out) {
+    File file = SPIFFS.open(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    uint8_t header[EPD_IMAGE_HEADER_SIZE];
+    if (file.read(header, sizeof(header)) != sizeof(header) || memcmp(header, EPD_IMAGE_MAGIC, 4) != 0) {
+        file.close();
+        return false;
+    }
+    uint16_t width = readLE16(&header[4]);
+    uint16_t height = readLE16(&header[6]);
+    if (width == 0 || height == 0 || width > IMAGE_CONVERT_MAX_SIZE || height > IMAGE_CONVERT_MAX_SIZE) {
+        file.close();
+        return false;
+    }
+
+    size_t planeRowBytes = (width + 7) / 8;
+    size_t planeSize = planeRowBytes * height;
+    uint8_t* planes = (uint8_t*)malloc(planeSize * 2);
+    if (!planes) {
+        file.close();
+        return false;
+    }
+    bool complete = file.read(planes, planeSize * 2) == planeSize * 2;
+    file.close();
+    if (!complete) {
+        free(planes);
+        return false;
+    }
+
+    // BMP-Header mit 3-Farben-Palette (Index 0 = weiß, 1 = schwarz, 2 = rot)
+    const uint32_t paletteBytes = 3 * 4;
+    size_t bmpRowBytes = (((size_t)width * 4 + 31) / 32) * 4;
+    uint32_t dataOffset = 54 + paletteBytes;
+    uint8_t bmpHeader[54 + paletteBytes];
+    memset(bmpHeader, 0, sizeof(bmpHeader));
+    bmpHeader[0] = 'B';
+    bmpHeader[1] = 'M';
+    writeLE32(&bmpHeader[2], dataOffset + bmpRowBytes * height);
+    writeLE32(&bmpHeader[10], dataOffset);
+    writeLE32(&bmpHeader[14], 40);
+    writeLE32(&bmpHeader[18], width);
+    writeLE32(&bmpHeader[22], height);
+    writeLE16(&bmpHeader[26], 1);
+    writeLE16(&bmpHeader[28], 4);
+    writeLE32(&bmpHeader[46], 3);
+    const uint8_t palette[paletteBytes] = {
+        0xFF, 0xFF, 0xFF, 0,   // weiß (BGRA)
+        0x00, 0x00, 0x00, 0,   // schwarz
+        0x00, 0x00, 0xFF, 0    // rot
+    };
+    memcpy(&bmpHeader[54], palette, paletteBytes);
+    out.write(bmpHeader, sizeof(bmpHeader));
+
+    // Zeilen von unten nach oben, zwei Pixel pro Byte
+    uint8_t row[(IMAGE_CONVERT_MAX_SIZE + 7) / 2];
+    for (int y = height - 1; y >= 0; y--) {
+        memset(row, 0, bmpRowBytes);
+        for (int x = 0; x < width; x++) {
+            size_t i = y * planeRowBytes + x / 8;
+            uint8_t mask = 0x80 >> (x % 8);
+            uint8_t index = (planes[planeSize + i] & mask) ? 2 : ((planes[i] & mask) ? 1 : 0);
+            row[x / 2] |= (x & 1) ? index : (index << 4);
+        }
+        out.write(row, bmpRowBytes);
+    }
+
+    free(planes);
+    return true;
+}
+
+bool convertImageToEpd(const String& srcPath, const String& dstPath, uint16_t size) {
+    if (size == 0 || size > IMAGE_CONVERT_MAX_SIZE) {
+        LOGE("IMG", "❌ Ungültige Zielgröße: %u", size);
+        return false;
+    }
+
+    File file = SPIFFS.open(srcPath, "r");
+    if (!file) {
+        LOGE("IMG", "❌ Kann Bilddatei nicht öffnen: %s", srcPath.c_str());
+        return false;
+    }
+
+    // Format am Inhalt erkennen - die Dateiendung ist nicht verlässlich
+    uint8_t magic[4] = { 0 };
+    file.read(magic, sizeof(magic));
+    file.seek(0);
+
+    ConvertTarget t;
+    t.size = size;
+    t.srcWidth = 0;
+    t.srcHeight = 0;
+    t.lineBuffer = nullptr;
+    t.png = nullptr;
+    t.rgb = (uint8_t*)malloc((size_t)size * size * 3);
+    if (!t.rgb) {
+        file.close();
+        LOGE("IMG", "❌ Speicher für Bildkonvertierung fehlt");
+        return false;
+    }
+    memset(t.rgb, 0xFF, (size_t)size * size * 3);
+
+    unsigned long start = millis();
+    bool decoded = false;
+    if (magic[0] == 'B' && magic[1] == 'M') {
+        LOGD("IMG", "🖼️ Konvertiere BMP...");
+        decoded = decodeBmp(file, t);
+        file.close();
+    } else if (magic[0] == 0xFF && magic[1] == 0xD8 && magic[2] == 0xFF) {
+        file.close();
+        LOGD("IMG", "🖼️ Konvertiere JPEG...");
+        decoded = decodeJpeg(srcPath, t);
+    } else if (magic[0] == 0x89 && magic[1] == 'P' && magic[2] == 'N' && magic[3] == 'G') {
+        file.close();
+        LOGD("IMG", "🖼️ Konvertiere PNG...");
+        decoded = decodePng(srcPath, t);
+    } else {
+        file.close();
+        LOGE("IMG", "❌ Unbekanntes Bildformat (0x%02X 0x%02X 0x%02X 0x%02X)",
+             magic[0], magic[1], magic[2], magic[3]);
+    }
+
+    bool ok = false;
+    if (decoded) {
+        size_t planeSize = (size_t)((size + 7) / 8) * size;
+        uint8_t* planes = (uint8_t*)malloc(planeSize * 2);
+        if (planes) {
+            ditherToPlanes(t, planes, planes + planeSize);
+            ok = writeEpdFile(dstPath, size, planes, planes + planeSize, planeSize);
+            free(planes);
+        } else {
+            LOGE("IMG", "❌ Speicher für Bit-Ebenen fehlt");
+        }
+    }
+
+    free(t.rgb);
+
+    if (ok) {
+        LOGI("IMG", "✅ Bild konvertiert: %s -> %s (%ldx%ld -> %ux%u, %lu ms)",
+             srcPath.c_str(), dstPath.c_str(), (long)t.srcWidth, (long)t.srcHeight,
+             size, size, millis() - start);
+    }
+    return ok;
+}
@@ -0,0 +1,34 @@
+#ifndef IMAGE_CONVERT_H
+#define IMAGE_CONVERT_H
+
+#include <Arduino.h>
+
+// Einmalige Vorverarbeitung hochgeladener Bilder (BMP, JPEG, PNG).
+// Das Bild wird auf die Zielgröße skaliert, per Floyd-Steinberg auf
+// Schwarz/Rot/Weiß gedithert und als gepackte Bit-Ebenen gespeichert.
+// Beim Zeichnen muss danach nur noch ein drawBitmap() ausgeführt werden.
+
+// Dateiformat (.epd):
+//   Header:  "EPD3" | uint16 Breite | uint16 Höhe   (Little Endian)
+//   Daten:   Schwarz-Ebene, danach Rot-Ebene
+//            je (Breite + 7) / 8 Bytes pro Zeile, MSB zuerst, Bit = 1 -> Pixel gesetzt
+#define EPD_IMAGE_MAGIC "EPD3"
+#define EPD_IMAGE_PATH "/badge_image.epd"
+#define EPD_IMAGE_HEADER_SIZE 8
+
+// Größte unterstützte Zielkantenlänge
+#define IMAGE_CONVERT_MAX_SIZE 128
+
+// Größte akzeptierte Quellbildkante (Schutz vor riesigen Dateien)
+#define IMAGE_CONVERT_MAX_SOURCE 4096
+
+// Rohbild (Format wird am Dateiinhalt erkannt) nach dstPath konvertieren
+bool convertImageToEpd(const String& srcPath, const String& dstPath, uint16_t size);
+
+// true, wenn der Pfad auf ein bereits konvertiertes Bild zeigt
+bool isEpdImagePath(const String& path);
+
+// Konvertiertes Bild als 4-Bit-BMP ausgeben (Vorschau im Browser)
+bool writeEpdAsBmp(const String& path, Print& out);
+
+#endif // IMAGE_CONVERT_H
@@ -0,0 +1,117 @@
+#include "Log.h"
+#include "LogBuffer.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <stdarg.h>
+
+// Web-Logs (definiert in WebUI.cpp)
+extern LogBuffer espLogBuffer;
+extern LogBuffer bqLogBuffer;
+
+// Tiefe der Warteschlange; jede Zeile belegt sizeof(LogMessage) Bytes
+#define LOG_QUEUE_LENGTH 24
+#define LOG_TAG_MAX 6
+
+struct LogMessage {
+    uint32_t timestampMs;
+    uint8_t level;
+    char tag[LOG_TAG_MAX + 1];
+    char text[LOG_LINE_MAX + 1];
+};
+
+volatile uint8_t logRuntimeLevel = BADGE_LOG_LEVEL;
+
+static QueueHandle_t logQueue = NULL;
+static TaskHandle_t logTaskHandle = NULL;
+static volatile uint32_t droppedLogs = 0;
+static portMUX_TYPE logMux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char levelLetters[] = { '-', 'E', 'W', 'I', 'D', 'V' };
+
+static void emitMessage(const LogMessage& message) {
+    char level = message.level <= BADGE_LOG_VERBOSE ? levelLetters[message.level] : '?';
+    // Zeit des Aufrufs, nicht der (verzögerten) Ausgabe
+    Serial.printf("[%6lu][%c][%s] %s\n", (unsigned long)message.timestampMs, level, message.tag, message.text);
+
+    if (message.level <= BADGE_LOG_WEB_LEVEL) {
+        LogBuffer& logs = strcmp(message.tag, LOG_TAG_CHARGER) == 0 ? bqLogBuffer : espLogBuffer;
+        logs.append(message.text, strlen(message.text), message.timestampMs);
+    }
+}
+
+// Gibt eingereihte Zeilen aus - niedrige Priorität, blockiert keine Echtzeit-Tasks
+static void logDrainTask(void* parameter) {
+    LogMessage message;
+    uint32_t reportedDrops = 0;
+
+    while (true) {
+        if (xQueueReceive(logQueue, &message, portMAX_DELAY) == pdTRUE) {
+            emitMessage(message);
+        }
+
+        uint32_t dropped = droppedLogs;
+        if (dropped != reportedDrops && uxQueueMessagesWaiting(logQueue) == 0) {
+            Serial.printf("[W][LOG] %lu Log-Zeilen verworfen (Warteschlange voll)\n",
+                          (unsigned long)(dropped - reportedDrops));
+            reportedDrops = dropped;
+        }
+    }
+}
+
+void initLogging() {
+    if (logQueue != NULL) {
+        return;
+    }
+
+    logQueue = xQueueCreate(LOG_QUEUE_LENGTH, sizeof(LogMessage));
+    if (logQueue == NULL) {
+        Serial.println("❌ Log-Warteschlange konnte nicht angelegt werden - direkte Ausgabe");
+        return;
+    }
+
+    BaseType_t result = xTaskCreate(logDrainTask, "LogDrain", 3072, NULL, 1, &logTaskHandle);
+    if (result != pdPASS) {
+        Serial.println("❌ Log-Task konnte nicht gestartet werden - direkte Ausgabe");
+        vQueueDelete(logQueue);
+        logQueue = NULL;
+        logTaskHandle = NULL;
+    }
+}
+
+void setLogLevel(uint8_t level) {
+    if (level > BADGE_LOG_LEVEL) {
+        level = BADGE_LOG_LEVEL;  // Nicht einkompilierte Stufen bleiben aus
+    }
+    logRuntimeLevel = level;
+}
+
+uint32_t getDroppedLogCount() {
+    return droppedLogs;
+}
+
+void logWrite(uint8_t level, const char* tag, const char* format, ...) {
+    LogMessage message;
+    message.timestampMs = millis();
+    message.level = level;
+    strncpy(message.tag, tag != nullptr ? tag : "", LOG_TAG_MAX);
+    message.tag[LOG_TAG_MAX] = '\0';
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message.text, sizeof(message.text), format, args);
+    va_end(args);
+
+    // Vor initLogging() oder ohne Task: direkt ausgeben
+    if (logQueue == NULL) {
+        emitMessage(message);
+        return;
+    }
+
+    // Nie blockieren - lieber eine Zeile verlieren als einen Frame
+    if (xQueueSend(logQueue, &message, 0) != pdTRUE) {
+        portENTER_CRITICAL(&logMux);
+        droppedLogs++;
+        portEXIT_CRITICAL(&logMux);
+    }
+}
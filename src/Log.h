@@ -0,0 +1,97 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+
+// Strukturiertes Logging mit Stufen und Subsystem-Tags.
+//
+//   LOGI("WEB", "Route %s aufgerufen", url);
+//
+// - Stufen oberhalb von BADGE_LOG_LEVEL werden komplett weg-kompiliert
+//   (weder Formatstring noch Argumente landen im Binary).
+// - Zur Laufzeit kann die Stufe zusätzlich abgesenkt werden (setLogLevel).
+//   Die Argumente werden nur ausgewertet, wenn die Stufe aktiv ist.
+// - Der Aufrufer formatiert nur in einen festen Puffer und reiht ihn ein;
+//   die Ausgabe auf UART und in den Web-Log übernimmt ein Task mit niedriger
+//   Priorität. Ist die Warteschlange voll, wird die Zeile verworfen und gezählt.
+
+#define BADGE_LOG_NONE    0
+#define BADGE_LOG_ERROR   1
+#define BADGE_LOG_WARN    2
+#define BADGE_LOG_INFO    3
+#define BADGE_LOG_DEBUG   4
+#define BADGE_LOG_VERBOSE 5
+
+// Höchste einkompilierte Stufe (per build_flags überschreibbar, z.B. -DBADGE_LOG_LEVEL=4)
+#ifndef BADGE_LOG_LEVEL
+#define BADGE_LOG_LEVEL BADGE_LOG_INFO
+#endif
+
+// Ab dieser Stufe (und wichtiger) landen Zeilen auch im Web-Log
+#ifndef BADGE_LOG_WEB_LEVEL
+#define BADGE_LOG_WEB_LEVEL BADGE_LOG_INFO
+#endif
+
+// Zeilen mit diesem Tag gehen in den BQ25895-Log statt in den ESP-Log
+#define LOG_TAG_CHARGER "BQ"
+
+// Aktuelle Laufzeit-Stufe (nur lesen, setzen über setLogLevel)
+extern volatile uint8_t logRuntimeLevel;
+
+// Drain-Task und Warteschlange anlegen (früh in setup() aufrufen)
+void initLogging();
+
+void setLogLevel(uint8_t level);
+
+// Anzahl verworfener Zeilen (Warteschlange voll)
+uint32_t getDroppedLogCount();
+
+// Nicht direkt verwenden - nur über die Makros
+void logWrite(uint8_t level, const char* tag, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#define BADGE_LOG_AT(level, tag, format, ...) do { \
+        if ((level) <= logRuntimeLevel) { \
+            logWrite((level), (tag), format, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+// Weg-kompilierte Stufen: Argumente bleiben "benutzt" (keine Warnungen),
+// werden aber nie ausgewertet
+#define BADGE_LOG_DISABLED(tag, format, ...) do { \
+        if (0) { \
+            logWrite(0, (tag), format, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#if BADGE_LOG_LEVEL >= BADGE_LOG_ERROR
+#define LOGE(tag, format, ...) BADGE_LOG_AT(BADGE_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#else
+#define LOGE(tag, format, ...) BADGE_LOG_DISABLED(tag, format, ##__VA_ARGS__)
+#endif
+
+#if BADGE_LOG_LEVEL >= BADGE_LOG_WARN
+#define LOGW(tag, format, ...) BADGE_LOG_AT(BADGE_LOG_WARN, tag, format, ##__VA_ARGS__)
+#else
+#define LOGW(tag, format, ...) BADGE_LOG_DISABLED(tag, format, ##__VA_ARGS__)
+#endif
+
+#if BADGE_LOG_LEVEL >= BADGE_LOG_INFO
+#define LOGI(tag, format, ...) BADGE_LOG_AT(BADGE_LOG_INFO, tag, format, ##__VA_ARGS__)
+#else
+#define LOGI(tag, format, ...) BADGE_LOG_DISABLED(tag, format, ##__VA_ARGS__)
+#endif
+
+#if BADGE_LOG_LEVEL >= BADGE_LOG_DEBUG
+#define LOGD(tag, format, ...) BADGE_LOG_AT(BADGE_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#else
+#define LOGD(tag, format, ...) BADGE_LOG_DISABLED(tag, format, ##__VA_ARGS__)
+#endif
+
+#if BADGE_LOG_LEVEL >= BADGE_LOG_VERBOSE
+#define LOGV(tag, format, ...) BADGE_LOG_AT(BADGE_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
+#else
+#define LOGV(tag, format, ...) BADGE_LOG_DISABLED(tag, format, ##__VA_ARGS__)
+#endif
+
+#endif // LOG_H
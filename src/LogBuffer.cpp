@@ -0,0 +1,152 @@
+#include "LogBuffer.h"
+
+// Kopf eines Datensatzes: Sequenz (4) | Zeit (4) | Länge (2)
+#define LOG_RECORD_HEADER 10
+
+LogBuffer::LogBuffer(uint8_t* storage, size_t capacity)
+    : buffer(storage), capacity(capacity) {
+}
+
+void LogBuffer::writeBytes(uint32_t offset, const void* data, size_t length) {
+    offset %= capacity;
+    size_t first = length < capacity - offset ? length : capacity - offset;
+    memcpy(buffer + offset, data, first);
+    memcpy(buffer, (const uint8_t*)data + first, length - first);
+}
+
+void LogBuffer::readBytes(uint32_t offset, void* data, size_t length) const {
+    offset %= capacity;
+    size_t first = length < capacity - offset ? length : capacity - offset;
+    memcpy(data, buffer + offset, first);
+    memcpy((uint8_t*)data + first, buffer, length - first);
+}
+
+uint16_t LogBuffer::recordLengthAt(uint32_t offset) const {
+    uint16_t length;
+    readBytes(offset + 8, &length, sizeof(length));
+    return length;
+}
+
+// Ältesten Datensatz verwerfen (nur innerhalb des kritischen Abschnitts)
+void LogBuffer::dropOldest() {
+    size_t recordSize = LOG_RECORD_HEADER + recordLengthAt(tail);
+    tail = (tail + recordSize) % capacity;
+    used -= recordSize;
+    firstSeq++;
+}
+
+uint32_t LogBuffer::append(const char* text, size_t length, uint32_t timestamp) {
+    if (length > LOG_LINE_MAX) {
+        length = LOG_LINE_MAX;
+    }
+    size_t recordSize = LOG_RECORD_HEADER + length;
+    if (buffer == nullptr || recordSize > capacity) {
+        return 0;
+    }
+
+    uint16_t length16 = length;
+
+    portENTER_CRITICAL(&mux);
+    while (capacity - used < recordSize) {
+        dropOldest();
+    }
+
+    uint32_t sequence = nextSeq++;
+    uint8_t header[LOG_RECORD_HEADER];
+    memcpy(&header[0], &sequence, 4);
+    memcpy(&header[4], &timestamp, 4);
+    memcpy(&header[8], &length16, 2);
+    writeBytes(head, header, sizeof(header));
+    writeBytes(head + LOG_RECORD_HEADER, text, length);
+
+    head = (head + recordSize) % capacity;
+    used += recordSize;
+    portEXIT_CRITICAL(&mux);
+
+    return sequence;
+}
+
+bool LogBuffer::next(LogCursor& cursor, LogRecord& out) {
+    portENTER_CRITICAL(&mux);
+
+    // Überschriebene oder unbekannte Position: vom ältesten Datensatz aus suchen
+    if (cursor.nextSequence < firstSeq || !cursor.offsetValid) {
+        uint32_t offset = tail;
+        uint32_t sequence = firstSeq;
+        while (sequence < cursor.nextSequence && sequence < nextSeq) {
+            offset = (offset + LOG_RECORD_HEADER + recordLengthAt(offset)) % capacity;
+            sequence++;
+        }
+        cursor.nextSequence = sequence;
+        cursor.offset = offset;
+        cursor.offsetValid = true;
+    }
+
+    if (cursor.nextSequence >= nextSeq) {
+        portEXIT_CRITICAL(&mux);
+        return false;
+    }
+
+    uint8_t header[LOG_RECORD_HEADER];
+    readBytes(cursor.offset, header, sizeof(header));
+    memcpy(&out.sequence, &header[0], 4);
+    memcpy(&out.timestampMs, &header[4], 4);
+    memcpy(&out.length, &header[8], 2);
+    readBytes(cursor.offset + LOG_RECORD_HEADER, out.text, out.length);
+    out.text[out.length] = '\0';
+
+    cursor.offset = (cursor.offset + LOG_RECORD_HEADER + out.length) % capacity;
+    cursor.nextSequence = out.sequence + 1;
+
+    portEXIT_CRITICAL(&mux);
+    return true;
+}
+
+LogCursor LogBuffer::oldest() {
+    LogCursor cursor;
+    portENTER_CRITICAL(&mux);
+    cursor.nextSequence = firstSeq;
+    cursor.offset = tail;
+    cursor.offsetValid = true;
+    portEXIT_CRITICAL(&mux);
+    return cursor;
+}
+
+LogCursor LogBuffer::newest() {
+    LogCursor cursor;
+    portENTER_CRITICAL(&mux);
+    cursor.nextSequence = nextSeq;
+    cursor.offset = head;
+    cursor.offsetValid = true;
+    portEXIT_CRITICAL(&mux);
+    return cursor;
+}
+
+void LogBuffer::clear() {
+    portENTER_CRITICAL(&mux);
+    tail = head;
+    used = 0;
+    firstSeq = nextSeq;
+    portEXIT_CRITICAL(&mux);
+}
+
+uint32_t LogBuffer::lastSequence() {
+    portENTER_CRITICAL(&mux);
+    uint32_t sequence = nextSeq - 1;
+    portEXIT_CRITICAL(&mux);
+    return sequence;
+}
+
+uint32_t LogBuffer::firstSequence() {
+    portENTER_CRITICAL(&mux);
+    uint32_t sequence = firstSeq;
+    portEXIT_CRITICAL(&mux);
+    return sequence;
+}
+
+size_t LogBuffer::count() {
+    portENTER_CRITICAL(&mux);
+    size_t entries = nextSeq - firstSeq;
+    portEXIT_CRITICAL(&mux);
+    return entries;
+}
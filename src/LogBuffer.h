@@ -0,0 +1,73 @@
+#ifndef LOG_BUFFER_H
+#define LOG_BUFFER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+// Ringpuffer für Log-Zeilen mit fester Größe.
+// Jede Zeile wird als Datensatz [Sequenz | Zeit | Länge | Text] direkt in einen
+// vorab reservierten Byte-Puffer geschrieben - keine Heap-Allokation pro Zeile.
+// Ist der Puffer voll, werden die ältesten Datensätze überschrieben.
+// Schreiben und Lesen sind aus beliebigen Tasks erlaubt (kurze Spinlock-Abschnitte).
+
+// Längste gespeicherte Zeile, längere werden abgeschnitten
+#define LOG_LINE_MAX 160
+
+// Ein gelesener Datensatz
+struct LogRecord {
+    uint32_t sequence;          // Fortlaufende Nummer, beginnt bei 1
+    uint32_t timestampMs;       // millis() beim Entstehen der Zeile
+    uint16_t length;            // Textlänge ohne Nullterminator
+    char text[LOG_LINE_MAX + 1];
+};
+
+// Lese-Position eines Lesers. Bleibt gültig, solange der Datensatz nicht
+// überschrieben wurde - sonst springt der Leser zum ältesten vorhandenen.
+struct LogCursor {
+    uint32_t nextSequence = 1;  // Als nächstes zu lesende Sequenz
+    uint32_t offset = 0;        // Byte-Position von nextSequence im Puffer
+    bool offsetValid = false;
+};
+
+class LogBuffer {
+public:
+    LogBuffer(uint8_t* storage, size_t capacity);
+
+    // Zeile anhängen, gibt die vergebene Sequenznummer zurück
+    uint32_t append(const char* text, size_t length) { return append(text, length, millis()); }
+    uint32_t append(const String& text) { return append(text.c_str(), text.length()); }
+
+    // Mit Zeitstempel des Aufrufers (z.B. zeitversetzt aus dem Log-Task)
+    uint32_t append(const char* text, size_t length, uint32_t timestampMs);
+
+    // Nächsten Datensatz ab Cursor lesen, false wenn keiner mehr vorhanden
+    bool next(LogCursor& cursor, LogRecord& out);
+
+    // Cursor auf den ältesten bzw. hinter den neuesten Datensatz setzen
+    LogCursor oldest();
+    LogCursor newest();
+
+    // Alle Einträge verwerfen (Sequenznummern laufen weiter)
+    void clear();
+
+    uint32_t lastSequence();    // 0 = noch nichts geschrieben
+    uint32_t firstSequence();   // Ältester noch vorhandener Eintrag
+    size_t count();
+
+private:
+    void writeBytes(uint32_t offset, const void* data, size_t length);
+    void readBytes(uint32_t offset, void* data, size_t length) const;
+    uint16_t recordLengthAt(uint32_t offset) const;
+    void dropOldest();
+
+    uint8_t* buffer;
+    size_t capacity;
+    uint32_t head = 0;          // Schreibposition
+    uint32_t tail = 0;          // Position des ältesten Datensatzes
+    size_t used = 0;            // Belegte Bytes
+    uint32_t firstSeq = 1;      // Sequenz des Datensatzes an tail
+    uint32_t nextSeq = 1;       // Sequenz des nächsten Datensatzes
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+#endif // LOG_BUFFER_H
@@ -0,0 +1,768 @@
+#include "OtaAgent.h"
+#include "WiFiManager.h"
+#include "Settings.h"
+#include "Globals.h"
+#include "Boot.h"
+#include "Log.h"
+#include <ArduinoJson.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <Update.h>
+#include <mbedtls/sha256.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <esp_ota_ops.h>
+#include "OtaDecoder.h"
+#include "OtaHealth.h"
+
+// Status-LED-Feedback aus main.cpp
+extern void startStatusLedUpdate();
+extern void startStatusLedReboot();
+extern void startStatusLedLock();
+extern void startStatusLedUnlock();
+extern void showStatusLedError();
+
+#define OTA_AGENT_STACK 8192
+#define OTA_NETWORK_POLL_MS 1000      // Ohne WLAN: so oft nachsehen (kostet nichts)
+#define OTA_REBOOT_DELAY_MS 2000      // Zeit für das LED-Feedback vor dem Neustart
+#define OTA_MAX_FIRMWARE_SIZE 0x400000
+#define OTA_CHUNK_SIZE 4096           // Ein Flash-Sektor pro Puffer
+#define OTA_WRITER_STACK 4096
+#define OTA_RESUME_ATTEMPTS 5         // Fortsetzungen ohne Fortschritt, dann Abbruch
+#define OTA_RESUME_DELAY_MS 1000      // Wächst mit jedem Fehlversuch
+#define OTA_INPUT_SIZE 1460           // Ein TCP-Segment Download-Daten pro Decoder-Aufruf
+
+enum CheckinResult {
+    CHECKIN_FAILED = 0,
+    CHECKIN_OK,
+    CHECKIN_NOT_MODIFIED
+};
+
+static TaskHandle_t otaTaskHandle = NULL;
+static volatile OtaAgentState agentState = OTA_AGENT_IDLE;
+static volatile bool checkinRequested = false;
+static volatile uint32_t nextCheckinAt = 0;
+
+static uint32_t checkinCount = 0;
+static uint32_t notModifiedCount = 0;
+static uint8_t consecutiveFailures = 0;
+static volatile int lastHttpCode = 0;
+static volatile uint32_t lastCheckinMs = 0;
+
+static volatile uint32_t downloadBytes = 0;
+static volatile uint32_t downloadTotal = 0;
+static volatile uint16_t downloadKbps = 0;
+static volatile uint8_t downloadResumes = 0;
+
+// SHA-256 des laufenden Images (wie die .bin-Datei auf dem Server), Basis für Deltas
+static char runningSha[65] = "";
+
+// ETag der letzten reinen Status-Antwort (leer = nächster Checkin unbedingt)
+static char lastEtag[48] = "";
+
+// Zufallsanteil +/- percent, damit viele Badges nicht im Gleichtakt anfragen
+static uint32_t withJitter(uint32_t base, uint8_t percent) {
+    uint32_t spread = base / 100 * percent;
+    return base - spread + esp_random() % (2 * spread + 1);
+}
+
+static void scheduleNext(uint32_t delayMs) {
+    nextCheckinAt = millis() + delayMs;
+}
+
+// ---------------------------------------------------------------------------
+// Firmware-Download: Der Agent-Task liest aus dem Netz, ein eigener Writer-Task
+// schreibt in den Flash. Zwei Puffer wandern zwischen beiden hin und her, so
+// läuft der TCP-Empfang weiter, während ein Sektor gelöscht und geschrieben wird.
+
+struct OtaChunk {
+    uint8_t index;      // Welcher Puffer
+    uint16_t length;    // 0 = Ende, Writer beendet sich
+};
+
+struct OtaPipeline {
+    uint8_t* buffers[2];
+    QueueHandle_t freeQueue;      // Leere Puffer (Index) für den Leser
+    QueueHandle_t fullQueue;      // Volle Puffer (OtaChunk) für den Writer
+    SemaphoreHandle_t writerDone;
+    mbedtls_sha256_context sha;
+    volatile size_t flashed;
+    volatile bool writeFailed;
+
+    // Puffer, den der Leser gerade füllt (-1 = keiner)
+    int8_t fillIndex;
+    size_t fillLength;
+    size_t produced;              // An den Writer gegebene Image-Bytes
+    size_t imageSize;
+
+    uint8_t* input;               // Download-Daten vor dem Decoder (Delta, BCMP)
+};
+
+enum DownloadOpen {
+    DOWNLOAD_OPEN_OK = 0,
+    DOWNLOAD_OPEN_RETRY,   // Netzwerkfehler - später fortsetzen
+    DOWNLOAD_OPEN_FATAL    // Falsche URL, Größe oder Server ohne Range-Support
+};
+
+static void flashWriterTask(void* parameter) {
+    OtaPipeline& pipe = *static_cast<OtaPipeline*>(parameter);
+    OtaChunk chunk;
+
+    while (xQueueReceive(pipe.fullQueue, &chunk, portMAX_DELAY) == pdTRUE && chunk.length > 0) {
+        uint8_t* data = pipe.buffers[chunk.index];
+        if (!pipe.writeFailed) {
+            mbedtls_sha256_update_ret(&pipe.sha, data, chunk.length);
+            size_t written = Update.write(data, chunk.length);
+            if (written != chunk.length) {
+                LOGE("OTA", "Nur %u von %u Bytes geschrieben: %s",
+                     (unsigned)written, (unsigned)chunk.length, Update.errorString());
+                pipe.writeFailed = true;
+            } else {
+                pipe.flashed += written;
+            }
+        }
+        xQueueSend(pipe.freeQueue, &chunk.index, portMAX_DELAY);
+    }
+
+    xSemaphoreGive(pipe.writerDone);
+    vTaskDelete(NULL);
+}
+
+static bool createPipeline(OtaPipeline& pipe) {
+    memset(&pipe, 0, sizeof(pipe));
+    pipe.buffers[0] = (uint8_t*)malloc(OTA_CHUNK_SIZE);
+    pipe.buffers[1] = (uint8_t*)malloc(OTA_CHUNK_SIZE);
+    pipe.freeQueue = xQueueCreate(2, sizeof(uint8_t));
+    pipe.fullQueue = xQueueCreate(3, sizeof(OtaChunk));   // 2 Puffer + Ende-Marke
+    pipe.writerDone = xSemaphoreCreateBinary();
+    pipe.input = (uint8_t*)malloc(OTA_INPUT_SIZE);
+    pipe.fillIndex = -1;
+    mbedtls_sha256_init(&pipe.sha);
+
+    if (pipe.buffers[0] == NULL || pipe.buffers[1] == NULL || pipe.freeQueue == NULL ||
+        pipe.fullQueue == NULL || pipe.writerDone == NULL || pipe.input == NULL) {
+        return false;
+    }
+    for (uint8_t i = 0; i < 2; i++) {
+        xQueueSend(pipe.freeQueue, &i, 0);
+    }
+    mbedtls_sha256_starts_ret(&pipe.sha, 0);
+    return true;
+}
+
+static void destroyPipeline(OtaPipeline& pipe) {
+    mbedtls_sha256_free(&pipe.sha);
+    if (pipe.writerDone != NULL) vSemaphoreDelete(pipe.writerDone);
+    if (pipe.fullQueue != NULL) vQueueDelete(pipe.fullQueue);
+    if (pipe.freeQueue != NULL) vQueueDelete(pipe.freeQueue);
+    free(pipe.buffers[0]);
+    free(pipe.buffers[1]);
+    free(pipe.input);
+}
+
+// Platz im aktuellen Ausgabepuffer; holt bei Bedarf einen freien
+// (wartet nur, wenn der Flash hinterherhängt)
+static uint8_t* outputSpace(OtaPipeline& pipe, size_t& space) {
+    if (pipe.fillIndex < 0) {
+        uint8_t index;
+        xQueueReceive(pipe.freeQueue, &index, portMAX_DELAY);
+        pipe.fillIndex = index;
+        pipe.fillLength = 0;
+    }
+    space = OTA_CHUNK_SIZE - pipe.fillLength;
+    return pipe.buffers[pipe.fillIndex] + pipe.fillLength;
+}
+
+// Angefangenen Puffer an den Writer geben
+static void flushOutput(OtaPipeline& pipe) {
+    if (pipe.fillIndex < 0) {
+        return;
+    }
+    uint8_t index = pipe.fillIndex;
+    if (pipe.fillLength > 0) {
+        OtaChunk chunk = { index, (uint16_t)pipe.fillLength };
+        xQueueSend(pipe.fullQueue, &chunk, portMAX_DELAY);
+    } else {
+        xQueueSend(pipe.freeQueue, &index, portMAX_DELAY);
+    }
+    pipe.fillIndex = -1;
+    pipe.fillLength = 0;
+}
+
+static void commitOutput(OtaPipeline& pipe, size_t length) {
+    pipe.fillLength += length;
+    pipe.produced += length;
+    if (pipe.fillLength == OTA_CHUNK_SIZE) {
+        flushOutput(pipe);
+    }
+}
+
+// Ausgabe des Decoders
+static bool pipelineOutput(void* context, const uint8_t* data, size_t length) {
+    OtaPipeline& pipe = *static_cast<OtaPipeline*>(context);
+    if (pipe.writeFailed || length > pipe.imageSize - pipe.produced) {
+        return false;
+    }
+    while (length > 0) {
+        size_t space;
+        uint8_t* out = outputSpace(pipe, space);
+        size_t n = min(space, length);
+        memcpy(out, data, n);
+        commitOutput(pipe, n);
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+// Verbindung ab Byte offset öffnen; beim ersten Aufruf ergibt sich total
+// aus der Server-Antwort, falls der Checkin keine Größe mitgeliefert hat
+static DownloadOpen openDownload(HTTPClient& http, WiFiClient& client, const String& url,
+                                 size_t offset, size_t& total) {
+    http.setConnectTimeout(OTA_CONNECT_TIMEOUT_MS);
+    http.setTimeout(OTA_DOWNLOAD_TIMEOUT_MS);
+    if (!http.begin(client, url)) {
+        LOGE("OTA", "Ungültige Firmware-URL");
+        return DOWNLOAD_OPEN_FATAL;
+    }
+    if (offset > 0) {
+        http.addHeader("Range", "bytes=" + String((unsigned long)offset) + "-");
+    }
+
+    int httpCode = http.GET();
+    if (httpCode < 0) {
+        LOGW("OTA", "Download-Verbindung fehlgeschlagen: %s", http.errorToString(httpCode).c_str());
+        http.end();
+        return DOWNLOAD_OPEN_RETRY;
+    }
+
+    int expectedCode = offset > 0 ? 206 : 200;
+    if (httpCode != expectedCode) {
+        LOGE("OTA", "HTTP-Fehler beim Download: %d (erwartet %d)", httpCode, expectedCode);
+        http.end();
+        // 5xx kann vorübergehend sein; 404 oder ein ignorierter Range-Header nicht
+        return httpCode >= 500 ? DOWNLOAD_OPEN_RETRY : DOWNLOAD_OPEN_FATAL;
+    }
+
+    int length = http.getSize();
+    if (offset == 0 && total == 0) {
+        total = length > 0 ? length : 0;
+    }
+    if (total == 0 || total > OTA_MAX_FIRMWARE_SIZE ||
+        (length > 0 && (size_t)length != total - offset)) {
+        LOGE("OTA", "Ungültige Firmware-Größe: %d bytes ab %u (erwartet %u, Limit %d)",
+             length, (unsigned)offset, (unsigned)total, OTA_MAX_FIRMWARE_SIZE);
+        http.end();
+        return DOWNLOAD_OPEN_FATAL;
+    }
+    return DOWNLOAD_OPEN_OK;
+}
+
+static void reportProgress(size_t received, size_t total, uint32_t startMs, int& lastDecile) {
+    uint32_t elapsed = millis() - startMs;
+    downloadBytes = received;
+    downloadKbps = elapsed > 0 ? (uint64_t)received * 1000 / 1024 / elapsed : 0;
+
+    int decile = (uint64_t)received * 10 / total;
+    if (decile != lastDecile) {
+        LOGI("OTA", "Fortschritt: %u/%u bytes (%d%%), %u kB/s",
+             (unsigned)received, (unsigned)total, decile * 10, (unsigned)downloadKbps);
+        lastDecile = decile;
+    }
+}
+
+// Wartet bis OTA_READ_TIMEOUT_MS auf Daten und liest höchstens length Bytes;
+// 0 = Verbindung weg oder hängt
+static size_t readBody(HTTPClient& http, WiFiClient* stream, uint8_t* buffer, size_t length) {
+    uint32_t waitStart = millis();
+    for (;;) {
+        size_t available = stream->available();
+        if (available > 0) {
+            int readBytes = stream->read(buffer, min(available, length));
+            return readBytes > 0 ? readBytes : 0;
+        }
+        if (!http.connected() || millis() - waitStart > OTA_READ_TIMEOUT_MS) {
+            return 0;
+        }
+        vTaskDelay(1);
+    }
+}
+
+// Liest den Body ab received und reicht ihn an den Writer weiter - ein volles
+// Image direkt in die Ausgabepuffer, Delta oder BCMP über den Decoder.
+// Kehrt zurück, wenn alles gelesen ist, die Verbindung abbricht oder hängt.
+static void streamToWriter(HTTPClient& http, OtaPipeline& pipe, OtaDecoder* decoder,
+                           size_t total, size_t& received, uint32_t startMs, int& lastDecile) {
+    WiFiClient* stream = http.getStreamPtr();
+
+    while (received < total && !pipe.writeFailed) {
+        size_t readBytes;
+        if (decoder == NULL) {
+            size_t space;
+            uint8_t* out = outputSpace(pipe, space);
+            readBytes = readBody(http, stream, out, min(space, total - received));
+            commitOutput(pipe, readBytes);
+        } else {
+            readBytes = readBody(http, stream, pipe.input, min((size_t)OTA_INPUT_SIZE, total - received));
+            if (readBytes > 0 && !otaDecoderFeed(decoder, pipe.input, readBytes)) {
+                pipe.writeFailed = true;   // Decoder hat den Grund schon geloggt
+                return;
+            }
+        }
+
+        if (readBytes == 0) {
+            LOGW("OTA", "Download unterbrochen bei %u/%u bytes", (unsigned)received, (unsigned)total);
+            return;
+        }
+        received += readBytes;
+        reportProgress(received, total, startMs, lastDecile);
+    }
+}
+
+// SHA-256 als Hex-String (hex: 65 Zeichen)
+static void toHex(const uint8_t* digest, char* hex) {
+    for (int i = 0; i < 32; i++) {
+        sprintf(hex + i * 2, "%02x", digest[i]);
+    }
+}
+
+static bool checksumMatches(OtaPipeline& pipe, const String& expectedSha) {
+    uint8_t digest[32];
+    mbedtls_sha256_finish_ret(&pipe.sha, digest);
+
+    char hex[65];
+    toHex(digest, hex);
+
+    if (expectedSha.length() == 0) {
+        LOGW("OTA", "Server liefert keine SHA-256 - Firmware ungeprüft (%s)", hex);
+        return true;
+    }
+    if (strcasecmp(hex, expectedSha.c_str()) != 0) {
+        LOGE("OTA", "SHA-256 stimmt nicht: %s, erwartet %s", hex, expectedSha.c_str());
+        return false;
+    }
+    LOGI("OTA", "SHA-256 geprüft: %s", hex);
+    return true;
+}
+
+// Lädt url und schreibt das Image (imageSize Bytes, 0 = Größe aus dem Download)
+// in die freie OTA-Partition. Mit decode ist der Download ein BDLT-Delta gegen
+// die laufende Firmware oder ein BCMP-Image, bodySize dann dessen Größe.
+static bool downloadImage(String url, size_t bodySize, size_t imageSize,
+                          const String& expectedSha, bool decode) {
+    LOGI("OTA", "=== STARTE FIRMWARE UPDATE: %s ===", url.c_str());
+
+    if (url.startsWith("https://")) {
+        // HTTPS-Update wird nicht unterstützt
+        url = "http://" + url.substring(8);
+        LOGW("OTA", "HTTPS nicht unterstützt, verwende %s", url.c_str());
+    }
+
+    OtaPipeline pipe;
+    if (!createPipeline(pipe)) {
+        LOGE("OTA", "Kein Speicher für die Download-Puffer");
+        destroyPipeline(pipe);
+        return false;
+    }
+
+    OtaDecoder* decoder = NULL;
+    if (decode) {
+        decoder = otaDecoderCreate(esp_ota_get_running_partition(), imageSize, pipelineOutput, &pipe);
+        if (decoder == NULL) {
+            LOGE("OTA", "Kein Speicher für den Decoder");
+            destroyPipeline(pipe);
+            return false;
+        }
+    }
+
+    size_t total = bodySize;
+    size_t received = 0;
+    uint8_t failures = 0;
+    bool writerRunning = false;
+    bool fatal = false;
+    uint32_t startMs = millis();
+    int lastDecile = -1;
+    downloadBytes = 0;
+    downloadKbps = 0;
+    downloadResumes = 0;
+
+    while (!fatal && !pipe.writeFailed && (total == 0 || received < total)) {
+        if (failures > OTA_RESUME_ATTEMPTS) {
+            LOGE("OTA", "Download nach %d Fortsetzungsversuchen aufgegeben", OTA_RESUME_ATTEMPTS);
+            break;
+        }
+        if (received > 0 || failures > 0) {
+            uint32_t pause = OTA_RESUME_DELAY_MS * (failures + 1);
+            LOGI("OTA", "Setze Download bei %u bytes in %lu ms fort", (unsigned)received, (unsigned long)pause);
+            vTaskDelay(pdMS_TO_TICKS(pause));
+            if (received > 0) {
+                downloadResumes++;
+            }
+        }
+
+        WiFiClient client;
+        HTTPClient http;
+        DownloadOpen open = openDownload(http, client, url, received, total);
+        if (open == DOWNLOAD_OPEN_FATAL) {
+            fatal = true;
+            break;
+        }
+        if (open == DOWNLOAD_OPEN_RETRY) {
+            failures++;
+            continue;
+        }
+
+        if (!writerRunning) {
+            if (imageSize == 0) {
+                imageSize = total;
+            }
+            pipe.imageSize = imageSize;
+            downloadTotal = total;
+            LOGI("OTA", "Firmware-Größe %u bytes (Download %u), freier Heap %u, Update-Speicher %u",
+                 (unsigned)imageSize, (unsigned)total, (unsigned)ESP.getFreeHeap(),
+                 (unsigned)ESP.getFreeSketchSpace());
+            if (!Update.begin(imageSize)) {
+                LOGE("OTA", "Update.begin() fehlgeschlagen: %s", Update.errorString());
+                http.end();
+                fatal = true;
+                break;
+            }
+            if (xTaskCreate(flashWriterTask, "OtaFlash", OTA_WRITER_STACK, &pipe, 1, NULL) != pdPASS) {
+                LOGE("OTA", "Flash-Writer-Task konnte nicht erstellt werden");
+                http.end();
+                Update.abort();
+                fatal = true;
+                break;
+            }
+            writerRunning = true;
+        }
+
+        size_t before = received;
+        streamToWriter(http, pipe, decoder, total, received, startMs, lastDecile);
+        http.end();
+        failures = received > before ? 0 : failures + 1;
+    }
+
+    if (writerRunning) {
+        flushOutput(pipe);
+        OtaChunk end = { 0, 0 };
+        xQueueSend(pipe.fullQueue, &end, portMAX_DELAY);
+        xSemaphoreTake(pipe.writerDone, portMAX_DELAY);
+    }
+
+    bool ok = writerRunning && !pipe.writeFailed && received == total && pipe.flashed == imageSize &&
+              (decoder == NULL || otaDecoderFinished(decoder));
+    if (writerRunning && !ok) {
+        LOGE("OTA", "Download unvollständig: %u von %u bytes im Flash (%s)",
+             (unsigned)pipe.flashed, (unsigned)imageSize, Update.errorString());
+    }
+    // Ohne Prüfsumme vom Checkin gilt die aus dem BCMP-Kopf
+    String sha = expectedSha;
+    const uint8_t* imageSha = decoder != NULL ? otaDecoderImageSha(decoder) : NULL;
+    if (sha.length() == 0 && imageSha != NULL) {
+        char hex[65];
+        toHex(imageSha, hex);
+        sha = hex;
+    }
+    otaDecoderDestroy(decoder);
+    if (ok) {
+        ok = checksumMatches(pipe, sha);
+    }
+    destroyPipeline(pipe);
+
+    if (!ok) {
+        if (writerRunning) {
+            Update.abort();
+        }
+        return false;
+    }
+
+    if (!Update.end() || !Update.isFinished()) {
+        LOGE("OTA", "Update fehlgeschlagen beim Finalisieren: %s", Update.errorString());
+        return false;
+    }
+
+    uint32_t seconds = (millis() - startMs) / 1000;
+    LOGI("OTA", "=== UPDATE ERFOLGREICH: %u bytes (Download %u) in %lu s, %u kB/s, %u Fortsetzungen ===",
+         (unsigned)imageSize, (unsigned)total, (unsigned long)seconds, (unsigned)downloadKbps,
+         (unsigned)downloadResumes);
+    return true;
+}
+
+// Bevorzugt das Delta (wenn der Server eins für die laufende Firmware hat),
+// dann das komprimierte Image, zuletzt das rohe - jeweils, wenn das vorige scheitert
+static bool installFirmware(JsonDocument& doc) {
+    String url = doc["url"].as<String>();
+    size_t size = doc["size"] | 0;
+    String sha = doc["sha256"] | "";
+    JsonObject delta = doc["delta"];
+    JsonObject compressed = doc["compressed"];
+
+    // Ohne Zielprüfsumme kein Delta - ein falsch gepatchtes Image fiele sonst nicht auf
+    if (!delta.isNull() && size > 0 && sha.length() == 64 &&
+        strcmp(runningSha, delta["base_sha256"] | "") == 0) {
+        size_t deltaSize = delta["size"] | 0;
+        LOGI("OTA", "Delta-Update: %u statt %u bytes", (unsigned)deltaSize, (unsigned)size);
+        if (downloadImage(delta["url"].as<String>(), deltaSize, size, sha, true)) {
+            return true;
+        }
+        LOGW("OTA", "Delta-Update fehlgeschlagen - lade das volle Image");
+    }
+
+    if (!compressed.isNull() && size > 0) {
+        size_t compressedSize = compressed["size"] | 0;
+        LOGI("OTA", "Komprimiertes Image: %u statt %u bytes", (unsigned)compressedSize, (unsigned)size);
+        if (downloadImage(compressed["url"].as<String>(), compressedSize, size, sha, true)) {
+            return true;
+        }
+        LOGW("OTA", "Komprimiertes Image fehlgeschlagen - lade das rohe Image");
+    }
+    return downloadImage(url, size, size, sha, false);
+}
+
+// SHA-256 über das laufende Image (ohne das Füllmaterial der Partition)
+static void computeRunningSha() {
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    if (otaImageSha256(running, runningSha)) {
+        LOGD("OTA", "Laufendes Image auf %s: SHA-256 %s", running->label, runningSha);
+    } else {
+        LOGW("OTA", "Laufendes Image nicht lesbar - keine Delta-Updates");
+    }
+}
+
+static void rebootAfterFeedback() {
+    agentState = OTA_AGENT_REBOOT;
+    LOGI("OTA", "Starte Neustart in %d ms...", OTA_REBOOT_DELAY_MS);
+    vTaskDelay(pdMS_TO_TICKS(OTA_REBOOT_DELAY_MS));  // Nur dieser Task wartet
+    ESP.restart();
+}
+
+static void applyServerVersion(const String& newVersion) {
+    LOGI("OTA", "Version vom Server: '%s' -> '%s' (Firmware %s)",
+         dynamicVersion.c_str(), newVersion.c_str(), firmwareVersion);
+    dynamicVersion = newVersion;
+    settings.dynamicVersion = newVersion;
+
+    // Sofort speichern und mehrfach versuchen bei Fehlern
+    bool saved = false;
+    for (int i = 0; i < 3 && !saved; i++) {
+        saved = saveSettings();
+        if (!saved) {
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+    }
+    if (!saved) {
+        LOGE("OTA", "Neue Version konnte nicht gespeichert werden");
+    }
+}
+
+static void handleCheckinResponse(JsonDocument& doc) {
+    if (doc.containsKey("set_version")) {
+        applyServerVersion(doc["set_version"].as<String>());
+    }
+
+    if (doc["update"] == true) {
+        if (otaHealthPendingVerify()) {
+            // Ein weiteres Update würde die Partition der Rollback-Firmware überschreiben
+            LOGI("OTA", "Update zurückgestellt, bis die laufende Firmware bestätigt ist");
+            return;
+        }
+        if (!doc.containsKey("url")) {
+            LOGE("OTA", "Update gemeldet, aber keine URL in der Antwort");
+            return;
+        }
+        startStatusLedUpdate();  // Status-LED Feedback starten
+        agentState = OTA_AGENT_DOWNLOAD;
+        if (installFirmware(doc)) {
+            startStatusLedUpdate();  // Status-LED Feedback für erfolgreiches Update
+            rebootAfterFeedback();
+        } else {
+            showStatusLedError();
+        }
+    } else if (doc["reboot"] == true) {
+        LOGI("OTA", "Reboot-Befehl vom OTA Server empfangen!");
+        startStatusLedReboot();
+        rebootAfterFeedback();
+    } else if (doc["locked"] == true) {
+        LOGI("OTA", "Gerät ist gesperrt - keine Updates möglich");
+        startStatusLedLock();
+    } else if (doc["unlocked"] == true) {
+        LOGI("OTA", "Gerät ist entsperrt - Updates wieder möglich");
+        startStatusLedUnlock();
+    } else {
+        LOGD("OTA", "Kein Update verfügbar");
+    }
+}
+
+static CheckinResult performCheckin(const OtaHealthResult* healthResult) {
+    HTTPClient http;
+    http.setConnectTimeout(OTA_CONNECT_TIMEOUT_MS);
+    http.setTimeout(OTA_READ_TIMEOUT_MS);
+    if (!http.begin(otaCheckinUrl)) {
+        LOGE("OTA", "Ungültige Checkin-URL");
+        return CHECKIN_FAILED;
+    }
+
+    static const char* headerKeys[] = { "ETag" };
+    http.collectHeaders(headerKeys, 1);
+    http.addHeader("Content-Type", "application/json");
+    if (lastEtag[0] != '\0') {
+        http.addHeader("If-None-Match", lastEtag);
+    }
+
+    StaticJsonDocument<512> request;
+    request["id"] = deviceID;
+    request["version"] = dynamicVersion;
+    request["hardware_type"] = hardwaretype;
+    request["ssid"] = WiFi.SSID();
+    if (runningSha[0] != '\0') {
+        request["running_sha256"] = (const char*)runningSha;
+    }
+    if (healthResult != NULL) {
+        JsonObject result = request.createNestedObject("ota_result");
+        result["status"] = healthResult->status;
+        if (healthResult->sha256[0] != '\0') {
+            result["sha256"] = (const char*)healthResult->sha256;
+            result["reason"] = (const char*)healthResult->reason;
+        }
+    }
+    String payload;
+    serializeJson(request, payload);
+
+    int httpCode = http.POST(payload);
+    lastHttpCode = httpCode;
+
+    if (httpCode == 304) {
+        http.end();
+        LOGV("OTA", "Checkin: keine Änderung (304)");
+        return CHECKIN_NOT_MODIFIED;
+    }
+    if (httpCode != 200) {
+        LOGW("OTA", "Checkin fehlgeschlagen: %d (%s)", httpCode,
+             httpCode < 0 ? http.errorToString(httpCode).c_str() : "HTTP");
+        http.end();
+        return CHECKIN_FAILED;
+    }
+
+    // Nur reine Status-Antworten tragen ein ETag; Aktionen löschen es
+    String etag = http.header("ETag");
+    strncpy(lastEtag, etag.c_str(), sizeof(lastEtag) - 1);
+    lastEtag[sizeof(lastEtag) - 1] = '\0';
+    if (etag.length() >= sizeof(lastEtag)) {
+        lastEtag[0] = '\0';  // Unbrauchbar lang - lieber unbedingt fragen
+    }
+
+    String response = http.getString();
+    http.end();  // Verbindung schließen, bevor ein Download eine neue öffnet
+
+    StaticJsonDocument<1024> doc;   // Update-Antworten mit Delta und BCMP brauchen Platz
+    DeserializationError error = deserializeJson(doc, response);
+    if (error) {
+        LOGW("OTA", "Checkin-Antwort nicht lesbar: %s", error.c_str());
+        lastEtag[0] = '\0';
+        return CHECKIN_FAILED;
+    }
+
+    LOGD("OTA", "Checkin-Antwort: %s", response.c_str());
+    handleCheckinResponse(doc);
+    return CHECKIN_OK;
+}
+
+static void otaAgentTask(void* parameter) {
+    computeRunningSha();
+
+    for (;;) {
+        int32_t wait = (int32_t)(nextCheckinAt - millis());
+        if (wait > 0 && !checkinRequested) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
+            continue;  // Aufgeweckt oder Zeit um - oben neu prüfen
+        }
+        checkinRequested = false;
+
+        if (!settings.otaEnabled || !wifiConnectEnabled) {
+            agentState = OTA_AGENT_DISABLED;
+            bootFinishStage(BOOT_STAGE_OTA, true);
+            scheduleNext(OTA_CHECKIN_INTERVAL_MS);
+            continue;
+        }
+
+        if (!wifiManagerConnected()) {
+            agentState = OTA_AGENT_WAIT_NETWORK;
+            if (bootStageDone(BOOT_STAGE_CONNECT)) {
+                bootFinishStage(BOOT_STAGE_OTA, false);  // WLAN nicht erreichbar
+            }
+            scheduleNext(OTA_NETWORK_POLL_MS);
+            continue;
+        }
+
+        agentState = OTA_AGENT_CHECKIN;
+        OtaHealthResult healthResult;
+        bool hasHealthResult = otaHealthResult(healthResult);
+        CheckinResult result = performCheckin(hasHealthResult ? &healthResult : NULL);
+
+        if (result == CHECKIN_FAILED) {
+            if (consecutiveFailures < 30) {
+                consecutiveFailures++;
+            }
+            uint8_t shift = consecutiveFailures - 1 < 7 ? consecutiveFailures - 1 : 7;
+            uint32_t backoff = (uint32_t)OTA_BACKOFF_MIN_MS << shift;
+            if (backoff > OTA_BACKOFF_MAX_MS) {
+                backoff = OTA_BACKOFF_MAX_MS;
+            }
+            backoff = withJitter(backoff, 25);
+            LOGI("OTA", "Nächster Checkin in %lu ms (Fehlversuch %d)",
+                 (unsigned long)backoff, consecutiveFailures);
+            scheduleNext(backoff);
+        } else {
+            consecutiveFailures = 0;
+            checkinCount++;
+            if (hasHealthResult) {
+                otaHealthResultReported(healthResult);
+            }
+            if (result == CHECKIN_NOT_MODIFIED) {
+                notModifiedCount++;
+            }
+            lastCheckinMs = millis();
+            scheduleNext(withJitter(OTA_CHECKIN_INTERVAL_MS, 10));
+        }
+
+        bootFinishStage(BOOT_STAGE_OTA, result != CHECKIN_FAILED);
+        agentState = OTA_AGENT_IDLE;
+    }
+}
+
+void initOtaAgent() {
+    if (otaTaskHandle != NULL) {
+        return;
+    }
+    scheduleNext(0);
+    if (xTaskCreate(otaAgentTask, "OtaAgent", OTA_AGENT_STACK, NULL, 1, &otaTaskHandle) != pdPASS) {
+        LOGE("OTA", "OTA-Task konnte nicht erstellt werden");
+        otaTaskHandle = NULL;
+        bootFinishStage(BOOT_STAGE_OTA, false);
+    }
+}
+
+void otaAgentRequestCheckin() {
+    checkinRequested = true;
+    if (otaTaskHandle != NULL) {
+        xTaskNotifyGive(otaTaskHandle);
+    }
+}
+
+OtaAgentStatus getOtaAgentStatus() {
+    OtaAgentStatus status = {};
+    status.state = agentState;
+    status.checkins = checkinCount;
+    status.notModified = notModifiedCount;
+    status.consecutiveFailures = consecutiveFailures;
+    status.lastHttpCode = lastHttpCode;
+    status.lastCheckinMs = lastCheckinMs;
+    status.downloadBytes = downloadBytes;
+    status.downloadTotal = downloadTotal;
+    status.downloadKbps = downloadKbps;
+    status.downloadResumes = downloadResumes;
+    int32_t remaining = (int32_t)(nextCheckinAt - millis());
+    status.nextCheckinInMs = remaining > 0 ? remaining : 0;
+    return status;
+}
@@ -0,0 +1,61 @@
+#ifndef OTA_AGENT_H
+#define OTA_AGENT_H
+
+#include <Arduino.h>
+
+// OTA-Checkin und Firmware-Download in einem eigenen Task.
+// loop() (Tasten, Akku-Überwachung) wartet nie mehr auf den Server:
+//
+// - Checkin alle OTA_CHECKIN_INTERVAL_MS, mit Zufallsanteil gegen
+//   gleichzeitige Checkins vieler Badges
+// - Verbindungs- und Lese-Timeouts für jede Anfrage
+// - Fehlschläge werden mit exponentiellem Backoff wiederholt
+// - Bedingte Checkins: das ETag der letzten reinen Status-Antwort geht als
+//   If-None-Match mit, ohne Änderung antwortet der Server mit 304 ohne Body
+// - Download und Flash-Schreiben laufen parallel (zwei Puffer), ein Abbruch
+//   wird per HTTP-Range fortgesetzt, die SHA-256 wird beim Schreiben mitgerechnet
+// - Hat der Server ein Delta zur laufenden Firmware, wird nur das geladen
+//   und gegen die laufende Partition angewendet (OtaDecoder), sonst das
+//   komprimierte Image, das beim Download entpackt wird
+// - Bestätigung bzw. Rollback der letzten neuen Firmware (OtaHealth) geht
+//   beim nächsten Checkin als ota_result an den Server
+
+#define OTA_CHECKIN_INTERVAL_MS  60000
+#define OTA_CONNECT_TIMEOUT_MS   4000
+#define OTA_READ_TIMEOUT_MS      5000
+#define OTA_DOWNLOAD_TIMEOUT_MS  30000
+#define OTA_BACKOFF_MIN_MS       5000
+#define OTA_BACKOFF_MAX_MS       600000   // 10 Minuten
+
+enum OtaAgentState {
+    OTA_AGENT_IDLE = 0,      // Warten auf den nächsten Checkin
+    OTA_AGENT_WAIT_NETWORK,  // OTA aktiv, aber keine WLAN-Verbindung
+    OTA_AGENT_CHECKIN,
+    OTA_AGENT_DOWNLOAD,
+    OTA_AGENT_REBOOT,
+    OTA_AGENT_DISABLED       // OTA oder Client-Modus abgeschaltet
+};
+
+struct OtaAgentStatus {
+    OtaAgentState state;
+    uint32_t checkins;            // Abgeschlossene Checkins (200 oder 304)
+    uint32_t notModified;         // Davon 304
+    uint8_t consecutiveFailures;
+    int lastHttpCode;             // Letzter HTTP-Code bzw. HTTPClient-Fehler (<0)
+    uint32_t lastCheckinMs;       // millis() des letzten Checkins, 0 = noch keiner
+    uint32_t nextCheckinInMs;
+    uint32_t downloadBytes;       // Letzter bzw. laufender Download
+    uint32_t downloadTotal;
+    uint16_t downloadKbps;        // Mittlerer Durchsatz seit Download-Start
+    uint8_t downloadResumes;      // Per Range fortgesetzte Abbrüche
+};
+
+// Task starten (nach Einstellungen und WiFiManager)
+void initOtaAgent();
+
+// Nächsten Checkin sofort ausführen (Web-UI, Netzwerkwechsel)
+void otaAgentRequestCheckin();
+
+OtaAgentStatus getOtaAgentStatus();
+
+#endif // OTA_AGENT_H
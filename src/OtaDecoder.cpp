@@ -0,0 +1,333 @@
+#include "OtaDecoder.h"
+#include "Log.h"
+#include <rom/miniz.h>
+
+#define MAGIC_SIZE 4
+#define DELTA_HEADER_SIZE 16
+#define DELTA_VERSION 1
+#define DELTA_WINDOW_BITS 15
+#define COMPRESSED_HEADER_SIZE 44
+#define COMPRESSED_VERSION 1
+#define MAX_HEADER_SIZE COMPRESSED_HEADER_SIZE
+#define OTA_DECODER_SCRATCH 1024      // Lesepuffer für die Basis-Partition
+
+enum DeltaOp {
+    DELTA_OP_END = 0x00,
+    DELTA_OP_COPY = 0x01,
+    DELTA_OP_ADD = 0x02,
+    DELTA_OP_DIFF = 0x03
+};
+
+enum DecoderState {
+    DECODER_HEADER = 0,     // Kopf sammeln (unkomprimiert)
+    DECODER_IMAGE,          // BCMP: entpackte Bytes sind das Image
+    DECODER_OPCODE,
+    DECODER_ARGS,           // offset/len der Operation sammeln
+    DECODER_ADD_DATA,
+    DECODER_DIFF_DATA,
+    DECODER_DONE,
+    DECODER_FAILED
+};
+
+struct OtaDecoder {
+    const esp_partition_t* base;
+    size_t baseSize;
+    size_t targetSize;
+    size_t produced;
+    OtaDecoderOutput output;
+    void* context;
+
+    DecoderState state;
+    uint8_t header[MAX_HEADER_SIZE];
+    uint8_t headerLength;
+    uint8_t headerNeeded;   // Erst die Kennung, dann der Kopf des Formats
+    bool hasImageSha;
+    uint8_t op;
+    uint8_t args[8];
+    uint8_t argLength;
+    uint8_t argsNeeded;
+    uint32_t offset;        // Leseposition in der Basis (COPY/DIFF)
+    uint32_t remaining;     // Restlänge von ADD/DIFF
+
+    tinfl_decompressor inflator;
+    bool inflateDone;
+    size_t dictSize;
+    size_t dictOffset;
+    uint8_t* dict;          // Ausgabefenster des Entpackers, Größe laut Format
+    uint8_t scratch[OTA_DECODER_SCRATCH];
+};
+
+static uint32_t readLe32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool fail(OtaDecoder* d, const char* reason) {
+    LOGE("OTA", "Update-Daten ungültig: %s (bei %u von %u bytes)",
+         reason, (unsigned)d->produced, (unsigned)d->targetSize);
+    d->state = DECODER_FAILED;
+    return false;
+}
+
+static bool emit(OtaDecoder* d, const uint8_t* data, size_t length) {
+    if (length > d->targetSize - d->produced) {
+        return fail(d, "Image länger als angekündigt");
+    }
+    if (!d->output(d->context, data, length)) {
+        d->state = DECODER_FAILED;
+        return false;
+    }
+    d->produced += length;
+    return true;
+}
+
+// length Bytes der Basis ab d->offset ausgeben, bei DIFF plus diff (mod 256)
+static bool emitFromBase(OtaDecoder* d, const uint8_t* diff, size_t length) {
+    while (length > 0) {
+        size_t n = min(length, sizeof(d->scratch));
+        if (esp_partition_read(d->base, d->offset, d->scratch, n) != ESP_OK) {
+            return fail(d, "Basis-Partition nicht lesbar");
+        }
+        if (diff != NULL) {
+            for (size_t i = 0; i < n; i++) {
+                d->scratch[i] += diff[i];
+            }
+            diff += n;
+        }
+        if (!emit(d, d->scratch, n)) {
+            return false;
+        }
+        d->offset += n;
+        length -= n;
+    }
+    return true;
+}
+
+static bool startOperation(OtaDecoder* d) {
+    uint32_t length = readLe32(d->op == DELTA_OP_ADD ? d->args : d->args + 4);
+    if (d->op != DELTA_OP_ADD) {
+        d->offset = readLe32(d->args);
+        if (d->offset > d->baseSize || length > d->baseSize - d->offset) {
+            return fail(d, "Bereich außerhalb der Basis");
+        }
+    }
+    if (length > d->targetSize - d->produced) {
+        return fail(d, "Image länger als angekündigt");
+    }
+
+    d->remaining = length;
+    d->state = DECODER_OPCODE;
+    if (d->op == DELTA_OP_COPY) {
+        return emitFromBase(d, NULL, length);
+    }
+    if (length > 0) {
+        d->state = d->op == DELTA_OP_ADD ? DECODER_ADD_DATA : DECODER_DIFF_DATA;
+    }
+    return true;
+}
+
+// Entpackte Bytes: Operationen auswerten und das Image ausgeben
+static bool applyOperations(OtaDecoder* d, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        switch (d->state) {
+            case DECODER_OPCODE:
+                d->op = *data++;
+                length--;
+                d->argLength = 0;
+                if (d->op == DELTA_OP_END) {
+                    d->state = DECODER_DONE;
+                } else if (d->op == DELTA_OP_COPY || d->op == DELTA_OP_DIFF) {
+                    d->argsNeeded = 8;
+                    d->state = DECODER_ARGS;
+                } else if (d->op == DELTA_OP_ADD) {
+                    d->argsNeeded = 4;
+                    d->state = DECODER_ARGS;
+                } else {
+                    return fail(d, "Unbekannte Operation");
+                }
+                break;
+
+            case DECODER_ARGS: {
+                size_t n = min((size_t)(d->argsNeeded - d->argLength), length);
+                memcpy(d->args + d->argLength, data, n);
+                d->argLength += n;
+                data += n;
+                length -= n;
+                if (d->argLength == d->argsNeeded && !startOperation(d)) {
+                    return false;
+                }
+                break;
+            }
+
+            case DECODER_ADD_DATA:
+            case DECODER_DIFF_DATA: {
+                size_t n = min((size_t)d->remaining, length);
+                bool ok = d->state == DECODER_ADD_DATA ? emit(d, data, n) : emitFromBase(d, data, n);
+                if (!ok) {
+                    return false;
+                }
+                data += n;
+                length -= n;
+                d->remaining -= n;
+                if (d->remaining == 0) {
+                    d->state = DECODER_OPCODE;
+                }
+                break;
+            }
+
+            case DECODER_DONE:
+                return fail(d, "Daten nach der Ende-Operation");
+
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+static bool inflateInput(OtaDecoder* d, const uint8_t* data, size_t length) {
+    while (!d->inflateDone) {
+        size_t inBytes = length;
+        size_t outBytes = d->dictSize - d->dictOffset;
+        tinfl_status status = tinfl_decompress(&d->inflator, data, &inBytes, d->dict,
+                                               d->dict + d->dictOffset, &outBytes,
+                                               TINFL_FLAG_HAS_MORE_INPUT);
+        data += inBytes;
+        length -= inBytes;
+
+        if (outBytes > 0) {
+            const uint8_t* out = d->dict + d->dictOffset;
+            bool ok = d->state == DECODER_IMAGE ? emit(d, out, outBytes) : applyOperations(d, out, outBytes);
+            if (!ok) {
+                return false;
+            }
+        }
+        d->dictOffset = (d->dictOffset + outBytes) & (d->dictSize - 1);
+
+        if (status < TINFL_STATUS_DONE) {
+            return fail(d, "Entpacken fehlgeschlagen");
+        }
+        if (status == TINFL_STATUS_DONE) {
+            d->inflateDone = true;
+        } else if (status == TINFL_STATUS_NEEDS_MORE_INPUT && length == 0) {
+            return true;
+        }
+    }
+    return length == 0 || fail(d, "Daten nach dem komprimierten Strom");
+}
+
+static bool parseDeltaHeader(OtaDecoder* d) {
+    if (d->header[4] != DELTA_VERSION) {
+        return fail(d, "Unbekannte Delta-Version");
+    }
+    if (d->base == NULL) {
+        return fail(d, "Delta ohne Basis-Partition");
+    }
+    d->baseSize = readLe32(d->header + 8);
+    if (d->baseSize > d->base->size) {
+        return fail(d, "Basis größer als die laufende Partition");
+    }
+    if (readLe32(d->header + 12) != d->targetSize) {
+        return fail(d, "Zielgröße passt nicht zum Checkin");
+    }
+    d->dictSize = 1 << DELTA_WINDOW_BITS;
+    d->state = DECODER_OPCODE;
+    return true;
+}
+
+static bool parseCompressedHeader(OtaDecoder* d) {
+    uint8_t windowBits = d->header[5];
+    if (d->header[4] != COMPRESSED_VERSION) {
+        return fail(d, "Unbekannte BCMP-Version");
+    }
+    if (windowBits < 9 || windowBits > 15) {
+        return fail(d, "Ungültiges Fenster");
+    }
+    if (readLe32(d->header + 8) != d->targetSize) {
+        return fail(d, "Image-Größe passt nicht zum Checkin");
+    }
+    d->hasImageSha = true;   // Bytes 12..43
+    d->dictSize = 1 << windowBits;
+    d->state = DECODER_IMAGE;
+    return true;
+}
+
+static bool parseHeader(OtaDecoder* d) {
+    bool ok;
+    if (memcmp(d->header, "BDLT", MAGIC_SIZE) == 0) {
+        ok = parseDeltaHeader(d);
+    } else if (memcmp(d->header, "BCMP", MAGIC_SIZE) == 0) {
+        ok = parseCompressedHeader(d);
+    } else {
+        return fail(d, "Unbekanntes Format");
+    }
+    if (!ok) {
+        return false;
+    }
+
+    d->dict = (uint8_t*)malloc(d->dictSize);
+    if (d->dict == NULL) {
+        return fail(d, "Kein Speicher für das Entpack-Fenster");
+    }
+    tinfl_init(&d->inflator);
+    return true;
+}
+
+OtaDecoder* otaDecoderCreate(const esp_partition_t* base, size_t targetSize,
+                             OtaDecoderOutput output, void* context) {
+    OtaDecoder* d = (OtaDecoder*)calloc(1, sizeof(OtaDecoder));
+    if (d == NULL) {
+        return NULL;
+    }
+
+    d->base = base;
+    d->targetSize = targetSize;
+    d->output = output;
+    d->context = context;
+    d->state = DECODER_HEADER;
+    d->headerNeeded = MAGIC_SIZE;
+    return d;
+}
+
+void otaDecoderDestroy(OtaDecoder* decoder) {
+    if (decoder != NULL) {
+        free(decoder->dict);
+        free(decoder);
+    }
+}
+
+bool otaDecoderFeed(OtaDecoder* decoder, const uint8_t* data, size_t length) {
+    if (decoder->state == DECODER_FAILED) {
+        return false;
+    }
+
+    while (decoder->state == DECODER_HEADER) {
+        size_t n = min((size_t)(decoder->headerNeeded - decoder->headerLength), length);
+        memcpy(decoder->header + decoder->headerLength, data, n);
+        decoder->headerLength += n;
+        data += n;
+        length -= n;
+        if (decoder->headerLength < decoder->headerNeeded) {
+            return true;
+        }
+        if (decoder->headerNeeded == MAGIC_SIZE) {
+            // Kennung da - jetzt weiß man, wie lang der Kopf ist
+            bool compressed = memcmp(decoder->header, "BCMP", MAGIC_SIZE) == 0;
+            decoder->headerNeeded = compressed ? COMPRESSED_HEADER_SIZE : DELTA_HEADER_SIZE;
+            continue;
+        }
+        if (!parseHeader(decoder)) {
+            return false;
+        }
+    }
+
+    return length == 0 || inflateInput(decoder, data, length);
+}
+
+bool otaDecoderFinished(const OtaDecoder* decoder) {
+    bool streamDone = decoder->state == DECODER_DONE || decoder->state == DECODER_IMAGE;
+    return streamDone && decoder->inflateDone && decoder->produced == decoder->targetSize;
+}
+
+const uint8_t* otaDecoderImageSha(const OtaDecoder* decoder) {
+    return decoder->hasImageSha ? decoder->header + 12 : NULL;
+}
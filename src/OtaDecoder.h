@@ -0,0 +1,38 @@
+#ifndef OTA_DECODER_H
+#define OTA_DECODER_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+// Macht aus einem Update-Download das eigentliche Firmware-Image, Stück für
+// Stück während des Downloads (Format siehe ota_delta.py):
+//
+// - "BDLT": Delta gegen die laufende Firmware. Ein raw-deflate-Strom mit
+//   COPY/ADD/DIFF-Operationen; COPY und DIFF lesen aus der Basis-Partition
+// - "BCMP": komprimiertes volles Image, Größe und SHA-256 stehen im Kopf
+// - Entpackt wird mit dem tinfl aus dem ROM, das Fenster (Delta 32 KB,
+//   BCMP laut Kopf, vom Server 4 KB) liegt im Heap
+//
+// Die Ausgabe geht an eine Callback-Funktion; liefert sie false, bricht der
+// Decoder ab. Der Zustand bleibt zwischen den Aufrufen erhalten - ein per
+// HTTP-Range fortgesetzter Download füttert einfach weiter.
+
+typedef bool (*OtaDecoderOutput)(void* context, const uint8_t* data, size_t length);
+
+struct OtaDecoder;
+
+// base: laufende Partition, nur für Deltas nötig. NULL, wenn der Speicher nicht reicht
+OtaDecoder* otaDecoderCreate(const esp_partition_t* base, size_t targetSize,
+                             OtaDecoderOutput output, void* context);
+void otaDecoderDestroy(OtaDecoder* decoder);
+
+// Nächstes Stück des Downloads verarbeiten; false = ungültig, abbrechen
+bool otaDecoderFeed(OtaDecoder* decoder, const uint8_t* data, size_t length);
+
+// Strom vollständig (beim Delta die Ende-Operation) und genau targetSize Bytes ausgegeben
+bool otaDecoderFinished(const OtaDecoder* decoder);
+
+// SHA-256 (32 Bytes) aus dem BCMP-Kopf, sonst NULL
+const uint8_t* otaDecoderImageSha(const OtaDecoder* decoder);
+
+#endif // OTA_DECODER_H
@@ -0,0 +1,309 @@
+#include "OtaHealth.h"
+#include "OtaAgent.h"
+#include "Log.h"
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <esp_image_format.h>
+#include <mbedtls/sha256.h>
+
+#define OTA_HEALTH_STACK 4096
+#define OTA_HEALTH_POLL_MS 1000
+#define OTA_HEALTH_CHECK_COUNT 3
+#define OTA_HEALTH_SHA_CHUNK 4096
+#define OTA_HEALTH_LOG_DRAIN_MS 200   // Log-Task vor dem Rollback-Neustart zu Wort kommen lassen
+
+// NVS - überlebt den Wechsel zwischen den Firmwares
+#define OTA_HEALTH_NAMESPACE "ota"
+#define OTA_HEALTH_KEY_FAIL_SHA "fail_sha"        // Verworfenes Image ...
+#define OTA_HEALTH_KEY_FAIL_REASON "fail_reason"  // ... und warum
+#define OTA_HEALTH_KEY_REPORTED "rb_sha"          // Zuletzt an den Server gemeldeter Rollback
+
+// Arduino-Core: Liefert dieser Hook false, bestätigt initArduino() jedes neue
+// Image sofort beim Start. Das übernimmt hier der Health-Task.
+extern "C" bool verifyRollbackLater() {
+    return true;
+}
+
+static const char* checkNames[OTA_HEALTH_CHECK_COUNT] = { "leds", "web", "charger" };
+
+static volatile bool pendingVerify = false;
+static volatile bool confirmedUnreported = false;
+
+// millis() der letzten Meldung je Teilsystem. Geht ein Bit in reportedChecks
+// durch gleichzeitige Meldungen verloren, setzt es die nächste wieder.
+static volatile uint32_t lastReport[OTA_HEALTH_CHECK_COUNT] = {};
+static volatile uint8_t reportedChecks = 0;
+
+// Vom Health-Task beim Start ermittelt, vom OtaAgent gemeldet
+static OtaHealthResult rollbackResult;
+static volatile bool rollbackReady = false;
+
+bool otaImageSha256(const esp_partition_t* partition, char* hex) {
+    esp_partition_pos_t position = { partition->address, partition->size };
+    esp_image_metadata_t metadata;
+    if (esp_image_get_metadata(&position, &metadata) != ESP_OK) {
+        return false;
+    }
+
+    uint8_t* buffer = (uint8_t*)malloc(OTA_HEALTH_SHA_CHUNK);
+    if (buffer == NULL) {
+        return false;
+    }
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts_ret(&sha, 0);
+    bool ok = true;
+    for (uint32_t offset = 0; offset < metadata.image_len && ok; offset += OTA_HEALTH_SHA_CHUNK) {
+        size_t n = min((uint32_t)OTA_HEALTH_SHA_CHUNK, metadata.image_len - offset);
+        ok = esp_partition_read(partition, offset, buffer, n) == ESP_OK;
+        mbedtls_sha256_update_ret(&sha, buffer, n);
+    }
+    uint8_t digest[32];
+    mbedtls_sha256_finish_ret(&sha, digest);
+    mbedtls_sha256_free(&sha);
+    free(buffer);
+
+    if (ok) {
+        for (int i = 0; i < 32; i++) {
+            sprintf(hex + i * 2, "%02x", digest[i]);
+        }
+    }
+    return ok;
+}
+
+// Teilsysteme als "leds,web"
+static void describeChecks(uint8_t checks, char* out, size_t size) {
+    out[0] = '\0';
+    for (int i = 0; i < OTA_HEALTH_CHECK_COUNT; i++) {
+        if (checks & (1 << i)) {
+            if (out[0] != '\0') {
+                strlcat(out, ",", size);
+            }
+            strlcat(out, checkNames[i], size);
+        }
+    }
+}
+
+// Die Rücksetzursache gehört noch zum verworfenen Image - der Bootloader
+// startet die vorige Firmware ohne eigenen Reset
+static const char* resetReasonName(esp_reset_reason_t reason) {
+    switch (reason) {
+        case ESP_RST_PANIC:
+            return "crash";
+        case ESP_RST_INT_WDT:
+        case ESP_RST_TASK_WDT:
+        case ESP_RST_WDT:
+            return "watchdog";
+        case ESP_RST_BROWNOUT:
+            return "brownout";
+        case ESP_RST_POWERON:
+            return "power_loss";
+        case ESP_RST_SW:
+            return "restart";
+        default:
+            return "boot_failed";
+    }
+}
+
+// Hat der Bootloader (Absturz) oder der Health-Task (Zeitlimit) ein Image
+// verworfen, das der Server noch nicht kennt?
+static void detectRollback() {
+    const esp_partition_t* invalid = esp_ota_get_last_invalid_partition();
+    if (invalid == NULL) {
+        return;
+    }
+
+    OtaHealthResult result = {};
+    result.status = "rolled_back";
+    if (!otaImageSha256(invalid, result.sha256)) {
+        LOGW("OTA", "Verworfenes Image auf %s nicht lesbar - kein Rollback-Bericht", invalid->label);
+        return;
+    }
+
+    Preferences prefs;
+    if (!prefs.begin(OTA_HEALTH_NAMESPACE, false)) {
+        return;
+    }
+    if (prefs.getString(OTA_HEALTH_KEY_REPORTED, "") == result.sha256) {
+        prefs.end();
+        return;
+    }
+    String reason;
+    if (prefs.getString(OTA_HEALTH_KEY_FAIL_SHA, "") == result.sha256) {
+        reason = prefs.getString(OTA_HEALTH_KEY_FAIL_REASON, "");
+    }
+    if (reason.length() == 0) {
+        // Erster Start nach dem Rollback: Ursache festhalten, bis sie gemeldet ist
+        reason = resetReasonName(esp_reset_reason());
+        prefs.putString(OTA_HEALTH_KEY_FAIL_SHA, result.sha256);
+        prefs.putString(OTA_HEALTH_KEY_FAIL_REASON, reason);
+    }
+    prefs.end();
+
+    strlcpy(result.reason, reason.c_str(), sizeof(result.reason));
+    LOGW("OTA", "Firmware %.16s auf %s wurde verworfen (%s) - vorige Firmware läuft",
+         result.sha256, invalid->label, result.reason);
+    rollbackResult = result;
+    rollbackReady = true;
+}
+
+static uint8_t missingChecks(uint32_t now) {
+    uint8_t missing = 0;
+    for (int i = 0; i < OTA_HEALTH_CHECK_COUNT; i++) {
+        uint8_t bit = 1 << i;
+        if (!(reportedChecks & bit) || (int32_t)(now - lastReport[i]) > OTA_HEALTH_STALE_MS) {
+            missing |= bit;
+        }
+    }
+    return missing;
+}
+
+static void confirmImage(uint32_t elapsedMs) {
+    esp_err_t err = esp_ota_mark_app_valid_cancel_rollback();
+    if (err != ESP_OK) {
+        LOGE("OTA", "Firmware konnte nicht bestätigt werden: %s", esp_err_to_name(err));
+        return;
+    }
+    pendingVerify = false;
+    confirmedUnreported = true;
+    LOGI("OTA", "Neue Firmware nach %lu s bestätigt", (unsigned long)(elapsedMs / 1000));
+    otaAgentRequestCheckin();
+}
+
+static void rejectImage(uint8_t missing) {
+    char names[24];
+    describeChecks(missing, names, sizeof(names));
+    LOGE("OTA", "Neue Firmware nicht gesund (%s) nach %d s - zurück zur vorigen",
+         names, OTA_HEALTH_DEADLINE_MS / 1000);
+
+    // Grund für die vorige Firmware hinterlegen, sie meldet ihn beim Checkin
+    char sha[65];
+    if (otaImageSha256(esp_ota_get_running_partition(), sha)) {
+        Preferences prefs;
+        if (prefs.begin(OTA_HEALTH_NAMESPACE, false)) {
+            prefs.putString(OTA_HEALTH_KEY_FAIL_SHA, sha);
+            prefs.putString(OTA_HEALTH_KEY_FAIL_REASON, String("health:") + names);
+            prefs.end();
+        }
+    }
+    vTaskDelay(pdMS_TO_TICKS(OTA_HEALTH_LOG_DRAIN_MS));
+
+    esp_err_t err = esp_ota_mark_app_invalid_rollback_and_reboot();
+
+    // Nur ohne gültige vorige Firmware kommt man hierher - dann lieber
+    // bestätigen, damit ein korrigiertes Update installiert werden kann
+    LOGE("OTA", "Rollback nicht möglich: %s - Firmware wird trotzdem bestätigt", esp_err_to_name(err));
+    confirmImage(OTA_HEALTH_DEADLINE_MS);
+}
+
+// Bestätigt, sobald alle Teilsysteme OTA_HEALTH_CONFIRM_MS am Stück gesund
+// sind; fehlt nach OTA_HEALTH_DEADLINE_MS noch eins, wird verworfen
+static void superviseNewImage() {
+    uint32_t start = millis();
+    uint32_t healthySince = 0;
+    bool healthy = false;
+    uint8_t lastMissing = 0;
+
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(OTA_HEALTH_POLL_MS));
+        uint32_t now = millis();
+        uint8_t missing = missingChecks(now);
+
+        if (missing == 0) {
+            if (!healthy) {
+                healthy = true;
+                healthySince = now;
+                LOGI("OTA", "Alle Teilsysteme gesund - Bestätigung in %d s", OTA_HEALTH_CONFIRM_MS / 1000);
+            }
+            if (now - healthySince >= OTA_HEALTH_CONFIRM_MS) {
+                confirmImage(now - start);
+                return;
+            }
+        } else {
+            if (healthy || missing != lastMissing) {
+                char names[24];
+                describeChecks(missing, names, sizeof(names));
+                LOGW("OTA", "Neue Firmware: warte auf %s", names);
+            }
+            healthy = false;
+            if (now - start >= OTA_HEALTH_DEADLINE_MS) {
+                rejectImage(missing);
+                return;
+            }
+        }
+        lastMissing = missing;
+    }
+}
+
+static void otaHealthTask(void* parameter) {
+    detectRollback();
+    if (pendingVerify) {
+        superviseNewImage();
+    }
+    vTaskDelete(NULL);
+}
+
+void initOtaHealth() {
+#ifndef CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+    LOGW("OTA", "Bootloader ohne Rollback-Unterstützung - neue Firmware wird nicht geprüft");
+#endif
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    esp_ota_img_states_t state;
+    if (esp_ota_get_state_partition(running, &state) == ESP_OK && state == ESP_OTA_IMG_PENDING_VERIFY) {
+        pendingVerify = true;
+        LOGI("OTA", "Neue Firmware auf %s - wird nach %d s gesundem Betrieb bestätigt",
+             running->label, OTA_HEALTH_CONFIRM_MS / 1000);
+    }
+
+    if (xTaskCreate(otaHealthTask, "OtaHealth", OTA_HEALTH_STACK, NULL, 1, NULL) != pdPASS) {
+        LOGE("OTA", "Health-Task konnte nicht erstellt werden");
+        if (pendingVerify) {
+            // Ohne Überwachung würde jeder spätere Neustart zurückrollen
+            confirmImage(0);
+        }
+    }
+}
+
+void otaHealthReport(uint8_t checks) {
+    if (!pendingVerify) {
+        return;
+    }
+    uint32_t now = millis();
+    for (int i = 0; i < OTA_HEALTH_CHECK_COUNT; i++) {
+        if (checks & (1 << i)) {
+            lastReport[i] = now;
+        }
+    }
+    reportedChecks |= checks;
+}
+
+bool otaHealthPendingVerify() {
+    return pendingVerify;
+}
+
+bool otaHealthResult(OtaHealthResult& result) {
+    // Ein älterer Rollback zuerst - den Zustand der laufenden Firmware gibt es danach
+    if (rollbackReady) {
+        result = rollbackResult;
+        return true;
+    }
+    if (pendingVerify || confirmedUnreported) {
+        result = OtaHealthResult();
+        result.status = pendingVerify ? "pending" : "confirmed";
+        return true;
+    }
+    return false;
+}
+
+void otaHealthResultReported(const OtaHealthResult& result) {
+    if (strcmp(result.status, "rolled_back") == 0) {
+        Preferences prefs;
+        if (prefs.begin(OTA_HEALTH_NAMESPACE, false)) {
+            prefs.putString(OTA_HEALTH_KEY_REPORTED, result.sha256);
+            prefs.end();
+        }
+        rollbackReady = false;
+    } else if (strcmp(result.status, "confirmed") == 0) {
+        confirmedUnreported = false;
+    }
+}
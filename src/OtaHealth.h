@@ -0,0 +1,54 @@
+#ifndef OTA_HEALTH_H
+#define OTA_HEALTH_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+// Rollback-Schutz für OTA-Updates.
+// Ein frisch installiertes Image startet im Zustand "pending verify". Es wird
+// erst gültig, wenn LEDs, Webserver und Ladegerät-Überwachung
+// OTA_HEALTH_CONFIRM_MS am Stück gesund gemeldet haben. Schafft das Image das
+// nicht bis OTA_HEALTH_DEADLINE_MS, wird es verworfen und die vorige Firmware
+// gestartet. Stürzt es vorher ab, verwirft der Bootloader es beim nächsten
+// Start selbst.
+//
+// Das Ergebnis (bestätigt / zurückgerollt, mit Grund) meldet der OtaAgent
+// beim nächsten Checkin an den Server.
+
+#define OTA_HEALTH_CONFIRM_MS   30000
+#define OTA_HEALTH_DEADLINE_MS  120000
+#define OTA_HEALTH_STALE_MS     5000     // Ohne Meldung so lange gilt ein Teil als hängend
+
+// Teilsysteme, die sich regelmäßig melden
+#define OTA_HEALTH_LEDS     0x01   // LED-Task, jeder Durchlauf
+#define OTA_HEALTH_WEB      0x02   // Webserver-Task
+#define OTA_HEALTH_CHARGER  0x04   // Ladegerät-Überwachung in loop()
+#define OTA_HEALTH_ALL      (OTA_HEALTH_LEDS | OTA_HEALTH_WEB | OTA_HEALTH_CHARGER)
+
+// Ergebnis für den Checkin
+struct OtaHealthResult {
+    const char* status;   // "pending", "confirmed" oder "rolled_back"
+    char sha256[65];      // Zurückgerollt: SHA-256 des verworfenen Images
+    char reason[32];      // Zurückgerollt: health_timeout:..., crash, watchdog, ...
+};
+
+// Früh in setup(): Zustand des laufenden Images prüfen, Überwachung starten
+void initOtaHealth();
+
+// Teilsystem(e) melden sich gesund (Bitmaske, aus beliebigem Task)
+void otaHealthReport(uint8_t checks);
+
+// Läuft ein noch nicht bestätigtes Image? (Dann keine weiteren Updates)
+bool otaHealthPendingVerify();
+
+// Etwas zu melden? Füllt result
+bool otaHealthResult(OtaHealthResult& result);
+
+// Checkin mit diesem Ergebnis war erfolgreich - nicht noch einmal melden
+void otaHealthResultReported(const OtaHealthResult& result);
+
+// SHA-256 über das Image in einer App-Partition (ohne Füllmaterial),
+// als Hex-String - entspricht der .bin-Datei auf dem Server
+bool otaImageSha256(const esp_partition_t* partition, char* hex);
+
+#endif // OTA_HEALTH_H
@@ -1,5 +1,6 @@
 #include "Settings.h"
 #include "Globals.h"  // Für die neuen globalen Variablen
+#include <Preferences.h>
 
 // Externe alte Variablen
 extern uint8_t NOISE_LEVEL;
@@ -12,8 +13,90 @@ Settings settings;
 // Definition des Dateinamens für die Einstellungen
 const char* settingsFile = "/settings.json";
 
+// Größe der JSON-Dokumente für settings.json: 16 Einträge, dazu die beim
+// Lesen aus der Datei kopierten Schlüssel (~210 B) und Strings (AP-Name und
+// SSID je 32, Passwörter je 64 Zeichen, Version)
+#define SETTINGS_JSON_MEMBERS 16
+#define SETTINGS_JSON_SIZE (JSON_OBJECT_SIZE(SETTINGS_JSON_MEMBERS) + 512)
+
+// Erst nach loadSettings() speichern - sonst überschreiben Tastendrücke
+// während des Boots die Datei mit Standardwerten
+static bool settingsLoaded = false;
+
+// LED-Zustand zusätzlich im NVS: beim Boot lange vor dem SPIFFS lesbar
+#define LED_SNAPSHOT_NAMESPACE "boot"
+#define LED_SNAPSHOT_KEY "leds"
+#define LED_SNAPSHOT_VERSION 1
+
+struct __attribute__((packed)) LedSnapshot {
+    uint8_t version;
+    uint8_t mode;
+    uint8_t brightness;
+    uint8_t primaryHue;
+    uint8_t secondaryHue;
+    uint16_t animSpeed;
+};
+
+static LedSnapshot storedSnapshot = {};   // Letzter Stand im NVS (Schreiben nur bei Änderung)
+
+static void saveLedSnapshot() {
+    LedSnapshot snapshot = {};
+    snapshot.version = LED_SNAPSHOT_VERSION;
+    snapshot.mode = settings.mode;
+    snapshot.brightness = settings.brightness;
+    snapshot.primaryHue = settings.primaryHue;
+    snapshot.secondaryHue = settings.secondaryHue;
+    snapshot.animSpeed = settings.animationSpeed;
+    if (memcmp(&snapshot, &storedSnapshot, sizeof(snapshot)) == 0) {
+        return;
+    }
+
+    Preferences prefs;
+    if (!prefs.begin(LED_SNAPSHOT_NAMESPACE, false)) {
+        return;
+    }
+    if (prefs.putBytes(LED_SNAPSHOT_KEY, &snapshot, sizeof(snapshot)) == sizeof(snapshot)) {
+        storedSnapshot = snapshot;
+    }
+    prefs.end();
+}
+
+bool loadLedSnapshot() {
+    Preferences prefs;
+    if (!prefs.begin(LED_SNAPSHOT_NAMESPACE, true)) {
+        return false;  // Erster Start: Namespace existiert noch nicht
+    }
+    LedSnapshot snapshot = {};
+    size_t length = prefs.getBytes(LED_SNAPSHOT_KEY, &snapshot, sizeof(snapshot));
+    prefs.end();
+    if (length != sizeof(snapshot) || snapshot.version != LED_SNAPSHOT_VERSION) {
+        return false;
+    }
+    storedSnapshot = snapshot;
+
+    settings.mode = snapshot.mode;
+    settings.brightness = snapshot.brightness;
+    settings.primaryHue = snapshot.primaryHue;
+    settings.secondaryHue = snapshot.secondaryHue;
+    settings.animationSpeed = snapshot.animSpeed;
+
+    currentMode = snapshot.mode;
+    brightness = snapshot.brightness;
+    BRIGHTNESS = snapshot.brightness;
+    primaryHue = snapshot.primaryHue;
+    secondaryHue = snapshot.secondaryHue;
+    animSpeed = snapshot.animSpeed;
+    animationSpeed = snapshot.animSpeed;
+    return true;
+}
+
 // Implementierung der Funktionen
 bool saveSettings() {
+    if (!settingsLoaded) {
+        Serial.println("Einstellungen noch nicht geladen - Speichern übersprungen");
+        return false;
+    }
+
     File file = SPIFFS.open("/settings.json", "w");
     if (!file) {
         Serial.println("Fehler beim Öffnen der Einstellungsdatei zum Schreiben");
@@ -41,7 +124,7 @@ bool saveSettings() {
     Serial.print("Speichere WiFi AP-Name: ");
     Serial.println(settings.apName);
     
-    StaticJsonDocument<512> doc;
+    StaticJsonDocument<SETTINGS_JSON_SIZE> doc;
     doc["mode"] = settings.mode;
     doc["brightness"] = settings.brightness;
     doc["noiseLevel"] = settings.noiseLevel;
@@ -58,6 +141,9 @@ bool saveSettings() {
     // OTA-Einstellungen speichern
     doc["otaEnabled"] = settings.otaEnabled;
     doc["dynamicVersion"] = settings.dynamicVersion;
+    // Gruppensteuerung speichern
+    doc["udpControlEnabled"] = settings.udpControlEnabled;
+    doc["espNowMeshEnabled"] = settings.espNowMeshEnabled;
 
     if (serializeJson(doc, file) == 0) {
         Serial.println("Fehler beim Schreiben der Einstellungen");
@@ -66,11 +152,29 @@ bool saveSettings() {
     }
 
     file.close();
+    saveLedSnapshot();
     Serial.println("Einstellungen erfolgreich gespeichert");
     return true;
 }
 
+static bool loadSettingsFile();
+
 bool loadSettings() {
+    bool exists = SPIFFS.exists("/settings.json");
+    bool loaded = loadSettingsFile();
+    // Eine vorhandene, aber unlesbare Datei nicht mit Standardwerten
+    // überschreiben - sie enthält u.a. die WLAN-Zugangsdaten
+    settingsLoaded = loaded || !exists;
+    if (!settingsLoaded) {
+        Serial.println("Einstellungsdatei nicht lesbar - Speichern gesperrt, Datei bleibt erhalten");
+    }
+    if (loaded) {
+        saveLedSnapshot();  // Nächster Boot startet mit genau diesem Zustand
+    }
+    return loaded;
+}
+
+static bool loadSettingsFile() {
     if (!SPIFFS.exists("/settings.json")) {
         Serial.println("Keine Einstellungsdatei gefunden, verwende Standardwerte");
         return false;
@@ -82,12 +186,12 @@ bool loadSettings() {
         return false;
     }
 
-    StaticJsonDocument<512> doc;
+    StaticJsonDocument<SETTINGS_JSON_SIZE> doc;
     DeserializationError error = deserializeJson(doc, file);
     file.close();
 
     if (error) {
-        Serial.println("Fehler beim Parsen der Einstellungen");
+        Serial.printf("Fehler beim Parsen der Einstellungen: %s\n", error.c_str());
         return false;
     }
 
@@ -107,6 +211,9 @@ bool loadSettings() {
     // OTA-Einstellungen laden
     settings.otaEnabled = doc["otaEnabled"] | true;
     settings.dynamicVersion = doc["dynamicVersion"] | "";
+    // Gruppensteuerung laden
+    settings.udpControlEnabled = doc["udpControlEnabled"] | false;
+    settings.espNowMeshEnabled = doc["espNowMeshEnabled"] | false;
     
     Serial.printf("Geladene OTA-Einstellungen: aktiviert=%s, dynamicVersion='%s'\n", 
                   settings.otaEnabled ? "Ja" : "Nein", settings.dynamicVersion.c_str());
@@ -30,6 +30,9 @@ struct Settings {
     // OTA-Einstellungen
     bool otaEnabled = true;      // OTA-Updates aktiviert
     String dynamicVersion = "";  // Dynamische Version für OTA-Updates
+    // Gruppensteuerung
+    bool udpControlEnabled = false; // Binäres UDP-Steuerprotokoll (Port 4210) und Zeit-Sync (Port 4211) - ohne Authentifizierung, daher aus
+    bool espNowMeshEnabled = false; // Badge-zu-Badge-Effekte per ESP-NOW (auch ohne WLAN)
 };
 
 // Globale Einstellungsvariable
@@ -42,4 +45,8 @@ extern const char* settingsFile;
 bool saveSettings();
 bool loadSettings();
 
+// LED-Zustand (Modus, Helligkeit, Farben, Tempo) aus dem NVS übernehmen -
+// schnell genug für die ersten Millisekunden des Boots. false = kein Stand.
+bool loadLedSnapshot();
+
 #endif // SETTINGS_H 
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "SyncCore.h"
+#include <string.h>
+
+// ---------------------------------------------------------------------------
+// ClockSync
+// ---------------------------------------------------------------------------
+
+ClockSync::ClockSync()
+    : sampleCount(0), nextSample(0), lastDelayUs(0), driftValid(false),
+      hasModel(false), modelRef(0), modelOffset(0), modelDrift(0),
+      slewStart(0), slewResidual(0) {
+    memset(samples, 0, sizeof(samples));
+    memset(&driftPoint, 0, sizeof(driftPoint));
+}
+
+void ClockSync::resetSamples() {
+    sampleCount = 0;
+    nextSample = 0;
+    driftValid = false;
+}
+
+void ClockSync::addSample(int64_t t1, int64_t t2, int64_t t3, int64_t t4) {
+    Sample sample;
+    sample.local = t4;
+    sample.offset = ((t2 - t1) + (t3 - t4)) / 2;
+    sample.delay = (t4 - t1) - (t3 - t2);
+    if (sample.delay < 0) {
+        sample.delay = 0;  // Rundung/Drift bei sehr kurzen Laufzeiten
+    }
+    lastDelayUs = sample.delay;
+
+    samples[nextSample] = sample;
+    nextSample = (nextSample + 1) % SYNC_FILTER_SAMPLES;
+    if (sampleCount < SYNC_FILTER_SAMPLES) {
+        sampleCount++;
+    }
+
+    // Messung mit der kürzesten Laufzeit ist am wenigsten verfälscht
+    const Sample* best = &samples[0];
+    for (uint8_t i = 1; i < sampleCount; i++) {
+        if (samples[i].delay < best->delay) {
+            best = &samples[i];
+        }
+    }
+
+    // Drift aus zwei besten Messungen mit genug Abstand, geglättet
+    if (!driftValid) {
+        driftPoint = *best;
+        driftValid = true;
+    } else if (best->local - driftPoint.local >= SYNC_DRIFT_BASELINE_US) {
+        int64_t measured = (best->offset - driftPoint.offset) * 1000000000LL /
+                           (best->local - driftPoint.local);
+        int64_t drift = (modelDrift * 3LL + measured) / 4;
+        if (drift > SYNC_MAX_DRIFT_PPB) drift = SYNC_MAX_DRIFT_PPB;
+        if (drift < -SYNC_MAX_DRIFT_PPB) drift = -SYNC_MAX_DRIFT_PPB;
+        modelDrift = (int32_t)drift;
+        driftPoint = *best;
+    }
+
+    if (sampleCount < SYNC_MIN_SAMPLES) {
+        return;  // Zu wenig Messungen - bisheriges Modell beibehalten
+    }
+
+    applyModel(t4, best->local, best->offset);
+}
+
+void ClockSync::adopt(int64_t local, int64_t shared) {
+    applyModel(local, local, shared - local);
+}
+
+// Neues Modell übernehmen; kleine Sprünge über SYNC_SLEW_US verteilen
+void ClockSync::applyModel(int64_t now, int64_t ref, int64_t offset) {
+    int64_t previous = toShared(now);
+    int64_t target = now + offset + (now - ref) * modelDrift / 1000000000LL;
+    int64_t residual = previous - target;
+
+    modelRef = ref;
+    modelOffset = offset;
+
+    if (!hasModel || residual > SYNC_STEP_THRESHOLD_US || residual < -SYNC_STEP_THRESHOLD_US) {
+        slewResidual = 0;
+    } else {
+        slewResidual = residual;
+        slewStart = now;
+    }
+    hasModel = true;
+}
+
+int64_t ClockSync::toShared(int64_t local) const {
+    int64_t shared = local + modelOffset + (local - modelRef) * modelDrift / 1000000000LL;
+
+    if (slewResidual != 0) {
+        int64_t elapsed = local - slewStart;
+        if (elapsed < 0) {
+            shared += slewResidual;
+        } else if (elapsed < SYNC_SLEW_US) {
+            shared += slewResidual * (SYNC_SLEW_US - elapsed) / SYNC_SLEW_US;
+        }
+    }
+    return shared;
+}
+
+// ---------------------------------------------------------------------------
+// SyncElection
+// ---------------------------------------------------------------------------
+
+SyncElection::SyncElection()
+    : selfId(0), listenUntil(0), selfEligible(false), currentLeader(0),
+      currentLeaderAddress(0), lastUpdate(0) {
+    memset(peers, 0, sizeof(peers));
+}
+
+void SyncElection::begin(uint32_t id, int64_t now) {
+    memset(peers, 0, sizeof(peers));
+    selfId = id;
+    listenUntil = now + SYNC_LISTEN_US;
+    selfEligible = false;
+    currentLeader = 0;
+    currentLeaderAddress = 0;
+    lastUpdate = now;
+}
+
+void SyncElection::onBeacon(uint32_t id, bool eligible, uint32_t address, int64_t now) {
+    if (id == 0 || id == selfId) {
+        return;
+    }
+
+    Peer* slot = nullptr;
+    Peer* oldest = &peers[0];
+    for (int i = 0; i < SYNC_MAX_PEERS; i++) {
+        Peer& peer = peers[i];
+        if (peer.id == id) {
+            slot = &peer;
+            break;
+        }
+        if (oldest->id != 0 && (peer.id == 0 || peer.lastSeen < oldest->lastSeen)) {
+            oldest = &peer;
+        }
+    }
+    if (slot == nullptr) {
+        slot = oldest;
+        slot->id = id;
+    }
+
+    slot->address = address;
+    slot->lastSeen = now;
+    slot->eligible = eligible;
+}
+
+uint32_t SyncElection::update(int64_t now) {
+    lastUpdate = now;
+
+    bool eligiblePeer = false;
+    for (int i = 0; i < SYNC_MAX_PEERS; i++) {
+        Peer& peer = peers[i];
+        if (peer.id != 0 && now - peer.lastSeen > SYNC_PEER_TIMEOUT_US) {
+            peer.id = 0;  // Badge verschwunden
+        }
+        if (peer.id != 0 && peer.eligible) {
+            eligiblePeer = true;
+        }
+    }
+
+    // Niemand hält eine Epoche: dieses Badge begründet sie
+    if (!selfEligible && !eligiblePeer && now >= listenUntil) {
+        selfEligible = true;
+    }
+
+    uint32_t leader = selfEligible ? selfId : 0;
+    uint32_t address = 0;
+    for (int i = 0; i < SYNC_MAX_PEERS; i++) {
+        const Peer& peer = peers[i];
+        if (peer.id != 0 && peer.eligible && (leader == 0 || peer.id < leader)) {
+            leader = peer.id;
+            address = peer.address;
+        }
+    }
+
+    currentLeader = leader;
+    currentLeaderAddress = address;
+    return leader;
+}
+
+uint8_t SyncElection::peerCount() const {
+    uint8_t count = 0;
+    for (int i = 0; i < SYNC_MAX_PEERS; i++) {
+        if (peers[i].id != 0 && lastUpdate - peers[i].lastSeen <= SYNC_PEER_TIMEOUT_US) {
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,131 @@
+#ifndef SYNC_CORE_H
+#define SYNC_CORE_H
+
+#include <stdint.h>
+
+// Kern der Zeit-Synchronisation zwischen Badges - reine Logik ohne Arduino,
+// WiFi oder FreeRTOS. Alle Zeiten werden hereingereicht, daher lässt sich das
+// Verhalten auf dem Host mit simulierten Badges (Latenz, Jitter, Drift,
+// ausfallender Leader) durchspielen - test/test_sync_core:
+//
+//   pio test -e native
+//
+// Zeiten in Mikrosekunden. "Lokal" ist der freilaufende Zähler des Badges
+// (esp_timer_get_time), "gemeinsam" die Epoche der Gruppe = Uhr des Leaders.
+
+// Messfilter: von den letzten N Messungen zählt die mit der kleinsten
+// Laufzeit (wie beim NTP-Clock-Filter - Jitter verlängert nur die Laufzeit)
+#define SYNC_FILTER_SAMPLES 8
+#define SYNC_MIN_SAMPLES 3
+
+// Größere Abweichungen springen sofort, kleinere werden über SYNC_SLEW_US
+// eingeblendet, damit Animationen nicht ruckeln
+#define SYNC_STEP_THRESHOLD_US 20000
+#define SYNC_SLEW_US 2000000
+
+// Drift nur über ausreichend lange Abstände schätzen, sonst dominiert Jitter
+#define SYNC_DRIFT_BASELINE_US 30000000LL
+#define SYNC_MAX_DRIFT_PPB 500000   // 500 ppm - Quarze liegen weit darunter
+
+// Leaderwahl
+#define SYNC_MAX_PEERS 16
+#define SYNC_PEER_TIMEOUT_US 3500000LL   // ~3 verpasste Beacons
+#define SYNC_LISTEN_US 3000000LL         // so lange nach dem Start nur zuhören
+
+// Schätzt Offset und Drift der lokalen Uhr gegenüber der gemeinsamen Epoche
+class ClockSync {
+public:
+    ClockSync();
+
+    // Messungen verwerfen (z.B. bei Leaderwechsel); das Modell läuft weiter,
+    // damit die gemeinsame Zeit nicht springt
+    void resetSamples();
+
+    // Eine Anfrage/Antwort im NTP-Stil:
+    //   t1 = Anfrage gesendet (lokal), t2 = beim Leader empfangen (gemeinsam),
+    //   t3 = Antwort gesendet (gemeinsam), t4 = Antwort empfangen (lokal)
+    void addSample(int64_t t1, int64_t t2, int64_t t3, int64_t t4);
+
+    // Einweg-Hinweis ohne Laufzeitmessung (z.B. Beat-Phase aus dem ESP-NOW-Mesh):
+    // gemeinsame Zeit zum lokalen Zeitpunkt direkt übernehmen, Drift bleibt
+    void adopt(int64_t local, int64_t shared);
+
+    // Gemeinsame Zeit zum lokalen Zeitpunkt
+    int64_t toShared(int64_t local) const;
+
+    bool isSynced() const { return sampleCount >= SYNC_MIN_SAMPLES; }
+    int64_t lastDelay() const { return lastDelayUs; }
+    int32_t driftPpb() const { return modelDrift; }
+
+private:
+    struct Sample {
+        int64_t local;
+        int64_t offset;
+        int64_t delay;
+    };
+
+    void applyModel(int64_t now, int64_t ref, int64_t offset);
+
+    Sample samples[SYNC_FILTER_SAMPLES];
+    uint8_t sampleCount;
+    uint8_t nextSample;
+    int64_t lastDelayUs;
+
+    // Drift-Stützpunkt (letzte beste Messung)
+    bool driftValid;
+    Sample driftPoint;
+
+    // Modell: gemeinsam = lokal + offset + drift * (lokal - ref) + Restfehler,
+    // der Restfehler klingt linear über SYNC_SLEW_US ab
+    bool hasModel;
+    int64_t modelRef;
+    int64_t modelOffset;
+    int32_t modelDrift;       // ppb
+    int64_t slewStart;
+    int64_t slewResidual;
+};
+
+// Wahl des Leaders: die kleinste ID unter allen "wählbaren" Badges. Wählbar
+// ist, wer die gemeinsame Epoche hält - also synchronisiert ist oder nach der
+// Zuhörphase niemanden gefunden hat. Ein neu hinzukommendes Badge mit kleiner
+// ID übernimmt die Führung daher erst, wenn seine Uhr schon passt.
+class SyncElection {
+public:
+    SyncElection();
+
+    void begin(uint32_t selfId, int64_t now);
+
+    // Beacon eines anderen Badges; address wird nur durchgereicht (z.B. IP)
+    void onBeacon(uint32_t id, bool eligible, uint32_t address, int64_t now);
+
+    // Nach jeder Messung melden, ob die Uhr zur Gruppe passt
+    void setClockSynced(bool synced) { if (synced) selfEligible = true; }
+
+    // Neu wählen; liefert die ID des Leaders (selfId, wenn dieses Badge führt,
+    // 0 solange in der Zuhörphase niemand Wählbares bekannt ist)
+    uint32_t update(int64_t now);
+
+    uint32_t leaderId() const { return currentLeader; }
+    uint32_t leaderAddress() const { return currentLeaderAddress; }
+    bool isLeader() const { return currentLeader != 0 && currentLeader == selfId; }
+    bool isEligible() const { return selfEligible; }
+    uint8_t peerCount() const;
+
+private:
+    struct Peer {
+        uint32_t id;
+        uint32_t address;
+        int64_t lastSeen;
+        bool eligible;
+    };
+
+    Peer peers[SYNC_MAX_PEERS];
+    uint32_t selfId;
+    int64_t listenUntil;
+    bool selfEligible;
+    uint32_t currentLeader;
+    uint32_t currentLeaderAddress;
+    int64_t lastUpdate;
+};
+
+#endif // SYNC_CORE_H
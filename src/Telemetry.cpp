@@ -0,0 +1,349 @@
+#include "Telemetry.h"
+#include "BQ25895CONFIG.h"
+#include "SPIFFS.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Ring mit fester Kapazität - Speicher wird statisch reserviert
+struct TelemetryRing {
+    TelemetrySample* slots;
+    uint16_t capacity;
+    uint16_t head;   // Nächster Schreibindex
+    uint16_t count;  // Anzahl gültiger Einträge
+};
+
+// Summen für die Mittelwertbildung der Rollups
+struct TelemetryAccumulator {
+    uint32_t vbat, vsys, vbus, ichg, iin, tsPercent;
+    uint8_t status;
+    uint8_t fault;
+    uint16_t samples;
+};
+
+static TelemetrySample slots1s[TELEMETRY_SLOTS_1S];
+static TelemetrySample slots1m[TELEMETRY_SLOTS_1M];
+static TelemetrySample slots10m[TELEMETRY_SLOTS_10M];
+
+static TelemetryRing rings[TELEMETRY_RES_COUNT] = {
+    { slots1s,  TELEMETRY_SLOTS_1S,  0, 0 },
+    { slots1m,  TELEMETRY_SLOTS_1M,  0, 0 },
+    { slots10m, TELEMETRY_SLOTS_10M, 0, 0 }
+};
+
+static TelemetryAccumulator acc1m;
+static TelemetryAccumulator acc10m;
+
+static SemaphoreHandle_t telemetryMutex = NULL;
+static uint32_t telemetrySequence = 0;
+static uint32_t clockOffset = 0;         // Offset der Telemetrie-Uhr (aus gespeichertem Verlauf)
+static unsigned long lastSampleTime = 0;
+
+// Dateiformat des gespeicherten 10-Minuten-Verlaufs
+static const uint32_t HISTORY_MAGIC = 0x31485442; // "BTH1"
+
+static void ringPush(TelemetryRing& ring, const TelemetrySample& sample) {
+    ring.slots[ring.head] = sample;
+    ring.head = (ring.head + 1) % ring.capacity;
+    if (ring.count < ring.capacity) {
+        ring.count++;
+    }
+}
+
+// Index i (0 = ältester Eintrag) auf den Slot abbilden
+static const TelemetrySample& ringAt(const TelemetryRing& ring, size_t i) {
+    size_t start = (ring.head + ring.capacity - ring.count) % ring.capacity;
+    return ring.slots[(start + i) % ring.capacity];
+}
+
+static void accumulate(TelemetryAccumulator& acc, const TelemetrySample& s) {
+    acc.vbat += s.vbat;
+    acc.vsys += s.vsys;
+    acc.vbus += s.vbus;
+    acc.ichg += s.ichg;
+    acc.iin += s.iin;
+    acc.tsPercent += s.tsPercent;
+    acc.status = s.status;   // Letzter Status gilt für das Intervall
+    acc.fault |= s.fault;    // Fehler innerhalb des Intervalls bleiben sichtbar
+    acc.samples++;
+}
+
+static TelemetrySample averageOf(const TelemetryAccumulator& acc, uint32_t timestamp) {
+    TelemetrySample s;
+    uint16_t n = acc.samples > 0 ? acc.samples : 1;
+    s.timestamp = timestamp;
+    s.vbat = acc.vbat / n;
+    s.vsys = acc.vsys / n;
+    s.vbus = acc.vbus / n;
+    s.ichg = acc.ichg / n;
+    s.iin = acc.iin / n;
+    s.tsPercent = acc.tsPercent / n;
+    s.status = acc.status;
+    s.fault = acc.fault;
+    return s;
+}
+
+static uint16_t toMilli(float value, float maxValue) {
+    if (value < 0.0f || value > maxValue) {
+        return 0;
+    }
+    return (uint16_t)(value * 1000.0f + 0.5f);
+}
+
+#if TELEMETRY_PERSIST_HISTORY
+// Nur der 10-Minuten-Ring wird gespeichert (max. 144 Schreibvorgänge pro Tag)
+static void saveTelemetryHistory() {
+    static TelemetrySample copy[TELEMETRY_SLOTS_10M]; // Nicht auf dem Loop-Stack
+    uint16_t count = 0;
+
+    if (xSemaphoreTake(telemetryMutex, pdMS_TO_TICKS(50)) != pdTRUE) {
+        return;
+    }
+    const TelemetryRing& ring = rings[TELEMETRY_RES_10M];
+    count = ring.count;
+    for (uint16_t i = 0; i < count; i++) {
+        copy[i] = ringAt(ring, i);
+    }
+    xSemaphoreGive(telemetryMutex);
+
+    File file = SPIFFS.open(TELEMETRY_HISTORY_FILE, "w");
+    if (!file) {
+        Serial.println("❌ Telemetrie-Verlauf konnte nicht gespeichert werden");
+        return;
+    }
+    uint16_t sampleSize = sizeof(TelemetrySample);
+    file.write((const uint8_t*)&HISTORY_MAGIC, sizeof(HISTORY_MAGIC));
+    file.write((const uint8_t*)&sampleSize, sizeof(sampleSize));
+    file.write((const uint8_t*)&count, sizeof(count));
+    file.write((const uint8_t*)copy, count * sizeof(TelemetrySample));
+    file.close();
+}
+
+static void loadTelemetryHistory() {
+    File file = SPIFFS.open(TELEMETRY_HISTORY_FILE, "r");
+    if (!file) {
+        return;
+    }
+
+    uint32_t magic = 0;
+    uint16_t sampleSize = 0;
+    uint16_t count = 0;
+    file.read((uint8_t*)&magic, sizeof(magic));
+    file.read((uint8_t*)&sampleSize, sizeof(sampleSize));
+    file.read((uint8_t*)&count, sizeof(count));
+
+    if (magic != HISTORY_MAGIC || sampleSize != sizeof(TelemetrySample) || count > TELEMETRY_SLOTS_10M) {
+        Serial.println("⚠️ Telemetrie-Verlauf hat ein unbekanntes Format - wird verworfen");
+        file.close();
+        SPIFFS.remove(TELEMETRY_HISTORY_FILE);
+        return;
+    }
+
+    TelemetrySample sample;
+    uint16_t loaded = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        if (file.read((uint8_t*)&sample, sizeof(sample)) != sizeof(sample)) {
+            break;
+        }
+        ringPush(rings[TELEMETRY_RES_10M], sample);
+        loaded++;
+    }
+    file.close();
+
+    // Telemetrie-Uhr hinter den letzten gespeicherten Punkt setzen,
+    // die Dauer des Neustarts selbst ist nicht bekannt
+    if (loaded > 0) {
+        const TelemetryRing& ring = rings[TELEMETRY_RES_10M];
+        clockOffset = ringAt(ring, ring.count - 1).timestamp + telemetryResolutionSeconds(TELEMETRY_RES_10M);
+    }
+
+    Serial.printf("📈 Telemetrie-Verlauf geladen: %d Einträge\n", loaded);
+}
+#endif
+
+void initTelemetry() {
+    if (telemetryMutex == NULL) {
+        telemetryMutex = xSemaphoreCreateMutex();
+    }
+    memset(&acc1m, 0, sizeof(acc1m));
+    memset(&acc10m, 0, sizeof(acc10m));
+
+#if TELEMETRY_PERSIST_HISTORY
+    loadTelemetryHistory();
+#endif
+}
+
+uint32_t telemetryNow() {
+    return clockOffset + millis() / 1000;
+}
+
+void telemetryTick() {
+    if (charger == nullptr || telemetryMutex == NULL) {
+        return;
+    }
+    if (lastSampleTime != 0 && millis() - lastSampleTime < TELEMETRY_SAMPLE_INTERVAL_MS) {
+        return;
+    }
+    lastSampleTime = millis();
+
+    // Einzige Stelle, an der die Telemetrie I2C liest
+    TelemetrySample sample;
+    try {
+        sample.timestamp = telemetryNow();
+        sample.vbat = toMilli(charger->getVBAT(), 5.0f);
+        sample.vsys = toMilli(charger->getVSYS(), 5.0f);
+        sample.vbus = toMilli(charger->getVBUS(), 20.0f);
+        sample.ichg = toMilli(charger->getICHG(), 5.0f);
+        sample.iin = toMilli(charger->getIIN(), 5.0f);
+        float ts = charger->getTSPercent();
+        sample.tsPercent = ts < 0.0f ? 0 : (uint16_t)(ts * 10.0f + 0.5f);
+        sample.status = charger->readRegister(0x0B);
+        sample.fault = charger->readRegister(0x0C);
+    } catch (...) {
+        Serial.println("❌ Fehler beim Lesen der Telemetrie");
+        return;
+    }
+
+    bool tenMinuteRollup = false;
+
+    if (xSemaphoreTake(telemetryMutex, pdMS_TO_TICKS(20)) != pdTRUE) {
+        return;
+    }
+
+    ringPush(rings[TELEMETRY_RES_1S], sample);
+    telemetrySequence++;
+
+    accumulate(acc1m, sample);
+    if (acc1m.samples >= 60) {
+        TelemetrySample minute = averageOf(acc1m, sample.timestamp);
+        ringPush(rings[TELEMETRY_RES_1M], minute);
+        memset(&acc1m, 0, sizeof(acc1m));
+
+        accumulate(acc10m, minute);
+        if (acc10m.samples >= 10) {
+            ringPush(rings[TELEMETRY_RES_10M], averageOf(acc10m, sample.timestamp));
+            memset(&acc10m, 0, sizeof(acc10m));
+            tenMinuteRollup = true;
+        }
+    }
+
+    xSemaphoreGive(telemetryMutex);
+
+#if TELEMETRY_PERSIST_HISTORY
+    if (tenMinuteRollup) {
+        saveTelemetryHistory();
+    }
+#endif
+}
+
+bool getLatestTelemetry(TelemetrySample& out) {
+    if (telemetryMutex == NULL || xSemaphoreTake(telemetryMutex, pdMS_TO_TICKS(20)) != pdTRUE) {
+        return false;
+    }
+    const TelemetryRing& ring = rings[TELEMETRY_RES_1S];
+    bool available = ring.count > 0;
+    if (available) {
+        out = ringAt(ring, ring.count - 1);
+    }
+    xSemaphoreGive(telemetryMutex);
+    return available;
+}
+
+uint32_t getTelemetrySequence() {
+    return telemetrySequence;
+}
+
+size_t getTelemetryCount(TelemetryResolution res) {
+    if (res >= TELEMETRY_RES_COUNT) {
+        return 0;
+    }
+    return rings[res].count;
+}
+
+size_t copyTelemetrySince(TelemetryResolution res, uint32_t afterTimestamp,
+                          TelemetrySample* out, size_t maxCount) {
+    if (res >= TELEMETRY_RES_COUNT || out == nullptr || maxCount == 0 || telemetryMutex == NULL) {
+        return 0;
+    }
+    if (xSemaphoreTake(telemetryMutex, pdMS_TO_TICKS(20)) != pdTRUE) {
+        return 0;
+    }
+
+    // Zeitstempel steigen im Ring - ersten neueren Punkt per Binärsuche finden
+    const TelemetryRing& ring = rings[res];
+    size_t low = 0;
+    size_t high = ring.count;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (ringAt(ring, mid).timestamp > afterTimestamp) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    size_t copied = 0;
+    for (size_t i = low; i < ring.count && copied < maxCount; i++) {
+        out[copied++] = ringAt(ring, i);
+    }
+
+    xSemaphoreGive(telemetryMutex);
+    return copied;
+}
+
+bool parseTelemetryResolution(const String& value, TelemetryResolution& res) {
+    if (value == "1s") {
+        res = TELEMETRY_RES_1S;
+    } else if (value == "1m") {
+        res = TELEMETRY_RES_1M;
+    } else if (value == "10m") {
+        res = TELEMETRY_RES_10M;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+uint32_t telemetryResolutionSeconds(TelemetryResolution res) {
+    switch (res) {
+        case TELEMETRY_RES_1M: return 60;
+        case TELEMETRY_RES_10M: return 600;
+        default: return 1;
+    }
+}
+
+int telemetryBatteryPercent(uint16_t vbatMilliVolt) {
+    // Lineare Interpolation zwischen 3.0V (0%) und 4.2V (100%)
+    if (vbatMilliVolt >= 4200) return 100;
+    if (vbatMilliVolt <= 3000) return 0;
+    return (int)((vbatMilliVolt - 3000) * 100 / 1200);
+}
+
+bool telemetryIsCharging(const TelemetrySample& sample) {
+    return sample.status != 0xFF && (sample.status & 0xE0);
+}
+
+const char* telemetryChargeStatusText(uint8_t status) {
+    if (status == 0xFF) {
+        return "Unbekannt";
+    }
+    switch ((status >> 6) & 0x03) {
+        case 0: return "Nicht ladend";
+        case 1: return "Vorladung";
+        case 2: return "Schnellladung";
+        case 3: return "Ladung beendet";
+        default: return "Unbekannt";
+    }
+}
+
+const char* telemetryTemperatureText(uint8_t status) {
+    if (status == 0xFF) {
+        return "Fehler";
+    }
+    switch (status & 0x07) {
+        case 0: return "Normal";
+        case 1: return "Zu kalt";
+        case 2: return "Kühl";
+        case 3: return "Warm";
+        case 4: return "Zu heiß";
+        default: return "Unbekannt";
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+
+// Ringpuffer für Ladegerät-Telemetrie (BQ25895)
+// Ein einziger Sampler liest die Werte 1x pro Sekunde über I2C, alle
+// Web-Anfragen bedienen sich nur noch aus dem RAM.
+
+// Auflösungen der Rollups
+enum TelemetryResolution {
+    TELEMETRY_RES_1S = 0,   // Rohwerte, 1 Sekunde
+    TELEMETRY_RES_1M,       // Mittelwerte über 1 Minute
+    TELEMETRY_RES_10M,      // Mittelwerte über 10 Minuten
+    TELEMETRY_RES_COUNT
+};
+
+// Kapazitäten der einzelnen Ringe
+#define TELEMETRY_SLOTS_1S   300  // 5 Minuten
+#define TELEMETRY_SLOTS_1M   240  // 4 Stunden
+#define TELEMETRY_SLOTS_10M  144  // 24 Stunden
+
+#define TELEMETRY_SAMPLE_INTERVAL_MS 1000
+
+// 10-Minuten-Verlauf zusätzlich ins SPIFFS schreiben (übersteht Neustarts)
+#define TELEMETRY_PERSIST_HISTORY 1
+#define TELEMETRY_HISTORY_FILE "/telemetry.bin"
+
+// Ein Messpunkt - kompakt, ohne Fließkommazahlen
+struct TelemetrySample {
+    uint32_t timestamp;   // Telemetrie-Uhr in Sekunden
+    uint16_t vbat;        // Akkuspannung in mV
+    uint16_t vsys;        // Systemspannung in mV
+    uint16_t vbus;        // USB-Spannung in mV
+    uint16_t ichg;        // Ladestrom in mA
+    uint16_t iin;         // Eingangsstrom in mA
+    uint16_t tsPercent;   // NTC-Spannung (TS) in 0.1% von REGN
+    uint8_t  status;      // Rohwert Register 0x0B (Systemstatus)
+    uint8_t  fault;       // Rohwert Register 0x0C (Fehler)
+};
+
+// Initialisierung (nach SPIFFS.begin aufrufen)
+void initTelemetry();
+
+// Aus dem Hauptloop aufrufen - sampelt selbstständig im Sekundentakt
+void telemetryTick();
+
+// Letzter Messpunkt, false wenn noch keiner vorhanden ist
+bool getLatestTelemetry(TelemetrySample& out);
+
+// Zähler, der bei jedem neuen 1s-Messpunkt erhöht wird
+uint32_t getTelemetrySequence();
+
+// Aktuelle Telemetrie-Uhr in Sekunden
+uint32_t telemetryNow();
+
+// Anzahl gespeicherter Messpunkte einer Auflösung
+size_t getTelemetryCount(TelemetryResolution res);
+
+// Kopiert bis zu maxCount Messpunkte (älteste zuerst), deren Zeitstempel
+// größer als afterTimestamp ist. Gibt die Anzahl kopierter Punkte zurück.
+size_t copyTelemetrySince(TelemetryResolution res, uint32_t afterTimestamp,
+                          TelemetrySample* out, size_t maxCount);
+
+// Hilfsfunktionen
+bool parseTelemetryResolution(const String& value, TelemetryResolution& res);
+uint32_t telemetryResolutionSeconds(TelemetryResolution res);
+int telemetryBatteryPercent(uint16_t vbatMilliVolt);
+bool telemetryIsCharging(const TelemetrySample& sample);
+const char* telemetryChargeStatusText(uint8_t status);
+const char* telemetryTemperatureText(uint8_t status);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,267 @@
+#include "TimeSync.h"
+#include "SyncCore.h"
+#include "Settings.h"
+#include "Log.h"
+#include <WiFi.h>
+#include <AsyncUDP.h>
+#include <esp_timer.h>
+
+#define TIME_SYNC_BEACON_MS 1000
+#define TIME_SYNC_ELECTION_MS 100
+
+// Bis zur Synchronisation häufig messen, danach reicht die Drift-Korrektur
+#define TIME_SYNC_REQUEST_FAST_MS 500
+#define TIME_SYNC_REQUEST_SLOW_MS 2000
+
+// So oft prüfen, ob der Empfänger (neu) gestartet werden muss
+#define TIME_SYNC_CHECK_MS 2000
+
+static AsyncUDP syncUdp;
+static bool syncListening = false;
+static uint32_t syncListenAddress = 0;
+
+static uint32_t nodeId = 0;
+
+// Zustand wird vom AsyncUDP-Task, loop() und dem LED-Task benutzt
+static ClockSync clockSync;
+static SyncElection election;
+static portMUX_TYPE syncMux = portMUX_INITIALIZER_UNLOCKED;
+
+static int64_t pendingRequestT1 = 0;   // nur Antworten auf die letzte Anfrage zählen
+
+static void fillHeader(TimeSyncPacket& packet, uint8_t type) {
+    memset(&packet, 0, sizeof(packet));
+    packet.magic[0] = TIME_SYNC_MAGIC_0;
+    packet.magic[1] = TIME_SYNC_MAGIC_1;
+    packet.version = TIME_SYNC_VERSION;
+    packet.type = type;
+    packet.nodeId = nodeId;
+}
+
+// Läuft im AsyncUDP-Task - nur kurze Abschnitte unter dem Spinlock
+static void handleSyncPacket(AsyncUDPPacket& packet) {
+    int64_t received = esp_timer_get_time();
+
+    if (packet.length() < sizeof(TimeSyncPacket)) {
+        return;
+    }
+
+    TimeSyncPacket msg;
+    memcpy(&msg, packet.data(), sizeof(msg));
+    if (msg.magic[0] != TIME_SYNC_MAGIC_0 || msg.magic[1] != TIME_SYNC_MAGIC_1 ||
+        msg.version != TIME_SYNC_VERSION || msg.nodeId == nodeId) {
+        return;  // Fremdes Paket oder eigener Broadcast
+    }
+
+    switch (msg.type) {
+        case TIME_SYNC_TYPE_BEACON: {
+            portENTER_CRITICAL(&syncMux);
+            election.onBeacon(msg.nodeId, msg.flags & TIME_SYNC_FLAG_ELIGIBLE,
+                              (uint32_t)packet.remoteIP(), received);
+            portEXIT_CRITICAL(&syncMux);
+            break;
+        }
+
+        case TIME_SYNC_TYPE_REQUEST: {
+            // Auch ein frisch abgelöster Leader antwortet noch - der Follower
+            // verwirft die Antwort, wenn er inzwischen jemand anderem folgt
+            TimeSyncPacket reply;
+            fillHeader(reply, TIME_SYNC_TYPE_RESPONSE);
+            reply.t1 = msg.t1;
+            portENTER_CRITICAL(&syncMux);
+            reply.t2 = clockSync.toShared(received);
+            reply.t3 = clockSync.toShared(esp_timer_get_time());
+            portEXIT_CRITICAL(&syncMux);
+            packet.write((const uint8_t*)&reply, sizeof(reply));
+            break;
+        }
+
+        case TIME_SYNC_TYPE_RESPONSE: {
+            bool synced = false;
+            bool accepted = false;
+            int64_t delay = 0;
+            int32_t drift = 0;
+            portENTER_CRITICAL(&syncMux);
+            if (msg.t1 == pendingRequestT1 && msg.nodeId == election.leaderId()) {
+                pendingRequestT1 = 0;
+                clockSync.addSample(msg.t1, msg.t2, msg.t3, received);
+                election.setClockSynced(clockSync.isSynced());
+                synced = clockSync.isSynced();
+                delay = clockSync.lastDelay();
+                drift = clockSync.driftPpb();
+                accepted = true;
+            }
+            portEXIT_CRITICAL(&syncMux);
+
+            if (accepted) {
+                LOGV("SYNC", "Messung: Laufzeit %lld us, Drift %ld ppb%s",
+                     (long long)delay, (long)drift,
+                     synced ? "" : " (noch nicht synchron)");
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+// Adresse, auf der Pakete ankommen können (0 = kein Netzwerk)
+static uint32_t currentNetworkAddress() {
+    if (WiFi.status() == WL_CONNECTED) {
+        return WiFi.localIP();
+    }
+    wifi_mode_t mode = WiFi.getMode();
+    if (mode == WIFI_AP || mode == WIFI_AP_STA) {
+        return WiFi.softAPIP();
+    }
+    return 0;
+}
+
+static void stopTimeSync() {
+    if (syncListening) {
+        syncUdp.close();
+        syncListening = false;
+        syncListenAddress = 0;
+        LOGI("SYNC", "Zeit-Synchronisation beendet - Animationen laufen auf eigener Uhr weiter");
+    }
+}
+
+static void startTimeSync(uint32_t address) {
+    if (!syncUdp.listen(TIME_SYNC_PORT)) {
+        LOGW("SYNC", "Zeit-Synchronisation konnte Port %d nicht öffnen", TIME_SYNC_PORT);
+        return;
+    }
+
+    // Neues Netz, neue Gruppe: erst zuhören, dann wählen
+    portENTER_CRITICAL(&syncMux);
+    election.begin(nodeId, esp_timer_get_time());
+    clockSync.resetSamples();
+    pendingRequestT1 = 0;
+    portEXIT_CRITICAL(&syncMux);
+
+    syncListening = true;
+    syncListenAddress = address;
+    LOGI("SYNC", "⏱️ Zeit-Synchronisation aktiv auf Port %d (ID %08lX)",
+         TIME_SYNC_PORT, (unsigned long)nodeId);
+}
+
+static void sendBeacon() {
+    TimeSyncPacket beacon;
+    fillHeader(beacon, TIME_SYNC_TYPE_BEACON);
+    portENTER_CRITICAL(&syncMux);
+    if (election.isEligible()) beacon.flags |= TIME_SYNC_FLAG_ELIGIBLE;
+    if (election.isLeader()) beacon.flags |= TIME_SYNC_FLAG_LEADER;
+    portEXIT_CRITICAL(&syncMux);
+    syncUdp.broadcastTo((uint8_t*)&beacon, sizeof(beacon), TIME_SYNC_PORT);
+}
+
+static void sendRequest(uint32_t leaderAddress) {
+    TimeSyncPacket request;
+    fillHeader(request, TIME_SYNC_TYPE_REQUEST);
+
+    portENTER_CRITICAL(&syncMux);
+    request.t1 = esp_timer_get_time();
+    pendingRequestT1 = request.t1;
+    portEXIT_CRITICAL(&syncMux);
+
+    syncUdp.writeTo((const uint8_t*)&request, sizeof(request), IPAddress(leaderAddress), TIME_SYNC_PORT);
+}
+
+void initTimeSync() {
+    // ID aus den unteren MAC-Bytes - eindeutig in der Gruppe, stabil über Neustarts
+    nodeId = (uint32_t)(ESP.getEfuseMac() >> 16);
+    if (nodeId == 0) {
+        nodeId = 1;
+    }
+    syncUdp.onPacket(handleSyncPacket);
+    timeSyncTick();
+}
+
+void timeSyncTick() {
+    static unsigned long lastCheck = 0;
+    if (lastCheck == 0 || millis() - lastCheck >= TIME_SYNC_CHECK_MS) {
+        lastCheck = millis();
+
+        uint32_t address = settings.udpControlEnabled ? currentNetworkAddress() : 0;
+        if (address != syncListenAddress || !syncListening) {
+            // Netzwerk weg oder gewechselt: neu binden und neu wählen
+            stopTimeSync();
+            if (address != 0) {
+                startTimeSync(address);
+            }
+        }
+    }
+
+    if (!syncListening) {
+        return;
+    }
+
+    static unsigned long lastBeacon = 0;
+    if (millis() - lastBeacon >= TIME_SYNC_BEACON_MS) {
+        lastBeacon = millis();
+        sendBeacon();
+    }
+
+    static unsigned long lastElection = 0;
+    if (millis() - lastElection < TIME_SYNC_ELECTION_MS) {
+        return;
+    }
+    lastElection = millis();
+
+    static uint32_t lastLeader = 0;
+    portENTER_CRITICAL(&syncMux);
+    uint32_t leader = election.update(esp_timer_get_time());
+    uint32_t leaderAddress = election.leaderAddress();
+    bool synced = clockSync.isSynced();
+    if (leader != lastLeader && leader != nodeId) {
+        clockSync.resetSamples();  // Messungen gelten nur für den alten Leader
+        pendingRequestT1 = 0;
+        synced = false;
+    }
+    portEXIT_CRITICAL(&syncMux);
+
+    if (leader != lastLeader) {
+        if (leader == nodeId) {
+            LOGI("SYNC", "⏱️ Dieses Badge führt die Animationszeit");
+        } else if (leader != 0) {
+            LOGI("SYNC", "⏱️ Folge Badge %08lX (%s)", (unsigned long)leader,
+                 IPAddress(leaderAddress).toString().c_str());
+        }
+        lastLeader = leader;
+    }
+
+    static unsigned long lastRequest = 0;
+    unsigned long requestInterval = synced ? TIME_SYNC_REQUEST_SLOW_MS : TIME_SYNC_REQUEST_FAST_MS;
+    if (leader != 0 && leader != nodeId && leaderAddress != 0 &&
+        millis() - lastRequest >= requestInterval) {
+        lastRequest = millis();
+        sendRequest(leaderAddress);
+    }
+}
+
+void timeSyncMeshHint(uint32_t sharedMs) {
+    if (syncListening) {
+        return;
+    }
+
+    int64_t local = esp_timer_get_time();
+    portENTER_CRITICAL(&syncMux);
+    // Nur die Phase innerhalb des 32-Bit-Millisekundenzählers zählt, daher
+    // die kleinste Korrektur auf den aktuellen Wert anwenden
+    int64_t current = clockSync.toShared(local);
+    int32_t deltaMs = (int32_t)(sharedMs - (uint32_t)(current / 1000));
+    clockSync.adopt(local, current + (int64_t)deltaMs * 1000);
+    portEXIT_CRITICAL(&syncMux);
+}
+
+int64_t syncedMicros() {
+    portENTER_CRITICAL(&syncMux);
+    int64_t shared = clockSync.toShared(esp_timer_get_time());
+    portEXIT_CRITICAL(&syncMux);
+    return shared;
+}
+
+uint32_t syncedMillis() {
+    return (uint32_t)(syncedMicros() / 1000);
+}
@@ -0,0 +1,57 @@
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <Arduino.h>
+
+// Gemeinsame Animationszeit für mehrere Badges im selben Netz.
+// Jedes Badge sendet jede Sekunde ein Beacon per Broadcast; das wählbare
+// Badge mit der kleinsten ID führt (Logik in SyncCore.h). Alle anderen
+// messen per Anfrage/Antwort im NTP-Stil Offset und Drift zu dessen Uhr.
+// Der LED-Task rechnet seine Frames aus syncedMillis(), dadurch laufen
+// gleiche Modi auf allen Badges im Gleichschritt.
+//
+// Aktiv, solange die Gruppensteuerung (settings.udpControlEnabled) an ist.
+
+#define TIME_SYNC_PORT 4211
+
+#define TIME_SYNC_MAGIC_0 'B'
+#define TIME_SYNC_MAGIC_1 'T'
+#define TIME_SYNC_VERSION 1
+
+// Pakettypen
+#define TIME_SYNC_TYPE_BEACON   0x01   // Broadcast: ID und Wählbarkeit
+#define TIME_SYNC_TYPE_REQUEST  0x02   // Follower -> Leader (t1)
+#define TIME_SYNC_TYPE_RESPONSE 0x03   // Leader -> Follower (t1, t2, t3)
+
+// Beacon-Flags
+#define TIME_SYNC_FLAG_ELIGIBLE 0x01   // hält die gemeinsame Epoche
+#define TIME_SYNC_FLAG_LEADER   0x02
+
+// Ein Paket, 36 Bytes, Little Endian, Zeiten in Mikrosekunden
+struct __attribute__((packed)) TimeSyncPacket {
+    uint8_t magic[2];       // "BT"
+    uint8_t version;        // TIME_SYNC_VERSION
+    uint8_t type;           // TIME_SYNC_TYPE_*
+    uint32_t nodeId;        // Absender
+    uint8_t flags;          // TIME_SYNC_FLAG_* (nur Beacon)
+    uint8_t reserved[3];
+    int64_t t1;             // Anfrage gesendet (lokale Uhr des Followers)
+    int64_t t2;             // Anfrage empfangen (gemeinsame Zeit)
+    int64_t t3;             // Antwort gesendet (gemeinsame Zeit)
+};
+
+// Empfänger vorbereiten (Netzwerkstart übernimmt timeSyncTick)
+void initTimeSync();
+
+// Zyklisch aus loop() aufrufen: Beacons, Leaderwahl, Messungen, Neustart nach WiFi-Wechsel
+void timeSyncTick();
+
+// Beat-Phase aus dem ESP-NOW-Mesh übernehmen (gemeinsame Zeit in ms beim
+// Empfang). Wirkt nur ohne UDP-Gruppe - dort ist die Messung genauer.
+void timeSyncMeshHint(uint32_t sharedMs);
+
+// Gemeinsame Zeit der Gruppe (ohne Gruppe: lokale Uhr); aus jedem Task aufrufbar
+int64_t syncedMicros();
+uint32_t syncedMillis();
+
+#endif // TIME_SYNC_H
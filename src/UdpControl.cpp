@@ -0,0 +1,204 @@
+#include "UdpControl.h"
+#include "Settings.h"
+#include "Globals.h"
+#include "Log.h"
+#include <WiFi.h>
+#include <AsyncUDP.h>
+
+// Nach der letzten Änderung mit UDP_FLAG_PERSIST so lange warten, bevor
+// gespeichert wird - Effekt-Sequenzen erzeugen sonst einen Flash-Zugriff pro Paket
+#define UDP_CONTROL_SAVE_DELAY_MS 3000
+
+// Ohne Pakete so lange vergisst ein Badge die Sequenz eines Senders
+// (z.B. nach Neustart des Steuerskripts)
+#define UDP_CONTROL_SENDER_TIMEOUT_MS 10000
+#define UDP_CONTROL_MAX_SENDERS 8
+
+// So oft prüfen, ob der Empfänger (neu) gestartet werden muss
+#define UDP_CONTROL_CHECK_MS 2000
+
+static AsyncUDP udp;
+static bool udpListening = false;
+static uint32_t udpListenAddress = 0;   // IP, auf der zuletzt gestartet wurde
+
+static volatile bool udpSavePending = false;
+static volatile uint32_t udpLastPersist = 0;
+
+// Letzte Sequenz je Sender - nur im AsyncUDP-Task benutzt
+struct UdpSender {
+    uint32_t address;
+    uint32_t sequence;
+    uint32_t lastSeen;
+};
+static UdpSender udpSenders[UDP_CONTROL_MAX_SENDERS];
+
+// true, wenn das Paket neuer ist als das zuletzt vom Sender angenommene
+static bool acceptSequence(uint32_t address, uint32_t sequence) {
+    uint32_t now = millis();
+    UdpSender* slot = nullptr;
+    UdpSender* oldest = &udpSenders[0];
+
+    for (int i = 0; i < UDP_CONTROL_MAX_SENDERS; i++) {
+        UdpSender& sender = udpSenders[i];
+        if (sender.address == address && sender.lastSeen != 0) {
+            slot = &sender;
+            break;
+        }
+        if (oldest->lastSeen != 0 &&
+            (sender.lastSeen == 0 || (int32_t)(sender.lastSeen - oldest->lastSeen) < 0)) {
+            oldest = &sender;
+        }
+    }
+
+    if (slot != nullptr && now - slot->lastSeen < UDP_CONTROL_SENDER_TIMEOUT_MS &&
+        (int32_t)(sequence - slot->sequence) <= 0) {
+        return false;  // Duplikat (z.B. mehrfach gesendet) oder überholt
+    }
+
+    if (slot == nullptr) {
+        slot = oldest;
+        slot->address = address;
+    }
+    slot->sequence = sequence;
+    slot->lastSeen = now ? now : 1;
+    return true;
+}
+
+static void applyUdpControl(const UdpControlPacket& msg) {
+    if (msg.fields & UDP_FIELD_MODE) {
+        currentMode = msg.mode > 24 ? 24 : msg.mode;  // 25 Modi (0-24)
+    }
+    if (msg.fields & UDP_FIELD_PRIMARY) {
+        primaryHue = msg.primaryHue;
+    }
+    if (msg.fields & UDP_FIELD_SECONDARY) {
+        secondaryHue = msg.secondaryHue;
+    }
+    if (msg.fields & UDP_FIELD_BRIGHTNESS) {
+        brightness = msg.brightness < 12 ? 12 : msg.brightness;  // Mindesthelligkeit wie in der WebUI
+    }
+    if (msg.fields & UDP_FIELD_SPEED) {
+        animSpeed = msg.speed == 0 ? 1 : msg.speed;
+    }
+
+    // Speichern übernimmt udpControlTick() gebündelt
+    if (msg.flags & UDP_FLAG_PERSIST) {
+        udpLastPersist = millis();
+        udpSavePending = true;
+    }
+}
+
+static void fillStatusPacket(UdpControlPacket& status, uint32_t sequence) {
+    memset(&status, 0, sizeof(status));
+    status.magic[0] = UDP_CONTROL_MAGIC_0;
+    status.magic[1] = UDP_CONTROL_MAGIC_1;
+    status.version = UDP_CONTROL_VERSION;
+    status.type = UDP_CONTROL_TYPE_STATUS;
+    status.sequence = sequence;
+    status.fields = UDP_FIELD_MODE | UDP_FIELD_PRIMARY | UDP_FIELD_SECONDARY |
+                    UDP_FIELD_BRIGHTNESS | UDP_FIELD_SPEED;
+    status.mode = currentMode;
+    status.primaryHue = primaryHue;
+    status.secondaryHue = secondaryHue;
+    status.brightness = brightness;
+    status.speed = animSpeed;
+}
+
+// Läuft im AsyncUDP-Task - nur Globals setzen, nichts Blockierendes
+static void handleUdpPacket(AsyncUDPPacket& packet) {
+    // Längere Pakete akzeptieren: spätere Versionen dürfen Felder anhängen
+    if (packet.length() < sizeof(UdpControlPacket)) {
+        return;
+    }
+
+    UdpControlPacket msg;
+    memcpy(&msg, packet.data(), sizeof(msg));
+    if (msg.magic[0] != UDP_CONTROL_MAGIC_0 || msg.magic[1] != UDP_CONTROL_MAGIC_1 ||
+        msg.version != UDP_CONTROL_VERSION || msg.type != UDP_CONTROL_TYPE_SET) {
+        return;
+    }
+
+    uint32_t sender = packet.remoteIP();
+    if (!acceptSequence(sender, msg.sequence)) {
+        LOGV("UDP", "Paket %lu verworfen (Duplikat/veraltet)", (unsigned long)msg.sequence);
+        return;
+    }
+
+    applyUdpControl(msg);
+    LOGD("UDP", "Paket %lu von %s: Felder 0x%02X, Modus %u, Farben %u/%u, Helligkeit %u, Tempo %u",
+         (unsigned long)msg.sequence, packet.remoteIP().toString().c_str(), msg.fields,
+         msg.mode, msg.primaryHue, msg.secondaryHue, msg.brightness, msg.speed);
+
+    if (msg.flags & UDP_FLAG_ACK) {
+        UdpControlPacket status;
+        fillStatusPacket(status, msg.sequence);
+        packet.write((const uint8_t*)&status, sizeof(status));
+    }
+}
+
+// Adresse, auf der Pakete ankommen können (0 = kein Netzwerk)
+static uint32_t currentNetworkAddress() {
+    if (WiFi.status() == WL_CONNECTED) {
+        return WiFi.localIP();
+    }
+    wifi_mode_t mode = WiFi.getMode();
+    if (mode == WIFI_AP || mode == WIFI_AP_STA) {
+        return WiFi.softAPIP();
+    }
+    return 0;
+}
+
+static void stopUdpControl() {
+    if (udpListening) {
+        udp.close();
+        udpListening = false;
+        udpListenAddress = 0;
+        LOGI("UDP", "UDP-Steuerung beendet");
+    }
+}
+
+static void startUdpControl(uint32_t address) {
+    // Multicast klappt nur im Station-Modus; im AP-Modus bleiben Unicast und Broadcast
+    bool multicast = WiFi.status() == WL_CONNECTED &&
+                     udp.listenMulticast(IPAddress(UDP_CONTROL_MULTICAST_IP), UDP_CONTROL_PORT);
+    if (!multicast && !udp.listen(UDP_CONTROL_PORT)) {
+        LOGW("UDP", "UDP-Steuerung konnte Port %d nicht öffnen", UDP_CONTROL_PORT);
+        return;
+    }
+
+    udpListening = true;
+    udpListenAddress = address;
+    LOGI("UDP", "📡 UDP-Steuerung aktiv auf Port %d%s", UDP_CONTROL_PORT,
+         multicast ? " (inkl. Multicast 239.255.42.42)" : "");
+}
+
+void initUdpControl() {
+    udp.onPacket(handleUdpPacket);
+    udpControlTick();
+}
+
+void udpControlTick() {
+    // Gebündeltes Speichern nach Paketen mit UDP_FLAG_PERSIST
+    if (udpSavePending && millis() - udpLastPersist >= UDP_CONTROL_SAVE_DELAY_MS) {
+        udpSavePending = false;
+        saveSettings();
+    }
+
+    static unsigned long lastCheck = 0;
+    if (lastCheck != 0 && millis() - lastCheck < UDP_CONTROL_CHECK_MS) {
+        return;
+    }
+    lastCheck = millis();
+
+    uint32_t address = settings.udpControlEnabled ? currentNetworkAddress() : 0;
+    if (address == udpListenAddress && udpListening) {
+        return;
+    }
+
+    // Netzwerk weg oder gewechselt (neue IP, AP <-> Station): neu binden,
+    // damit auch die Multicast-Mitgliedschaft wieder stimmt
+    stopUdpControl();
+    if (address != 0) {
+        startUdpControl(address);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef UDP_CONTROL_H
+#define UDP_CONTROL_H
+
+#include <Arduino.h>
+
+// Binäres UDP-Steuerprotokoll für Gruppeneffekte mit vielen Badges.
+// Ein Datagramm (Unicast, Broadcast oder Multicast) setzt Modus, Farben,
+// Helligkeit und Geschwindigkeit sofort - ohne TCP-Aufbau und JSON.
+// Sender: tools/badge_udp.py
+//
+// Pakete sind nicht authentifiziert - jeder Rechner im selben Netz kann die
+// Badges steuern und mit UDP_FLAG_PERSIST Flash-Schreibzugriffe auslösen.
+// Deshalb standardmäßig aus (settings.udpControlEnabled), nur in
+// vertrauenswürdigen Netzen einschalten.
+
+#define UDP_CONTROL_PORT 4210
+#define UDP_CONTROL_MULTICAST_IP 239, 255, 42, 42
+
+#define UDP_CONTROL_MAGIC_0 'B'
+#define UDP_CONTROL_MAGIC_1 'L'
+#define UDP_CONTROL_VERSION 1
+
+// Pakettypen
+#define UDP_CONTROL_TYPE_SET    0x01   // Felder laut Maske übernehmen
+#define UDP_CONTROL_TYPE_STATUS 0x02   // Antwort eines Badges (aktueller Zustand)
+
+// Feldmaske: nur gesetzte Felder werden übernommen
+#define UDP_FIELD_MODE       0x01
+#define UDP_FIELD_PRIMARY    0x02
+#define UDP_FIELD_SECONDARY  0x04
+#define UDP_FIELD_BRIGHTNESS 0x08
+#define UDP_FIELD_SPEED      0x10
+
+// Paket-Flags
+#define UDP_FLAG_ACK     0x01   // Badge antwortet mit einem STATUS-Paket
+#define UDP_FLAG_PERSIST 0x02   // Werte auch in den Einstellungen speichern
+
+// Ein Paket, 16 Bytes, Little Endian
+struct __attribute__((packed)) UdpControlPacket {
+    uint8_t magic[2];       // "BL"
+    uint8_t version;        // UDP_CONTROL_VERSION
+    uint8_t type;           // UDP_CONTROL_TYPE_*
+    uint32_t sequence;      // Pro Sender steigend - Duplikate/Veraltetes wird verworfen
+    uint8_t fields;         // UDP_FIELD_*
+    uint8_t flags;          // UDP_FLAG_*
+    uint8_t mode;
+    uint8_t primaryHue;
+    uint8_t secondaryHue;
+    uint8_t brightness;
+    uint16_t speed;         // animSpeed in ms
+};
+
+// Empfänger starten (sobald WiFi bereit ist, sonst später durch udpControlTick)
+void initUdpControl();
+
+// Zyklisch aus loop() aufrufen: (Re-)Start nach WiFi-Wechsel, verzögertes Speichern
+void udpControlTick();
+
+#endif // UDP_CONTROL_H
@@ -27,11 +27,6 @@ extern String apPassword;
 // LED-Status
 extern bool ledsEnabled;
 
-// HTML Templates
-extern const char index_html[] PROGMEM;
-extern const char network_html[] PROGMEM;
-extern const char display_html[] PROGMEM;
-
 // Externe Variablen
 extern uint8_t gCurrentMode;
 extern uint8_t BRIGHTNESS;
@@ -48,21 +43,37 @@ extern DisplayContent displayContent;
 void addEspLog(const String& message);
 void addBqLog(const String& message);
 
-// Handler für JSON-Daten
+// Größte akzeptierte JSON-Nutzlast - größere Anfragen werden ohne Allokation abgelehnt (413)
+#define JSON_BODY_MAX 1024
+// Kapazität des JSON-Dokuments je Anfrage
+#define JSON_DOC_SIZE 1024
+// Gleichzeitig bearbeitbare JSON-Anfragen (feste Arenen, weitere erhalten 503)
+#define JSON_ARENA_SLOTS 2
+
+// Handler für JSON-Daten. Body und Dokument liegen in einer von
+// JSON_ARENA_SLOTS festen Arenen; geparst wird direkt im Body-Puffer
+// (Zero-Copy), pro Anfrage entsteht keine Heap-Allokation.
 class AsyncCallbackJsonWebHandler: public AsyncWebHandler {
 private:
     String _uri;
     ArJsonRequestHandlerFunction _callback;
     ArRequestFilterFunction _filter;
+    size_t _maxContentLength;
 
 public:
-    AsyncCallbackJsonWebHandler(const String& uri, ArJsonRequestHandlerFunction callback) : _uri(uri), _callback(callback) {}
+    AsyncCallbackJsonWebHandler(const String& uri, ArJsonRequestHandlerFunction callback)
+        : _uri(uri), _callback(callback), _maxContentLength(JSON_BODY_MAX) {}
     virtual ~AsyncCallbackJsonWebHandler() {}
 
     void setFilter(ArRequestFilterFunction filter){
         _filter = filter;
     }
 
+    // Kleinere Obergrenze für diesen Endpunkt (höchstens JSON_BODY_MAX)
+    void setMaxContentLength(size_t maxContentLength){
+        _maxContentLength = maxContentLength < JSON_BODY_MAX ? maxContentLength : JSON_BODY_MAX;
+    }
+
     virtual bool canHandle(AsyncWebServerRequest *request){
         if (_filter && !_filter(request))
             return false;
@@ -73,42 +84,9 @@ public:
         return true;
     }
 
-    virtual void handleRequest(AsyncWebServerRequest *request){
-        if (request->method() == HTTP_POST || request->method() == HTTP_PUT){
-            if (request->contentType() == "application/json"){
-                DynamicJsonDocument jsonBuffer(1024);
-                DeserializationError error = deserializeJson(jsonBuffer, (const char*)request->_tempObject);
-                if (!error){
-                    JsonVariant json = jsonBuffer.as<JsonVariant>();
-                    _callback(request, json);
-                } else {
-                    request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
-                }
-            } else {
-                request->send(400, "application/json", "{\"error\":\"Invalid Content-Type\"}");
-            }
-        } else {
-            request->send(400, "application/json", "{\"error\":\"Invalid HTTP Method\"}");
-        }
-    }
-
+    virtual void handleRequest(AsyncWebServerRequest *request);
     virtual void handleUpload(AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data, size_t len, bool final) {}
-    virtual void handleBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-        if (!index){
-            if (request->_tempObject != NULL){
-                free(request->_tempObject);
-            }
-            request->_tempObject = malloc(total);
-            if(request->_tempObject == NULL){
-                request->send(500, "application/json", "{\"error\":\"Memory allocation failed\"}");
-                return;
-            }
-        }
-        memcpy((uint8_t*)(request->_tempObject) + index, data, len);
-        if (index + len == total){
-            ((uint8_t*)(request->_tempObject))[total] = '\0';
-        }
-    }
+    virtual void handleBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
 };
 
 // WebServer-Initialisierung
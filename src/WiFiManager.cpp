@@ -0,0 +1,345 @@
+#include "WiFiManager.h"
+#include "Settings.h"
+#include "Globals.h"
+#include "Boot.h"
+#include "Log.h"
+#include <WiFi.h>
+#include <ESPmDNS.h>
+#include <esp_wifi.h>
+#include <esp_rom_crc.h>
+#include <freertos/semphr.h>
+
+extern String apName;
+extern String apPassword;
+extern bool wifiEnabled;
+extern bool lastWifiStatus;
+
+// Mit eigenem Access Point stört jeder Scan die verbundenen Clients
+#define WIFI_FALLBACK_RETRY_MS 60000
+
+// Letzter Access Point für den schnellen Wiederaufbau - im RTC-Speicher,
+// übersteht Deep Sleep und Software-Neustarts
+#define WIFI_FAST_CONNECT_MAGIC 0x57464331  // "WFC1"
+
+struct WifiFastConnect {
+    uint32_t magic;
+    uint32_t credentialsCrc;   // SSID + Passwort - neue Zugangsdaten verwerfen den Eintrag
+    uint8_t bssid[6];
+    uint8_t channel;
+};
+
+RTC_DATA_ATTR static WifiFastConnect fastConnect;
+
+// Aufrufer: Boot-Stufe, loop(), Tasten im LED-Task, Webserver-Task
+static SemaphoreHandle_t wifiMutex = NULL;
+
+static WifiManagerState state = WIFI_MANAGER_OFF;
+static bool fallbackActive = false;
+static bool mdnsStarted = false;
+
+static uint8_t failedAttempts = 0;
+static bool attemptUsedCache = false;
+static unsigned long attemptStart = 0;
+static unsigned long backoffUntil = 0;
+static wifi_ps_type_t appliedPowerSave = WIFI_PS_NONE;
+
+// Vom WiFi-Ereignis-Task gesetzt, von wifiManagerTick() abgeholt
+static volatile bool eventGotIp = false;
+static volatile bool eventDisconnected = false;
+static volatile uint8_t lastDisconnectReason = 0;
+
+static uint32_t credentialsCrc() {
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)wifiSSID.c_str(), wifiSSID.length());
+    return esp_rom_crc32_le(crc, (const uint8_t*)wifiPassword.c_str(), wifiPassword.length());
+}
+
+static bool fastConnectValid() {
+    return fastConnect.magic == WIFI_FAST_CONNECT_MAGIC &&
+           fastConnect.credentialsCrc == credentialsCrc() &&
+           fastConnect.channel != 0;
+}
+
+// Läuft im Arduino-Ereignis-Task - nur Flags setzen
+static void onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info) {
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            eventGotIp = true;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            lastDisconnectReason = info.wifi_sta_disconnected.reason;
+            eventDisconnected = true;
+            break;
+        default:
+            break;
+    }
+}
+
+static void applyPowerSave() {
+    // Das Mesh muss Broadcasts jederzeit hören, Modem-Sleep verpasst sie
+    wifi_ps_type_t wanted = settings.espNowMeshEnabled ? WIFI_PS_NONE : WIFI_PS_MIN_MODEM;
+    if (wanted != appliedPowerSave && WiFi.setSleep(wanted)) {
+        appliedPowerSave = wanted;
+        LOGD("WIFI", "Modem-Sleep %s", wanted == WIFI_PS_NONE ? "aus" : "an");
+    }
+}
+
+static void startFallbackAccessPoint() {
+    if (fallbackActive) {
+        return;
+    }
+    WiFi.mode(WIFI_AP_STA);
+    const char* password = apPassword.length() > 0 ? apPassword.c_str() : NULL;
+    if (WiFi.softAP(apName.c_str(), password)) {
+        fallbackActive = true;
+        LOGW("WIFI", "📶 WLAN nicht erreichbar - eigener Access Point '%s' aktiv, verbinde weiter im Hintergrund",
+             apName.c_str());
+    } else {
+        LOGE("WIFI", "Fallback-Access-Point konnte nicht gestartet werden");
+    }
+}
+
+static void stopFallbackAccessPoint() {
+    if (!fallbackActive) {
+        return;
+    }
+    WiFi.softAPdisconnect(true);
+    WiFi.mode(WIFI_STA);
+    fallbackActive = false;
+    appliedPowerSave = WIFI_PS_NONE;  // Nach Moduswechsel neu setzen
+    LOGI("WIFI", "Fallback-Access-Point beendet");
+}
+
+static void beginAttempt() {
+    eventGotIp = false;
+    eventDisconnected = false;
+    attemptStart = millis();
+    attemptUsedCache = fastConnectValid();
+
+    if (attemptUsedCache) {
+        // Kanal und BSSID bekannt: kein Scan über alle Kanäle
+        WiFi.begin(wifiSSID.c_str(), wifiPassword.c_str(), fastConnect.channel, fastConnect.bssid);
+        LOGD("WIFI", "Verbinde mit '%s' (Kanal %d, gespeicherter AP)", wifiSSID.c_str(), fastConnect.channel);
+    } else {
+        WiFi.begin(wifiSSID.c_str(), wifiPassword.c_str());
+        LOGD("WIFI", "Verbinde mit '%s' (Versuch %d)", wifiSSID.c_str(), failedAttempts + 1);
+    }
+    state = WIFI_MANAGER_CONNECTING;
+}
+
+static void attemptFailed() {
+    WiFi.disconnect(false);
+
+    if (attemptUsedCache) {
+        // AP umgezogen oder anderer Kanal: nächster Versuch mit vollem Scan, sofort
+        fastConnect.magic = 0;
+        backoffUntil = millis();
+        state = WIFI_MANAGER_BACKOFF;
+        return;
+    }
+
+    if (failedAttempts < 30) {
+        failedAttempts++;
+    }
+
+    uint32_t backoff = WIFI_BACKOFF_MIN_MS << (failedAttempts - 1 < 6 ? failedAttempts - 1 : 6);
+    if (backoff > WIFI_BACKOFF_MAX_MS) {
+        backoff = WIFI_BACKOFF_MAX_MS;
+    }
+    if (fallbackActive && backoff < WIFI_FALLBACK_RETRY_MS) {
+        backoff = WIFI_FALLBACK_RETRY_MS;
+    }
+    backoff += esp_random() % (backoff / 4 + 1);  // Viele Badges nicht im Gleichtakt
+    backoffUntil = millis() + backoff;
+    state = WIFI_MANAGER_BACKOFF;
+
+    LOGI("WIFI", "WLAN-Versuch %d fehlgeschlagen (Grund %d), nächster in %lu ms",
+         failedAttempts, lastDisconnectReason, (unsigned long)backoff);
+
+    if (failedAttempts >= WIFI_FALLBACK_ATTEMPTS) {
+        startFallbackAccessPoint();
+        bootFinishStage(BOOT_STAGE_CONNECT, false);
+    }
+}
+
+static void connected() {
+    state = WIFI_MANAGER_CONNECTED;
+    failedAttempts = 0;
+    stopFallbackAccessPoint();
+    applyPowerSave();
+
+    // Für den nächsten Start merken
+    fastConnect.magic = WIFI_FAST_CONNECT_MAGIC;
+    fastConnect.credentialsCrc = credentialsCrc();
+    memcpy(fastConnect.bssid, WiFi.BSSID(), sizeof(fastConnect.bssid));
+    fastConnect.channel = WiFi.channel();
+
+    LOGI("WIFI", "✅ Verbunden mit '%s', IP %s, %d dBm, Kanal %d (%lu ms)",
+         WiFi.SSID().c_str(), WiFi.localIP().toString().c_str(), WiFi.RSSI(),
+         fastConnect.channel, (unsigned long)(millis() - attemptStart));
+
+    // mDNS starten für badge.local
+    if (!mdnsStarted) {
+        mdnsStarted = MDNS.begin("badge");
+        if (mdnsStarted) {
+            LOGI("WIFI", "mDNS gestartet: badge.local");
+        } else {
+            LOGW("WIFI", "mDNS konnte nicht gestartet werden");
+        }
+    }
+
+    bootFinishStage(BOOT_STAGE_CONNECT, true);
+}
+
+void initWiFiManager() {
+    if (wifiMutex == NULL) {
+        wifiMutex = xSemaphoreCreateMutex();
+    }
+    WiFi.persistent(false);       // Verhindert häufiges Schreiben in den Flash
+    WiFi.setAutoReconnect(false); // Wiederverbinden übernimmt der Backoff
+    WiFi.onEvent(onWiFiEvent);
+}
+
+static void startClient() {
+    if (wifiSSID.length() == 0) {
+        LOGW("WIFI", "Keine WLAN-Daten konfiguriert - nur eigener Access Point");
+        failedAttempts = WIFI_FALLBACK_ATTEMPTS;
+        state = WIFI_MANAGER_ACCESS_POINT;
+        startFallbackAccessPoint();
+        wifiEnabled = true;
+        lastWifiStatus = true;
+        bootFinishStage(BOOT_STAGE_CONNECT, false);
+        return;
+    }
+
+    if (WiFi.getMode() != WIFI_STA && !fallbackActive) {
+        WiFi.softAPdisconnect(true);
+        WiFi.mode(WIFI_STA);
+        appliedPowerSave = WIFI_PS_NONE;
+    } else if (WiFi.status() == WL_CONNECTED) {
+        WiFi.disconnect(false);  // Neue Zugangsdaten
+    }
+    applyPowerSave();
+
+    failedAttempts = 0;
+    wifiEnabled = true;
+    lastWifiStatus = true;
+    beginAttempt();
+}
+
+static void startAccessPoint() {
+    WiFi.disconnect(false);
+    fallbackActive = false;
+    WiFi.mode(WIFI_AP);
+    const char* password = apPassword.length() > 0 ? apPassword.c_str() : NULL;
+    bool started = WiFi.softAP(apName.c_str(), password);
+    if (started) {
+        LOGI("WIFI", "Access Point gestartet: %s", apName.c_str());
+        if (!mdnsStarted) {
+            mdnsStarted = MDNS.begin("badge");
+        }
+    } else {
+        LOGE("WIFI", "Fehler beim Starten des Access Points");
+    }
+
+    state = WIFI_MANAGER_ACCESS_POINT;
+    wifiEnabled = started;
+    lastWifiStatus = started;
+    bootFinishStage(BOOT_STAGE_CONNECT, true);  // Kein Client-Modus, nichts zu verbinden
+}
+
+static void stop() {
+    state = WIFI_MANAGER_OFF;
+    fallbackActive = false;
+    WiFi.disconnect();
+    WiFi.softAPdisconnect(true);
+    WiFi.mode(WIFI_OFF);  // KRITISCH: WiFi Mode explizit auf OFF setzen!
+    appliedPowerSave = WIFI_PS_NONE;
+    wifiEnabled = false;
+    lastWifiStatus = false;
+    bootFinishStage(BOOT_STAGE_CONNECT, false);  // Ausgeschaltet, bevor eine Verbindung stand
+}
+
+static void tick() {
+    bool gotIp = eventGotIp;
+    bool disconnected = eventDisconnected;
+
+    switch (state) {
+        case WIFI_MANAGER_CONNECTING:
+            if (gotIp && WiFi.status() == WL_CONNECTED) {
+                eventGotIp = false;
+                connected();
+            } else if (disconnected || millis() - attemptStart >= WIFI_ATTEMPT_TIMEOUT_MS) {
+                eventDisconnected = false;
+                attemptFailed();
+            }
+            break;
+
+        case WIFI_MANAGER_BACKOFF:
+            if ((long)(millis() - backoffUntil) >= 0) {
+                beginAttempt();
+            }
+            break;
+
+        case WIFI_MANAGER_CONNECTED:
+            if (disconnected || WiFi.status() != WL_CONNECTED) {
+                eventDisconnected = false;
+                LOGW("WIFI", "WLAN-Verbindung verloren (Grund %d) - verbinde neu", lastDisconnectReason);
+                beginAttempt();  // Sofort, mit gespeichertem AP
+            } else {
+                applyPowerSave();  // Mesh-Einstellung kann sich ändern
+            }
+            break;
+
+        default:
+            eventGotIp = false;
+            eventDisconnected = false;
+            break;
+    }
+}
+
+void wifiManagerStartClient() {
+    if (wifiMutex != NULL && xSemaphoreTake(wifiMutex, portMAX_DELAY)) {
+        startClient();
+        xSemaphoreGive(wifiMutex);
+    }
+}
+
+void wifiManagerStartAccessPoint() {
+    if (wifiMutex != NULL && xSemaphoreTake(wifiMutex, portMAX_DELAY)) {
+        startAccessPoint();
+        xSemaphoreGive(wifiMutex);
+    }
+}
+
+void wifiManagerStop() {
+    if (wifiMutex != NULL && xSemaphoreTake(wifiMutex, portMAX_DELAY)) {
+        stop();
+        xSemaphoreGive(wifiMutex);
+    }
+}
+
+void wifiManagerTick() {
+    // Läuft gerade ein Moduswechsel, kommt der nächste Tick dran
+    if (wifiMutex != NULL && xSemaphoreTake(wifiMutex, 0)) {
+        tick();
+        xSemaphoreGive(wifiMutex);
+    }
+}
+
+void wifiManagerReconnectNow() {
+    if (state == WIFI_MANAGER_BACKOFF) {
+        backoffUntil = millis();
+    }
+}
+
+WifiManagerState wifiManagerState() {
+    return state;
+}
+
+bool wifiManagerConnected() {
+    return state == WIFI_MANAGER_CONNECTED && WiFi.status() == WL_CONNECTED;
+}
+
+bool wifiManagerFallbackActive() {
+    return fallbackActive;
+}
@@ -0,0 +1,54 @@
+#ifndef WIFI_MANAGER_H
+#define WIFI_MANAGER_H
+
+#include <Arduino.h>
+
+// Ereignisgesteuerte WLAN-Verbindung.
+// Kein Task wartet mehr auf die Anmeldung: WiFi.begin() kehrt sofort zurück,
+// die WiFi-Ereignisse setzen nur Flags und wifiManagerTick() (aus loop())
+// entscheidet über den nächsten Schritt:
+//
+// - Fehlversuche werden mit exponentiellem Backoff plus Zufallsanteil wiederholt
+// - BSSID und Kanal des letzten Access Points liegen im RTC-Speicher
+//   (übersteht Deep Sleep und Neustarts) - die Verbindung spart den Scan
+// - Nach WIFI_FALLBACK_ATTEMPTS Fehlversuchen startet zusätzlich der eigene
+//   Access Point; im Hintergrund wird weiter (seltener) verbunden
+// - Im Client-Modus ist Modem-Sleep aktiv, außer das ESP-NOW-Mesh braucht
+//   das Funkmodul dauerhaft empfangsbereit
+
+#define WIFI_ATTEMPT_TIMEOUT_MS 15000   // Ein Versuch ohne IP gilt als gescheitert
+#define WIFI_BACKOFF_MIN_MS     1000
+#define WIFI_BACKOFF_MAX_MS     60000
+#define WIFI_FALLBACK_ATTEMPTS  4       // Danach eigener Access Point
+
+enum WifiManagerState {
+    WIFI_MANAGER_OFF = 0,       // Funk aus (oder gehört dem ESP-NOW-Mesh)
+    WIFI_MANAGER_ACCESS_POINT,  // Nur eigener Access Point (Client-Modus deaktiviert)
+    WIFI_MANAGER_CONNECTING,    // WiFi.begin() läuft
+    WIFI_MANAGER_BACKOFF,       // Warten bis zum nächsten Versuch
+    WIFI_MANAGER_CONNECTED
+};
+
+// WiFi-Ereignisse registrieren (einmal, vor allen anderen Aufrufen)
+void initWiFiManager();
+
+// Mit wifiSSID/wifiPassword verbinden - kehrt sofort zurück
+void wifiManagerStartClient();
+
+// Nur eigenen Access Point (apName/apPassword) betreiben
+void wifiManagerStartAccessPoint();
+
+// WLAN und Access Point abschalten
+void wifiManagerStop();
+
+// Zyklisch aus loop() aufrufen
+void wifiManagerTick();
+
+// Laufenden Backoff abbrechen und sofort neu verbinden
+void wifiManagerReconnectNow();
+
+WifiManagerState wifiManagerState();
+bool wifiManagerConnected();
+bool wifiManagerFallbackActive();   // Eigener AP läuft, weil das WLAN fehlt
+
+#endif // WIFI_MANAGER_H
@@ -12,10 +12,17 @@
 #include "SPIFFS.h"
 #include "BQ25895CONFIG.h"
 #include "Globals.h"  // KRITISCH: Globale Variablen einbinden
+#include "Telemetry.h"  // Ringpuffer für Ladegerät-Messwerte
+#include "Log.h"  // Stufen-Logging mit Drain-Task
+#include "UdpControl.h"  // Binäre Gruppensteuerung per UDP
+#include "TimeSync.h"  // Gemeinsame Animationszeit mehrerer Badges
+#include "EspNowMesh.h"  // Badge-zu-Badge-Effekte ohne Access Point
+#include "Boot.h"  // Gestufter, paralleler Boot
+#include "WiFiManager.h"  // WLAN mit Backoff und Fallback-AP
+#include "OtaAgent.h"  // OTA-Checkin und Download im eigenen Task
+#include "OtaHealth.h"  // Bestätigung bzw. Rollback neuer Firmware
 #include <ArduinoJson.h>
 #include <WiFi.h>
-#include <HTTPClient.h>
-#include <Update.h>
 #include <ESPmDNS.h>  // mDNS für badge.local
 #include <esp_sleep.h> // Für Deep Sleep Funktionalität
 
@@ -30,7 +37,6 @@ String apPassword = "";
 // Externe Variablen
 extern bool displayAvailable;
 extern DisplayContent displayContent;
-extern QueueHandle_t displayQueue;
 extern BQ25895* charger;
 
 // Externe Funktionen
@@ -113,6 +119,12 @@ TaskHandle_t statusLedTaskHandle = NULL; // Separate Task für Status LEDs
 SemaphoreHandle_t ledMutex;
 SemaphoreHandle_t statusLedMutex; // Separate Mutex für Status LEDs
 
+// Animationsuhr: Frames werden aus der gemeinsamen Gruppenzeit (TimeSync)
+// abgeleitet, damit Badges im selben Modus dasselbe Bild zeigen
+#define ANIM_MAX_CATCHUP_FRAMES 4   // verpasste Frames nachholen, größere Lücken überspringen
+uint32_t animFrame = 0;     // Nummer des zuletzt berechneten Frames
+uint32_t animTimeMs = 0;    // Gemeinsame Zeit dieses Frames (Frame * animSpeed)
+
 // LED-Indikator für Tasten
 unsigned long modeLedOffTime = 0;  // Zeitpunkt, wann die Mode LED ausgeschaltet wird
 unsigned long colorLedOffTime = 0; // Zeitpunkt, wann die Color LED ausgeschaltet wird
@@ -161,15 +173,12 @@ void meteor();
 void colorSpin();
 void musicReactive();
 void addGlitter(uint8_t chance);
+void renderAnimationFrame(uint32_t frame, uint16_t speed);
 void updateStatusLED();
 void ledTask(void *parameter);
 void statusLedTask(void *parameter); // Neue Task-Funktion für Status LEDs
 
 // OTA Funktionen
-void connectToWiFi();
-void performOTACheckin();
-void updateFirmware(String url);
-void checkForOTAUpdate();
 void startStatusLedUpdate();
 void startStatusLedReboot();
 void startStatusLedLock();
@@ -179,42 +188,18 @@ void updateStatusLedFeedback();
 // Funktion zum Togglen von WiFi
 void toggleWiFi() {
     if (!wifiEnabled) {
-        // WiFi-Verbindung starten
+        // WiFi starten - die Verbindung baut der WiFiManager im Hintergrund auf
         if (wifiConnectEnabled) {
-            // Client-Modus aktivieren
             Serial.println("Boot-Button: Aktiviere WiFi Client-Modus");
-            connectToWiFi();
-            if (WiFi.status() == WL_CONNECTED) {
-                wifiEnabled = true;
-                Serial.println("WiFi Client-Verbindung hergestellt");
-                
-                // Status merken
-                lastWifiStatus = true;
-            } else {
-                Serial.println("WiFi Client-Verbindung fehlgeschlagen");
-            }
+            wifiManagerStartClient();
         } else {
-            // AP-Modus aktivieren
             Serial.println("Boot-Button: Aktiviere WiFi AP-Modus");
-            WiFi.mode(WIFI_AP);
-            WiFi.softAP(apName.c_str(), apPassword.length() > 0 ? apPassword.c_str() : NULL);
-            wifiEnabled = true;
-            Serial.println("WiFi AP-Modus aktiviert: " + apName);
-            
-            // Status merken
-            lastWifiStatus = true;
+            wifiManagerStartAccessPoint();
         }
     } else {
-        // WiFi-Verbindung trennen
         Serial.println("Boot-Button: Deaktiviere WiFi");
-        WiFi.disconnect();
-        WiFi.softAPdisconnect(true);
-        WiFi.mode(WIFI_OFF);  // KRITISCH: WiFi Mode explizit auf OFF setzen!
-        wifiEnabled = false;
+        wifiManagerStop();
         Serial.println("WiFi-Verbindung getrennt und auf WIFI_OFF gesetzt");
-        
-        // Status merken
-        lastWifiStatus = false;
     }
 }
 
@@ -236,13 +221,68 @@ void checkBootButton() {
     }
 }
 
+// true beim ersten Frame eines neuen Zyklus der gemeinsamen Zeit - alle
+// Badges setzen ihre Effekt-Zustände damit im selben Moment zurück
+static bool animationCycleStarted(uint32_t& lastCycle, uint32_t periodMs) {
+    uint32_t cycle = animTimeMs / periodMs;
+    if (cycle == lastCycle) {
+        return false;
+    }
+    lastCycle = cycle;
+    return true;
+}
+
+// beatsin8/16 auf der gemeinsamen Zeit statt auf millis()
+static uint8_t syncedBeatsin8(accum88 bpm, uint8_t low, uint8_t high, uint8_t phase = 0) {
+    return beatsin8(bpm, low, high, millis() - animTimeMs, phase);
+}
+
+static uint16_t syncedBeatsin16(accum88 bpm, uint16_t low, uint16_t high, uint16_t phase = 0) {
+    return beatsin16(bpm, low, high, millis() - animTimeMs, phase);
+}
+
+// Einen Frame berechnen: Zeit und Zufall hängen nur von der Frame-Nummer ab,
+// daher würfeln auch Funkeln, Feuer usw. auf allen Badges gleich
+void renderAnimationFrame(uint32_t frame, uint16_t speed) {
+    animTimeMs = frame * speed;
+    random16_set_seed((uint16_t)((frame * 2654435761UL) >> 16));
+    
+    // KORRIGIERTE Animationszuordnung
+    switch(currentMode) {
+        case 0:  solidColor();      break;  // Einfarbig
+        case 1:  rainbow();         break;  // Regenbogen
+        case 2:  rainbowWave();     break;  // Regenbogen-Welle
+        case 3:  colorWipe();       break;  // Farbwisch
+        case 4:  theaterChase();    break;  // Theater-Verfolgung
+        case 5:  twinkle();         break;  // Funkeln
+        case 6:  fire();            break;  // Feuer
+        case 7:  pulse();           break;  // Pulsieren
+        case 8:  wave();            break;  // Welle
+        case 9:  sparkle();         break;  // Glitzern
+        case 10: gradient();        break;  // Gradient
+        case 11: dots();            break;  // Wandernde Punkte
+        case 12: comet();           break;  // Komet
+        case 13: bounce();          break;  // Springender Ball
+        case 14: fireworks();       break;  // Feuerwerk
+        case 15: lightning();       break;  // Blitz
+        case 16: confetti();        break;  // Konfetti
+        case 17: breathe();         break;  // Atmung
+        case 18: rain();            break;  // Regen
+        case 19: matrix();          break;  // Matrix
+        case 20: orbit();           break;  // Umlaufbahn
+        case 21: spiral();          break;  // Spirale
+        case 22: meteor();          break;  // Meteorschauer
+        case 23: colorSpin();       break;  // Farbrotation
+        case 24: musicReactive();   break;  // Musik-reaktiv
+        default: solidColor();      break;  // Fallback
+    }
+}
+
 // LED Task Funktion mit korrigierter Animation-Zuordnung
 void ledTask(void *parameter) {
-    Serial.println("=== LED Task gestartet (KORRIGIERT) ===");
-    Serial.printf("Core: %d, Modus: %d, Primär: %d, Sekundär: %d\n", 
-                 xPortGetCoreID(), currentMode, primaryHue, secondaryHue);
+    LOGI("LED", "LED Task gestartet - Core: %d, Modus: %d, Primär: %d, Sekundär: %d",
+         xPortGetCoreID(), currentMode, primaryHue, secondaryHue);
     
-    unsigned long lastUpdate = 0;
     unsigned long lastMemoryCheck = 0;
     // unsigned long lastWatchdogReset = 0;  // ENTFERNT - nicht mehr benötigt
     unsigned long loopCounter = 0;
@@ -263,10 +303,10 @@ void ledTask(void *parameter) {
         // Memory-Check alle 30 Sekunden um Aufhängen zu verhindern
         if (currentTime - lastMemoryCheck > 30000) {
             size_t freeHeap = ESP.getFreeHeap();
-            Serial.printf("LED-Task: Freier Heap: %d bytes, Loops: %d\n", freeHeap, loopCounter);
+            LOGD("LED", "Freier Heap: %u bytes, Loops: %lu", (unsigned)freeHeap, loopCounter);
             
             if (freeHeap < 20000) {
-                Serial.printf("WARNUNG: Wenig Speicher im LED-Task: %d bytes\n", freeHeap);
+                LOGW("LED", "Wenig Speicher im LED-Task: %u bytes", (unsigned)freeHeap);
                 // Kurze Pause für Garbage Collection
                 vTaskDelay(pdMS_TO_TICKS(100));
                 // esp_task_wdt_reset(); // Nach Pause Watchdog zurücksetzen - ENTFERNT
@@ -280,75 +320,77 @@ void ledTask(void *parameter) {
         
         // KRITISCH: Lokale Kopie von animSpeed für Race-Condition-Schutz
         uint16_t currentAnimSpeed = animSpeed;  // Atomic read der volatile Variable
+        if (currentAnimSpeed == 0) {
+            currentAnimSpeed = 1;
+        }
         
-        // Animation alle animSpeed ms
-        if (currentTime - lastUpdate >= currentAnimSpeed) {
+        // Animation alle animSpeed ms - gezählt auf der gemeinsamen Zeit der Gruppe
+        uint32_t targetFrame = syncedMillis() / currentAnimSpeed;
+        bool ledMutexOk = true;
+        if (targetFrame != animFrame) {
             // KRITISCH: Mutex mit Timeout und Fehlerbehandlung
             if(xSemaphoreTake(ledMutex, pdMS_TO_TICKS(100))) {  // Timeout erhöht auf 100ms
                 // DEBUG: Status vor LED-Update prüfen
                 static bool lastLowBatteryState = false;
                 if (isLowBattery != lastLowBatteryState) {
-                    Serial.printf("🔴 LED-TASK DEBUG: isLowBattery Status geändert: %s -> %s\n", 
-                                 lastLowBatteryState?"JA":"NEIN", isLowBattery?"JA":"NEIN");
+                    LOGD("LED", "🔴 isLowBattery Status geändert: %s -> %s",
+                         lastLowBatteryState?"JA":"NEIN", isLowBattery?"JA":"NEIN");
                     lastLowBatteryState = isLowBattery;
                 }
                 
                 // Hauptanimation - nur aktualisieren wenn keine Low-Battery-Bedingung
                 if (!isLowBattery) {
-                    // KORRIGIERTE Animationszuordnung
-                    switch(currentMode) {
-                        case 0:  solidColor();      break;  // Einfarbig
-                        case 1:  rainbow();         break;  // Regenbogen
-                        case 2:  rainbowWave();     break;  // Regenbogen-Welle
-                        case 3:  colorWipe();       break;  // Farbwisch
-                        case 4:  theaterChase();    break;  // Theater-Verfolgung
-                        case 5:  twinkle();         break;  // Funkeln
-                        case 6:  fire();            break;  // Feuer
-                        case 7:  pulse();           break;  // Pulsieren
-                        case 8:  wave();            break;  // Welle
-                        case 9:  sparkle();         break;  // Glitzern
-                        case 10: gradient();        break;  // Gradient
-                        case 11: dots();            break;  // Wandernde Punkte
-                        case 12: comet();           break;  // Komet
-                        case 13: bounce();          break;  // Springender Ball
-                        case 14: fireworks();       break;  // Feuerwerk
-                        case 15: lightning();       break;  // Blitz
-                        case 16: confetti();        break;  // Konfetti
-                        case 17: breathe();         break;  // Atmung
-                        case 18: rain();            break;  // Regen
-                        case 19: matrix();          break;  // Matrix
-                        case 20: orbit();           break;  // Umlaufbahn
-                        case 21: spiral();          break;  // Spirale
-                        case 22: meteor();          break;  // Meteorschauer
-                        case 23: colorSpin();       break;  // Farbrotation
-                        case 24: musicReactive();   break;  // Musik-reaktiv
-                        default: solidColor();      break;  // Fallback
+                    // Verpasste Frames nachrechnen, damit zustandsbehaftete Effekte
+                    // im Gleichschritt bleiben; nach Sprüngen (Resync, neues Tempo)
+                    // direkt beim aktuellen Frame weitermachen
+                    uint32_t behind = targetFrame - animFrame;
+                    uint32_t steps = behind <= ANIM_MAX_CATCHUP_FRAMES ? behind : 1;
+                    for (uint32_t frame = targetFrame - steps + 1; steps > 0; steps--, frame++) {
+                        renderAnimationFrame(frame, currentAnimSpeed);
+                    }
+                    
+                    // Welle aus dem ESP-NOW-Mesh über die Animation blenden
+                    uint8_t waveHue = 0;
+                    uint8_t waveLevel = meshWaveLevel(waveHue);
+                    if (waveLevel > 0) {
+                        CRGB waveColor = CHSV(waveHue, 255, 255);
+                        for (int i = 0; i < NUM_MAIN_LEDS; i++) {
+                            nblend(mainLeds[i], waveColor, waveLevel);
+                        }
                     }
                     
                     // KRITISCH: Sichere LED-Aktualisierung ohne gefährliche Interrupt-Blockade
                     // Das Mutex schützt bereits vor Race Conditions - keine zusätzlichen Critical Sections nötig
                     // portDISABLE_INTERRUPTS war gefährlich und konnte Watchdog-Reboots verursachen
                     FastLED[0].showLeds(brightness);
+                    bootMarkFirstFrame();
                 }
                 
                 xSemaphoreGive(ledMutex);
             } else {
                 // Mutex-Timeout - Kritischer Fehler, möglicherweise Deadlock
-                Serial.println("KRITISCH: LED-Mutex Timeout - möglicher Deadlock!");
+                ledMutexOk = false;
+                LOGE("LED", "LED-Mutex Timeout - möglicher Deadlock!");
                 // esp_task_wdt_reset(); // Watchdog zurücksetzen - ENTFERNT
                 
                 // Bei wiederholten Timeouts Task neustarten (Notfall-Maßnahme)
                 static uint8_t timeoutCounter = 0;
                 timeoutCounter++;
                 if (timeoutCounter > 5) {
-                    Serial.println("NOTFALL: Zu viele Mutex-Timeouts - Task wird neugestartet!");
+                    LOGE("LED", "Zu viele Mutex-Timeouts - Task wird neugestartet!");
                     timeoutCounter = 0;
                     // Kurze Pause für System-Recovery
                     vTaskDelay(pdMS_TO_TICKS(500));
                 }
             }
             
-            lastUpdate = currentTime;
+            animFrame = targetFrame;
+        }
+        
+        // Health-Meldung je Durchlauf, nicht je Frame - bei leerem Akku
+        // bleiben die LEDs aus, der Task läuft trotzdem
+        if (ledMutexOk) {
+            otaHealthReport(OTA_HEALTH_LEDS);
         }
         
         // KRITISCH: Mindest-Delay von 10ms für Watchdog-Stabilität
@@ -374,10 +416,9 @@ void rainbow() {
     static uint8_t hue = 0;
     
     // KRITISCH: Reset-Mechanismus gegen Überlauf (wie bei anderen Effekten)
-    static unsigned long lastReset = 0;
-    if (millis() - lastReset > 60000) { // Reset alle 60 Sekunden
+    static uint32_t lastCycle = UINT32_MAX;
+    if (animationCycleStarted(lastCycle, 60000)) { // Reset alle 60 Sekunden (gemeinsame Zeit)
         hue = 0;
-        lastReset = millis();
     }
     
     fill_rainbow(mainLeds, NUM_MAIN_LEDS, hue, 7);
@@ -389,10 +430,9 @@ void rainbowWave() {
     static uint8_t hue = 0;
     
     // KRITISCH: Reset-Mechanismus gegen Überlauf
-    static unsigned long lastReset = 0;
-    if (millis() - lastReset > 60000) { // Reset alle 60 Sekunden
+    static uint32_t lastCycle = UINT32_MAX;
+    if (animationCycleStarted(lastCycle, 60000)) { // Reset alle 60 Sekunden (gemeinsame Zeit)
         hue = 0;
-        lastReset = millis();
     }
     
     for(int i = 0; i < NUM_MAIN_LEDS; i++) {
@@ -407,11 +447,10 @@ void colorWipe() {
     static bool direction = true;
     
     // KRITISCH: Reset-Mechanismus gegen Überlauf
-    static unsigned long lastReset = 0;
-    if (millis() - lastReset > 45000) { // Reset alle 45 Sekunden
+    static uint32_t lastCycle = UINT32_MAX;
+    if (animationCycleStarted(lastCycle, 45000)) { // Reset alle 45 Sekunden (gemeinsame Zeit)
         pos = 0;
         direction = true;
-        lastReset = millis();
     }
     
     for(int i = 0; i < NUM_MAIN_LEDS; i++) {
@@ -434,10 +473,9 @@ void theaterChase() {
     static uint8_t offset = 0;
     
     // KRITISCH: Reset-Mechanismus gegen Überlauf
-    static unsigned long lastReset = 0;
-    if (millis() - lastReset > 30000) { // Reset alle 30 Sekunden
+    static uint32_t lastCycle = UINT32_MAX;
+    if (animationCycleStarted(lastCycle, 30000)) { // Reset alle 30 Sekunden (gemeinsame Zeit)
         offset = 0;
-        lastReset = millis();
     }
     
     for(int i = 0; i < NUM_MAIN_LEDS; i++) {
@@ -477,12 +515,11 @@ void pulse() {
     static bool useSecondary = false;
     
     // KRITISCH: Reset-Mechanismus gegen Überlauf
-    static unsigned long lastReset = 0;
-    if (millis() - lastReset > 35000) { // Reset alle 35 Sekunden
+    static uint32_t lastCycle = UINT32_MAX;
+    if (animationCycleStarted(lastCycle, 35000)) { // Reset alle 35 Sekunden (gemeinsame Zeit)
         brightness = 0;
         direction = 1;
         useSecondary = false;
-        lastReset = millis();
     }
     
     brightness += direction * 3;
@@ -499,7 +536,7 @@ void pulse() {
 
 void wave() {
     for(int i = 0; i < NUM_MAIN_LEDS; i++) {
-        uint8_t brightness = beatsin8(10, 50, 255, 0, i * 10);
+        uint8_t brightness = syncedBeatsin8(10, 50, 255, i * 10);
         uint8_t hue = map(i, 0, NUM_MAIN_LEDS-1, primaryHue, secondaryHue);
         mainLeds[i] = CHSV(hue, 255, brightness);
     }
@@ -525,8 +562,8 @@ void gradient() {
 void dots() {
     fadeToBlackBy(mainLeds, NUM_MAIN_LEDS, 20);
     
-    int pos1 = beatsin16(13, 0, NUM_MAIN_LEDS - 1);
-    int pos2 = beatsin16(17, 0, NUM_MAIN_LEDS - 1);
+    int pos1 = syncedBeatsin16(13, 0, NUM_MAIN_LEDS - 1);
+    int pos2 = syncedBeatsin16(17, 0, NUM_MAIN_LEDS - 1);
     
     // KRITISCH: Direkte Zuweisung statt += um Überläufe zu vermeiden (wie bei confetti)
     // += kann bei bereits hellen LEDs zu Überläufen führen
@@ -554,11 +591,10 @@ void comet() {
     static bool useSecondary = false;
     
     // KRITISCH: Reset-Mechanismus gegen Überlauf
-    static unsigned long lastReset = 0;
-    if (millis() - lastReset > 40000) { // Reset alle 40 Sekunden
+    static uint32_t lastCycle = UINT32_MAX;
+    if (animationCycleStarted(lastCycle, 40000)) { // Reset alle 40 Sekunden (gemeinsame Zeit)
         pos = 0;
         useSecondary = false;
-        lastReset = millis();
     }
     
     uint8_t hue = useSecondary ? secondaryHue : primaryHue;
@@ -577,12 +613,11 @@ void bounce() {
     static bool useSecondary = false;
     
     // KRITISCH: Reset-Mechanismus gegen Überlauf
-    static unsigned long lastReset = 0;
-    if (millis() - lastReset > 35000) { // Reset alle 35 Sekunden
+    static uint32_t lastCycle = UINT32_MAX;
+    if (animationCycleStarted(lastCycle, 35000)) { // Reset alle 35 Sekunden (gemeinsame Zeit)
         pos = 0;
         direction = 1;
         useSecondary = false;
-        lastReset = millis();
     }
     
     fadeToBlackBy(mainLeds, NUM_MAIN_LEDS, 20);
@@ -612,13 +647,12 @@ void fireworks() {
     } sparks[5] = {0};
     
     // KRITISCH: Bounds-Checking für Array-Zugriffe
-    static unsigned long lastReset = 0;
-    if (millis() - lastReset > 60000) { // Reset alle 60 Sekunden
+    static uint32_t lastCycle = UINT32_MAX;
+    if (animationCycleStarted(lastCycle, 60000)) { // Reset alle 60 Sekunden (gemeinsame Zeit)
         for(int i = 0; i < 5; i++) {
             sparks[i].active = false;
             sparks[i].brightness = 0;
         }
-        lastReset = millis();
     }
     
     fadeToBlackBy(mainLeds, NUM_MAIN_LEDS, 30);
@@ -648,12 +682,11 @@ void lightning() {
     static uint16_t nextFlashTime = 0;
     
     // KRITISCH: Reset-Mechanismus gegen Überlauf
-    static unsigned long lastReset = 0;
-    if (millis() - lastReset > 30000) { // Reset alle 30 Sekunden
+    static uint32_t lastCycle = UINT32_MAX;
+    if (animationCycleStarted(lastCycle, 30000)) { // Reset alle 30 Sekunden (gemeinsame Zeit)
         flashCounter = 0;
         flashBrightness = 0;
         nextFlashTime = 0;
-        lastReset = millis();
     }
     
     if (flashCounter > 0) {
@@ -685,8 +718,8 @@ void lightning() {
 
 void confetti() {
     // KRITISCH: Rate-Limiting für Konfetti um FastLED-Überlastung zu vermeiden
-    static unsigned long lastConfettiUpdate = 0;
-    unsigned long currentTime = millis();
+    static uint32_t lastConfettiUpdate = 0;
+    uint32_t currentTime = animTimeMs;
     
     // Mindestens 5ms zwischen Konfetti-Updates (200 FPS Maximum)
     if (currentTime - lastConfettiUpdate < 5) {
@@ -720,12 +753,11 @@ void breathe() {
     static bool useSecondary = false;
     
     // KRITISCH: Reset-Mechanismus gegen Überlauf
-    static unsigned long lastReset = 0;
-    if (millis() - lastReset > 40000) { // Reset alle 40 Sekunden
+    static uint32_t lastCycle = UINT32_MAX;
+    if (animationCycleStarted(lastCycle, 40000)) { // Reset alle 40 Sekunden (gemeinsame Zeit)
         brightness = 0;
         direction = 1;
         useSecondary = false;
-        lastReset = millis();
     }
     
     brightness += direction * 1;
@@ -748,13 +780,12 @@ void rain() {
     static bool dropColors[10] = {false};
     
     // KRITISCH: Reset-Mechanismus gegen Array-Überlauf
-    static unsigned long lastReset = 0;
-    if (millis() - lastReset > 45000) { // Reset alle 45 Sekunden
+    static uint32_t lastCycle = UINT32_MAX;
+    if (animationCycleStarted(lastCycle, 45000)) { // Reset alle 45 Sekunden (gemeinsame Zeit)
         for(int i = 0; i < 10; i++) {
             drops[i] = 0;
             dropColors[i] = false;
         }
-        lastReset = millis();
     }
     
     for (int i = 0; i < 10; i++) {
@@ -780,13 +811,12 @@ void matrix() {
     static uint8_t dropBrightness[8] = {0};
     
     // KRITISCH: Reset-Mechanismus gegen Array-Überlauf
-    static unsigned long lastReset = 0;
-    if (millis() - lastReset > 40000) { // Reset alle 40 Sekunden
+    static uint32_t lastCycle = UINT32_MAX;
+    if (animationCycleStarted(lastCycle, 40000)) { // Reset alle 40 Sekunden (gemeinsame Zeit)
         for(int i = 0; i < 8; i++) {
             drops[i] = 0;
             dropBrightness[i] = 0;
         }
-        lastReset = millis();
     }
     
     for (int i = 0; i < 8; i++) {
@@ -825,7 +855,7 @@ void orbit() {
         int orbitRadius = 5 + i * 3;
         int speed = 5 + i;
         
-        float angle = (millis() / (100.0 / speed)) * PI / 180.0;
+        float angle = (animTimeMs / (100.0 / speed)) * PI / 180.0;
         if (i % 2 == 1) angle = -angle;
         
         int xOffset = orbitRadius * sin(angle);
@@ -840,7 +870,7 @@ void orbit() {
 
 void spiral() {
     for(int i = 0; i < NUM_MAIN_LEDS; i++) {
-        int timeFactor = millis() / 50;
+        int timeFactor = animTimeMs / 50;
         int posFactor = i * 7;
         int combinedFactor = (timeFactor + posFactor) % 256;
         
@@ -862,15 +892,14 @@ void meteor() {
     } meteors[3] = {0};
     
     // KRITISCH: Reset-Mechanismus gegen Array-Überlauf
-    static unsigned long lastReset = 0;
-    if (millis() - lastReset > 50000) { // Reset alle 50 Sekunden
+    static uint32_t lastCycle = UINT32_MAX;
+    if (animationCycleStarted(lastCycle, 50000)) { // Reset alle 50 Sekunden (gemeinsame Zeit)
         for(int i = 0; i < 3; i++) {
             meteors[i].active = false;
             meteors[i].pos = 0;
             meteors[i].speed = 0;
             meteors[i].length = 0;
         }
-        lastReset = millis();
     }
     
     for (int i = 0; i < 3; i++) {
@@ -905,10 +934,9 @@ void colorSpin() {
     static uint8_t pos = 0;
     
     // KRITISCH: Reset-Mechanismus gegen Überlauf
-    static unsigned long lastReset = 0;
-    if (millis() - lastReset > 35000) { // Reset alle 35 Sekunden
+    static uint32_t lastCycle = UINT32_MAX;
+    if (animationCycleStarted(lastCycle, 35000)) { // Reset alle 35 Sekunden (gemeinsame Zeit)
         pos = 0;
-        lastReset = millis();
     }
     
     int blockLength = NUM_MAIN_LEDS / 4;
@@ -1034,456 +1062,79 @@ void checkSaoButton() {
     lastButtonState = currentButtonState;
 }
 
-// OTA Funktionen
-void connectToWiFi() {
-    if (!wifiConnectEnabled) {
-        Serial.println("WiFi-Verbindung ist deaktiviert");
-        return;
-    }
-    
-    Serial.println("🌐 Verbinde mit WiFi...");
-    Serial.printf("🌐 SSID: '%s'\n", wifiSSID.c_str());
-    Serial.printf("🌐 Passwort: %s\n", wifiPassword.length() > 0 ? "[GESETZT]" : "[LEER]");
-    
-    // WiFi Mode sicher setzen
-    WiFi.mode(WIFI_STA);
-    delay(100); // Kurze Verzögerung nach Mode-Wechsel
-    
-    // Alte Verbindung trennen falls vorhanden
-    WiFi.disconnect(false);
-    delay(100);
-    
-    // Neue Verbindung starten
-    WiFi.begin(wifiSSID.c_str(), wifiPassword.c_str());
-    
-    Serial.print("🌐 Verbinde mit WLAN");
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 25) { // Erhöhte Versuche: 25 statt 20
-        delay(500);
-        Serial.print(".");
-        attempts++;
-        
-        // Debug: WiFi Status während Verbindungsversuch
-        if (attempts % 5 == 0) {
-            Serial.printf("\n🌐 Verbindungsversuch %d/25, Status: %d\n", attempts, WiFi.status());
-        }
-    }
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println();
-        Serial.printf("✅ ERFOLGREICH verbunden mit: '%s'\n", WiFi.SSID().c_str());
-        Serial.printf("✅ IP-Adresse: %s\n", WiFi.localIP().toString().c_str());
-        Serial.printf("✅ Signal-Stärke: %d dBm\n", WiFi.RSSI());
-        
-        // mDNS starten für badge.local
-        if (MDNS.begin("badge")) {
-            Serial.println("✅ mDNS gestartet! Badge erreichbar unter: badge.local");
-        } else {
-            Serial.println("⚠️ Warnung: mDNS konnte nicht gestartet werden");
+// Rote Status-LEDs für ein fehlgeschlagenes Update
+void showStatusLedError() {
+    if (xSemaphoreTake(statusLedMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        for (int i = 0; i < NUM_STATUS_LEDS; i++) {
+            statusLeds[i] = CRGB::Red;
         }
-    } else {
-        Serial.println();
-        Serial.printf("❌ WiFi-Verbindung FEHLGESCHLAGEN nach %d Versuchen\n", attempts);
-        Serial.printf("❌ Letzter WiFi Status: %d\n", WiFi.status());
-        Serial.printf("❌ Überprüfe SSID: '%s' und Passwort\n", wifiSSID.c_str());
+        FastLED[1].showLeds(STATUS_LED_BRIGHTNESS);
+        xSemaphoreGive(statusLedMutex);
     }
 }
 
-void performOTACheckin() {
-    if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("Keine WiFi-Verbindung für OTA-Checkin");
-        return;
-    }
-    
-    HTTPClient http;
-    http.begin(otaCheckinUrl);
-    http.addHeader("Content-Type", "application/json");
-    
-    String json = "{\"id\":\"" + String(deviceID) + "\",\"version\":\"" + dynamicVersion + "\",\"hardware_type\":\"" + String(hardwaretype) + "\",\"ssid\":\"" + WiFi.SSID() + "\"}";
-    Serial.println("=== OTA CHECKIN DEBUG ===");
-    Serial.printf("Device ID: %s\n", deviceID.c_str());
-    Serial.printf("Firmware Version (fest): %s\n", firmwareVersion);
-    Serial.printf("Dynamic Version (wird gesendet): '%s'\n", dynamicVersion.c_str());
-    Serial.printf("Settings Dynamic Version: '%s'\n", settings.dynamicVersion.c_str());
-    Serial.printf("Hardware Type: %s\n", hardwaretype);
-    Serial.println("JSON-Payload:");
-    Serial.println(json);
-    Serial.println("========================");
-    
-    int httpResponseCode = http.POST(json);
-    if (httpResponseCode > 0) {
-        String response = http.getString();
-        Serial.printf("Antwort [%d]: %s\n", httpResponseCode, response.c_str());
-        
-        // JSON-Antwort parsen
-        DynamicJsonDocument doc(1024);
-        DeserializationError error = deserializeJson(doc, response);
-        
-        if (!error) {
-            Serial.println("JSON erfolgreich geparst:");
-            serializeJsonPretty(doc, Serial);
-            Serial.println();
-            
-            // Prüfe auf Version-Update vom Server
-            if (doc.containsKey("set_version")) {
-                String newVersion = doc["set_version"].as<String>();
-                Serial.printf("=== VERSION UPDATE VOM SERVER ===\n");
-                Serial.printf("Alte Version: '%s'\n", dynamicVersion.c_str());
-                Serial.printf("Neue Version: '%s'\n", newVersion.c_str());
-                Serial.printf("Firmware Version (fest): '%s'\n", firmwareVersion);
-                
-                // Aktualisiere dynamische Version
-                dynamicVersion = newVersion;
-                settings.dynamicVersion = dynamicVersion;
-                
-                // Sofort speichern und mehrfach versuchen bei Fehlern
-                bool saved = false;
-                for (int i = 0; i < 3; i++) {
-                    saved = saveSettings();
-                    if (saved) break;
-                    delay(100);
-                }
-                Serial.printf("Settings gespeichert (Versuch %d): %s\n", saved ? 1 : 3, saved ? "ERFOLG" : "FEHLER");
-                
-                // Verification: Lade Settings neu und prüfe
-                delay(100); // Kurze Pause
-                if (loadSettings()) {
-                    Serial.printf("Verification: Geladene dynamicVersion = '%s'\n", settings.dynamicVersion.c_str());
-                    dynamicVersion = settings.dynamicVersion; // Sicherstellen, dass globale Variable korrekt ist
-                    Serial.printf("Verification: Globale dynamicVersion = '%s'\n", dynamicVersion.c_str());
-                    
-                    // Zusätzliche Prüfung
-                    if (dynamicVersion == newVersion) {
-                        Serial.println("✓ Version-Update erfolgreich!");
-                    } else {
-                        Serial.printf("✗ FEHLER: Version-Update fehlgeschlagen! Erwartet: '%s', Ist: '%s'\n", 
-                                    newVersion.c_str(), dynamicVersion.c_str());
-                    }
-                } else {
-                    Serial.println("FEHLER: Settings konnten nicht neu geladen werden!");
-                }
-                Serial.println("=== VERSION UPDATE ABGESCHLOSSEN ===");
-            }
-            
-            // Prüfe auf Update-Antwort
-            if (doc.containsKey("update") && doc["update"] == true) {
-                Serial.println("Update verfügbar - starte Download...");
-                startStatusLedUpdate(); // Status-LED Feedback starten
-                
-                if (doc.containsKey("url")) {
-                    String firmwareUrl = doc["url"].as<String>();
-                    Serial.println("Firmware-URL: " + firmwareUrl);
-                    updateFirmware(firmwareUrl);
-                } else {
-                    Serial.println("Fehler: URL nicht in Antwort gefunden");
-                }
-            } 
-            // Prüfe auf Reboot-Antwort
-            else if (doc.containsKey("reboot") && doc["reboot"] == true) {
-                Serial.println("Reboot-Befehl vom OTA Server empfangen!");
-                startStatusLedReboot(); // Status-LED Feedback starten
-                Serial.println("Starte Neustart in 2 Sekunden...");
-                
-                // Kurze Verzögerung für die Antwort
-                delay(2000);
-                ESP.restart();
-            } 
-            // Prüfe auf Lock-Antwort
-            else if (doc.containsKey("locked") && doc["locked"] == true) {
-                Serial.println("Gerät ist gesperrt - keine Updates möglich");
-                startStatusLedLock(); // Status-LED Feedback starten
-            }
-            // Prüfe auf Unlock-Antwort
-            else if (doc.containsKey("unlocked") && doc["unlocked"] == true) {
-                Serial.println("Gerät ist entsperrt - Updates wieder möglich");
-                startStatusLedUnlock(); // Status-LED Feedback starten
-            }
-            else {
-                Serial.println("Kein Update verfügbar");
-            }
-        } else {
-            Serial.print("JSON-Parsing fehlgeschlagen: ");
-            Serial.println(error.c_str());
-            
-            // Fallback: String-basierte Suche
-            if (response.indexOf("\"update\":true") != -1) {
-                Serial.println("Update verfügbar (Fallback) - starte Download...");
-                
-                // Extrahiere die Firmware-URL aus der Antwort
-                int urlStart = response.indexOf("\"url\":\"");
-                if (urlStart != -1) {
-                    urlStart += 7; // Länge von "url":"
-                    int urlEnd = response.indexOf("\"", urlStart);
-                    if (urlEnd != -1) {
-                        String firmwareUrl = response.substring(urlStart, urlEnd);
-                        Serial.println("Firmware-URL: " + firmwareUrl);
-                        updateFirmware(firmwareUrl);
-                    }
-                }
-            } else if (response.indexOf("\"reboot\":true") != -1) {
-                Serial.println("Reboot-Befehl empfangen (Fallback)!");
-                Serial.println("Starte Neustart in 2 Sekunden...");
-                delay(2000);
-                ESP.restart();
-            } else {
-                Serial.println("Kein Update verfügbar");
-            }
-        }
-    } else {
-        Serial.printf("Fehler bei HTTP POST: %s\n", http.errorToString(httpResponseCode).c_str());
-    }
-    
-    http.end();
-}
+// ---------------------------------------------------------------------------
+// Boot-Stufen (Reihenfolge und Abhängigkeiten in setup())
+// ---------------------------------------------------------------------------
 
-void updateFirmware(String url) {
-    Serial.println("=== STARTE FIRMWARE UPDATE ===");
-    Serial.println("URL: " + url);
-    
-    // Prüfe ob es eine HTTPS-URL ist
-    bool isHttps = url.startsWith("https://");
-    
-    if (isHttps) {
-        Serial.println("HTTPS-Update wird nicht unterstützt. Verwende HTTP...");
-        // Konvertiere HTTPS zu HTTP
-        url = "http://" + url.substring(8);
-        Serial.println("Konvertierte URL: " + url);
+// LEDs mit dem gespeicherten Zustand aus dem NVS - läuft synchron als Erstes
+static bool bootStageLeds() {
+    if (!loadLedSnapshot()) {
+        Serial.println("Kein LED-Zustand im NVS, starte mit Standardwerten");
     }
-    
-    WiFiClient client;
-    HTTPClient http;
-    http.begin(client, url);
-    
-    // Timeout für den Download setzen
-    http.setTimeout(30000); // 30 Sekunden Timeout
-    
-    Serial.println("Starte Download...");
-    int httpCode = http.GET();
-    Serial.printf("HTTP Response Code: %d\n", httpCode);
-    
-    if (httpCode == 200) {
-        int contentLength = http.getSize();
-        Serial.printf("Firmware-Größe: %d bytes\n", contentLength);
-        
-        if (contentLength <= 0) {
-            Serial.println("Fehler: Ungültige Firmware-Größe");
-            http.end();
-            return;
-        }
-        
-        // Prüfe ob genug Speicher verfügbar ist (ESP32-S3 mit 8MB Flash)
-        if (contentLength > 0x400000) { // 4MB Limit (sehr großzügig für ESP32-S3)
-            Serial.printf("Fehler: Firmware zu groß (%d bytes, Limit: %d bytes)\n", contentLength, 0x400000);
-            http.end();
-            return;
-        }
-        
-        Serial.printf("Firmware-Größe OK: %d bytes (Limit: %d bytes)\n", contentLength, 0x400000);
-        
-        Serial.printf("Freier Heap vor Update: %d bytes\n", ESP.getFreeHeap());
-        
-        // Zusätzliche Debug-Informationen
-        Serial.printf("Update-Partition verfügbar: %s\n", Update.canRollBack() ? "Ja" : "Nein");
-        Serial.printf("Verfügbarer Update-Speicher: %d bytes\n", ESP.getFreeSketchSpace());
-        
-        bool canBegin = Update.begin(contentLength);
-        Serial.printf("Update.begin() Ergebnis: %s\n", canBegin ? "ERFOLG" : "FEHLGESCHLAGEN");
-        
-        if (!canBegin) {
-            Serial.printf("Update.begin() Fehler-Code: %d\n", Update.getError());
-            Serial.printf("Update.begin() Fehler-String: %s\n", Update.errorString());
-        }
-        
-        if (canBegin) {
-            Serial.println("Update beginnt...");
-            Serial.printf("Update-Rückgabewert vor Stream: %d\n", Update.getError());
-            
-            // Stream-basiertes Update mit Fortschrittsanzeige
-            WiFiClient *stream = http.getStreamPtr();
-            size_t written = 0;
-            uint8_t buffer[1024];
-            
-            while (http.connected() && (written < contentLength)) {
-                size_t available = stream->available();
-                if (available) {
-                    size_t readBytes = stream->readBytes(buffer, min(available, sizeof(buffer)));
-                    size_t writtenNow = Update.write(buffer, readBytes);
-                    written += writtenNow;
-                    
-                    // Fortschritt alle 10KB anzeigen
-                    if (written % 10240 == 0 || written == contentLength) {
-                        Serial.printf("Fortschritt: %d/%d bytes (%.1f%%)\n", 
-                                    written, contentLength, (written * 100.0) / contentLength);
-                    }
-                    
-                    if (writtenNow != readBytes) {
-                        Serial.printf("FEHLER: Nur %d von %d Bytes geschrieben!\n", writtenNow, readBytes);
-                        break;
-                    }
-                } else {
-                    delay(1);
-                }
-            }
-            
-            Serial.printf("Stream-Update abgeschlossen: %d von %d bytes\n", written, contentLength);
-            
-            if (written == contentLength) {
-                Serial.println("Alle Bytes geschrieben, finalisiere Update...");
-                Serial.printf("Update-Status vor end(): Fehler=%d\n", Update.getError());
-                
-                bool endResult = Update.end();
-                bool isFinished = Update.isFinished();
-                Serial.printf("Update.end(): %s, Update.isFinished(): %s\n", 
-                            endResult ? "ERFOLG" : "FEHLGESCHLAGEN",
-                            isFinished ? "ERFOLG" : "FEHLGESCHLAGEN");
-                
-                if (!endResult) {
-                    Serial.printf("Update.end() Fehler-Code: %d\n", Update.getError());
-                    Serial.printf("Update.end() Fehler-String: %s\n", Update.errorString());
-                }
-                
-                if (endResult && isFinished) {
-                    Serial.println("=== UPDATE ERFOLGREICH ===");
-                    
-                    // WICHTIG: Nach erfolgreichem Update wird die neue Firmware gestartet
-                    // Die dynamicVersion wird automatisch auf die neue firmwareVersion gesetzt
-                    // beim nächsten Start in setup()
-                    
-                    startStatusLedUpdate(); // Status-LED Feedback für erfolgreiches Update
-                    delay(2000); // Länger warten für LED-Feedback
-                    Serial.println("Starte Neustart...");
-                    ESP.restart();
-                } else {
-                    Serial.println("Update fehlgeschlagen beim Finalisieren.");
-                    Serial.print("Update-Fehler: ");
-                    Serial.println(Update.errorString());
-                    Serial.printf("Update-Rückgabewert: %d\n", Update.getError());
-                    
-                    // Rote LED für fehlgeschlagenes Update
-                    if (xSemaphoreTake(statusLedMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                        for (int i = 0; i < NUM_STATUS_LEDS; i++) {
-                            statusLeds[i] = CRGB::Red;
-                        }
-                        FastLED[1].showLeds(STATUS_LED_BRIGHTNESS);
-                        xSemaphoreGive(statusLedMutex);
-                    }
-                }
-            } else {
-                Serial.printf("Fehler: Nur %d von %d Bytes geschrieben\n", written, contentLength);
-                Serial.printf("Update-Fehler beim Schreiben: %d\n", Update.getError());
-                Serial.printf("Update-Fehler-String: %s\n", Update.errorString());
-                Update.abort();
-                
-                // Rote LED für fehlgeschlagenes Update
-                if (xSemaphoreTake(statusLedMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                    for (int i = 0; i < NUM_STATUS_LEDS; i++) {
-                        statusLeds[i] = CRGB::Red;
-                    }
-                    FastLED[1].showLeds(STATUS_LED_BRIGHTNESS);
-                    xSemaphoreGive(statusLedMutex);
-                }
-            }
-        } else {
-            Serial.println("Update konnte nicht gestartet werden");
-            Serial.print("Update-Fehler: ");
-            Serial.println(Update.errorString());
-            Serial.printf("Update-Rückgabewert: %d\n", Update.getError());
-        }
-    } else {
-        Serial.printf("HTTP-Fehler beim Download: %d\n", httpCode);
-        Serial.printf("Fehler-String: %s\n", http.errorToString(httpCode).c_str());
-    }
-    
-    Serial.println("=== UPDATE BEENDET ===");
-    http.end();
-}
 
-void checkForOTAUpdate() {
-    if (!wifiConnectEnabled || !settings.otaEnabled) {
-        Serial.println("OTA-Updates deaktiviert (WiFi: " + String(wifiConnectEnabled) + ", OTA: " + String(settings.otaEnabled) + ")");
-        return;
-    }
-    
-    // Prüfe WiFi-Verbindung und versuche Wiederverbindung bei Bedarf
-    if (WiFi.status() != WL_CONNECTED) {
-        Serial.println("WLAN getrennt – versuche erneut zu verbinden...");
-        WiFi.reconnect();
-        delay(2000); // Warte auf Verbindung
-        
-        if (WiFi.status() != WL_CONNECTED) {
-            Serial.println("Wiederverbindung fehlgeschlagen");
-            return;
-        }
-    }
-    
-    // Führe OTA-Checkin durch
-    performOTACheckin();
-}
+    pinMode(LIGHT_EN, OUTPUT);
+    digitalWrite(LIGHT_EN, HIGH);
 
-void setup() {
-    // Serial für Debugging
-    Serial.begin(115200);
-    delay(50); // Kurze Verzögerung für die Stabilisierung der seriellen Verbindung
-    Serial.println("Starte LED Badge...");
-    
-    // Startzeit speichern
-    startupTime = millis();
-    
-    // MAC-Adresse als Device-ID setzen
-    String macAddress = WiFi.macAddress();
-    deviceID = "Badge-" + macAddress.substring(12, 17); // Letzte 5 Zeichen der MAC
-    Serial.println("Device-ID: " + deviceID);
-    
-    // Watchdog-Timer auf längere Zeit setzen für mehr Stabilität
-    Serial.println("Konfiguriere Watchdog...");
-    // Hinweis: esp_task_wdt_init ist nicht verfügbar, wir nutzen stattdessen 
-    // die Stabilisierungsverzögerungen an kritischen Stellen
-    
-    // WiFi initialisieren
-    Serial.println("WiFi initialisieren...");
-    WiFi.persistent(false);  // Verhindert häufiges Schreiben in den Flash
+    ledMutex = xSemaphoreCreateMutex();
+    statusLedMutex = xSemaphoreCreateMutex();
     
-    // WiFi-Modus basierend auf Konfiguration setzen
-    if (wifiConnectEnabled) {
-        WiFi.mode(WIFI_STA);  // Nur Station-Modus (Client) für Test
-    } else {
-        WiFi.mode(WIFI_AP);      // Nur Access Point Modus
-    }
+    // Alle LEDs zuerst auf schwarz/aus setzen
+    fill_solid(mainLeds, NUM_MAIN_LEDS, CRGB::Black);
+    fill_solid(statusLeds, NUM_STATUS_LEDS, CRGB::Black);
     
-    WiFi.setAutoReconnect(true);  // Auto-Reconnect aktivieren für bessere Station Mode Verbindung
+    // LED-Streifen initialisieren - separate Controller für Main und Status LEDs
+    FastLED.addLeds<LED_TYPE, MAIN_LED_PIN, COLOR_ORDER>(mainLeds, NUM_MAIN_LEDS);
+    FastLED.addLeds<LED_TYPE, STATUS_LED_PIN, COLOR_ORDER>(statusLeds, NUM_STATUS_LEDS);
+    FastLED[0].showLeds(BRIGHTNESS);
+    FastLED[1].showLeds(STATUS_LED_BRIGHTNESS);
     
-    // BQ25895 initialisieren
-    Serial.println("BQ25895 initialisieren...");
-    ensureChargerInitialized();
+    // Sicherstellen, dass alle Button-LED-Indikatoren ausgeschaltet sind
+    modeLedActive = false;
+    colorLedActive = false;
+    brightLedActive = false;
+    saoLedActive = false;
     
-    try {
-        // Ladegerät initialisieren
-        if (charger != nullptr) {
-            charger->begin();
-            delay(50);
-            Serial.println("BQ25895 initialisiert.");
-        } else {
-            Serial.println("BQ25895 nicht verfügbar!");
-        }
-    } catch (...) {
-        Serial.println("Fehler bei der BQ25895-Initialisierung, aber fortfahren...");
-    }
+    // Boot Button als Input mit Pullup, weitere Buttons ohne
+    pinMode(BOOT_BUTTON_PIN, INPUT_PULLUP);
+    pinMode(MODE_BUTTON, INPUT);
+    pinMode(COLOR_BUTTON, INPUT);
+    pinMode(BRIGHT_BUTTON, INPUT);
+    initSaoButton();
     
-    // SPIFFS initialisieren
-    Serial.println("SPIFFS initialisieren...");
-    if (!SPIFFS.begin(true)) {
+    xTaskCreate(ledTask, "LEDTask", 8192, NULL, 2, &ledTaskHandle);  // Mehr Speicher und höhere Priorität
+    xTaskCreate(statusLedTask, "StatusLEDTask", 4096, NULL, 1, &statusLedTaskHandle);
+    return ledTaskHandle != NULL;
+}
+
+// SPIFFS, Telemetrie-Verlauf und Einstellungen
+static bool bootStageStorage() {
+    bool mounted = SPIFFS.begin(true);
+    if (!mounted) {
         Serial.println("SPIFFS Mount Failed");
         // Trotzdem fortfahren
     }
 
-    // Einstellungen laden
-    Serial.println("Einstellungen laden...");
+    // Telemetrie-Ringpuffer vorbereiten (lädt den gespeicherten Verlauf aus dem SPIFFS)
+    initTelemetry();
+
     if (!loadSettings()) {
         Serial.println("Fehler beim Laden der Einstellungen");
         // Fortfahren mit Standard-Einstellungen
     }
 
-    // Globale Variablen aus Einstellungen setzen
+    // Globale Variablen aus Einstellungen setzen (die LEDs laufen schon mit
+    // dem NVS-Stand - normalerweise identisch)
     currentMode = settings.mode;
     brightness = settings.brightness;  // Verwende globale brightness
     BRIGHTNESS = settings.brightness;  // Behalte lokale BRIGHTNESS für Kompatibilität
@@ -1496,20 +1147,12 @@ void setup() {
     apName = settings.apName;
     apPassword = settings.apPassword;
     
-    // Debug: Geladene Werte ausgeben
-    Serial.printf("=== Geladene Settings ===\n");
-    Serial.printf("Mode: %d, Brightness: %d, Speed: %d\n", currentMode, brightness, animSpeed);
-    Serial.printf("PrimärHue: %d, SekundärHue: %d\n", primaryHue, secondaryHue);
-    Serial.printf("AP Name: %s\n", apName.c_str());
+    LOGI("BOOT", "Settings: Mode %d, Helligkeit %d, Tempo %d, Farben %d/%d, AP '%s'",
+         currentMode, brightness, animSpeed, primaryHue, secondaryHue, apName.c_str());
 
     // Dynamic Version initialisieren - IMMER auf aktuelle firmwareVersion setzen
     // Dies stellt sicher, dass nach einem neuen Upload die korrekte Version angezeigt wird
     String currentFirmwareVersion = String(firmwareVersion);
-    
-    Serial.printf("=== DYNAMIC VERSION INITIALISIERUNG ===\n");
-    Serial.printf("Firmware Version (fest): '%s'\n", firmwareVersion);
-    Serial.printf("Dynamic Version (alt): '%s'\n", settings.dynamicVersion.c_str());
-    
     if (settings.dynamicVersion != currentFirmwareVersion) {
         Serial.printf("Version-Mismatch erkannt! Aktualisiere dynamicVersion von '%s' auf '%s'\n", 
                       settings.dynamicVersion.c_str(), currentFirmwareVersion.c_str());
@@ -1517,142 +1160,121 @@ void setup() {
         dynamicVersion = currentFirmwareVersion;
         settings.dynamicVersion = dynamicVersion;
         saveSettings(); // Speichere die neue Version
-        Serial.printf("Dynamic Version aktualisiert auf: '%s'\n", dynamicVersion.c_str());
     } else {
         dynamicVersion = currentFirmwareVersion;
-        Serial.printf("Dynamic Version ist bereits korrekt: '%s'\n", dynamicVersion.c_str());
     }
     
     Serial.printf("OTA aktiviert: %s\n", settings.otaEnabled ? "Ja" : "Nein");
-    Serial.println("=========================================");
-    
-    // WiFi-Verbindung und OTA-Checkin (falls aktiviert)
-    if (wifiConnectEnabled) {
-        Serial.println("WiFi-Verbindung und OTA-Checkin...");
-        connectToWiFi();
-        
-        if (WiFi.status() == WL_CONNECTED) {
-            Serial.println("Führe OTA-Checkin durch...");
-            checkForOTAUpdate();
-        }
-    } else {
-        // Nur Access Point starten wenn WiFi-Verbindung deaktiviert ist
-        Serial.println("Starte WiFi Access Point...");
-        const char* password = apPassword.length() > 0 ? apPassword.c_str() : NULL;
-        if (WiFi.softAP(apName.c_str(), password)) {
-            Serial.print("Access Point gestartet: ");
-            Serial.println(apName);
-            wifiEnabled = true;
-            
-            // mDNS starten für badge.local
-            if (MDNS.begin("badge")) {
-                Serial.println("mDNS gestartet! Badge erreichbar unter: badge.local");
-            } else {
-                Serial.println("Fehler beim Starten von mDNS");
-            }
-        } else {
-            Serial.println("Fehler beim Starten des Access Points");
-        }
+    return mounted;
+}
+
+// BQ25895 - begin() wartet intern auf den I2C-Bus
+static bool bootStageCharger() {
+    ensureChargerInitialized();
+    if (charger == nullptr) {
+        Serial.println("BQ25895 nicht verfügbar!");
+        return false;
     }
+    charger->begin();
+    Serial.println("BQ25895 initialisiert.");
+    return true;
+}
 
-    // Mutex erstellen
-    Serial.println("Mutex erstellen...");
-    ledMutex = xSemaphoreCreateMutex();
-    statusLedMutex = xSemaphoreCreateMutex();
-    
-    // Alle LEDs zuerst auf schwarz/aus setzen
-    Serial.println("LEDs initialisieren...");
-    fill_solid(mainLeds, NUM_MAIN_LEDS, CRGB::Black);
-    fill_solid(statusLeds, NUM_STATUS_LEDS, CRGB::Black);
-    
-    // LED-Streifen initialisieren - separate Controller für Main und Status LEDs
-    Serial.println("FastLED initialisieren...");
-    FastLED.addLeds<LED_TYPE, MAIN_LED_PIN, COLOR_ORDER>(mainLeds, NUM_MAIN_LEDS);
-    FastLED.addLeds<LED_TYPE, STATUS_LED_PIN, COLOR_ORDER>(statusLeds, NUM_STATUS_LEDS);
-    
-    // Initialisiere beide Controller separat mit ihren eigenen Helligkeitswerten
-    FastLED[0].showLeds(BRIGHTNESS); // Hauptleds mit Benutzereinstellung
-    FastLED[1].showLeds(STATUS_LED_BRIGHTNESS); // Status LEDs mit fester Helligkeit
-    
-    // WiFi-Status setzen - ENTFERNT: Direkte LED-Manipulation
-    // statusLedTask() übernimmt die komplette STATUS LED Kontrolle!
-    if (wifiConnectEnabled && WiFi.status() == WL_CONNECTED) {
-        wifiEnabled = true;
-    } else {
-        wifiEnabled = false;
+// E-Ink-Display (zeigt Akku und Bilder, braucht daher Ladegerät und SPIFFS)
+static bool bootStageDisplay() {
+    if (!USE_DISPLAY) {
+        return true;
+    }
+    if (!checkDisplayAvailable()) {
+        Serial.println("E-Ink Display konnte nicht initialisiert werden!");
+        return false;
     }
     
-    // WiFi-Status merken
-    lastWifiStatus = wifiEnabled;
-    
-    // Sicherstellen, dass alle Button-LED-Indikatoren ausgeschaltet sind
-    modeLedActive = false;
-    colorLedActive = false;
-    brightLedActive = false;
-    saoLedActive = false;
+    // Nur Display initialisieren, aber kein Update durchführen
+    extern bool fullDisplayInitialized; // Zugriff auf die Variable in Display.cpp
+    fullDisplayInitialized = true; // Markiere, dass das Display initialisiert wurde
+    Serial.println("E-Ink Display initialisiert ohne Update - manuelles Update über WebUI nötig");
+    return true;
+}
+
+// Funkmodus setzen und Verbindung anstoßen - kehrt sofort zurück, die Stufe
+// CONNECT schließt der WiFiManager ab (verbunden oder Fallback-AP)
+static bool bootStageWifi() {
+    if (!wifiConnectEnabled) {
+        // WLAN-Client in den Einstellungen abgeschaltet: gewollt, kein Fehler.
+        // Den eigenen Access Point startet der WiFiManager (meldet Fehler selbst)
+        LOGI("BOOT", "WLAN-Client deaktiviert - nur Access Point");
+        wifiManagerStartAccessPoint();
+        return true;
+    }
+    wifiManagerStartClient();
+    return WiFi.getMode() != WIFI_OFF;
+}
+
+// Webserver und Gruppendienste (starten selbst, sobald ein Netzwerk da ist)
+static bool bootStageNetwork() {
+    bool ok = true;
+    try {
+        initWebServer();
+    } catch (...) {
+        Serial.println("Fehler bei WebUI-Initialisierung, überspringe...");
+        ok = false;
+    }
     
-    // Status LEDs mit eigener Helligkeit aktualisieren
-    FastLED[1].showLeds(STATUS_LED_BRIGHTNESS);
+    // UDP-Gruppensteuerung
+    initUdpControl();
     
-    // Status LED als Output konfigurieren
-    Serial.println("GPIOs initialisieren...");
-    pinMode(STATUS_LED_PIN, OUTPUT);
-    digitalWrite(STATUS_LED_PIN, LOW);  // Rot = WiFi aus
+    // Gemeinsame Animationszeit mit anderen Badges im Netz
+    initTimeSync();
     
-    // Boot Button als Input mit Pullup konfigurieren
-    pinMode(BOOT_BUTTON_PIN, INPUT_PULLUP);
+    // ESP-NOW-Mesh (schaltet das Funkmodul bei Bedarf selbst ein)
+    initEspNowMesh();
     
-    // Weitere Buttons als Input mit Pulldown konfigurieren
-    pinMode(MODE_BUTTON, INPUT);
-    pinMode(COLOR_BUTTON, INPUT);
-    pinMode(BRIGHT_BUTTON, INPUT);
-    pinMode(SAO_BUTTON, INPUT);
-    pinMode(LIGHT_EN, OUTPUT);
-    digitalWrite(LIGHT_EN, HIGH);
+    // OTA-Checkins im eigenen Task (wartet selbst auf das WLAN)
+    initOtaAgent();
+    return ok;
+}
 
+void setup() {
+    // Serial für Debugging
+    Serial.begin(115200);
+    Serial.println("Starte LED Badge...");
     
-    // Display initialisieren
-    Serial.println("Display initialisieren...");
-    if (USE_DISPLAY) {
-        // Prüfen, ob das Display verfügbar ist
-        if (checkDisplayAvailable()) {
-            Serial.println("E-Ink Display gefunden und initialisiert!");
-            
-            // Nur Display initialisieren, aber kein Update durchführen
-            extern bool fullDisplayInitialized; // Zugriff auf die Variable in Display.cpp
-            fullDisplayInitialized = true; // Markiere, dass das Display initialisiert wurde
-            Serial.println("E-Ink Display initialisiert ohne Update - manuelles Update über WebUI nötig");
-        } else {
-            Serial.println("E-Ink Display konnte nicht initialisiert werden!");
-        }
-    }
-    
-    // LED Task erstellen
-    Serial.println("LED Task erstellen...");
-    xTaskCreate(ledTask, "LEDTask", 8192, NULL, 2, &ledTaskHandle);  // Mehr Speicher und höhere Priorität
+    // Log-Drain-Task starten - ab hier blockieren LOGx()-Aufrufe nicht mehr
+    initLogging();
     
-    // Status LED Task erstellen
-    Serial.println("Status LED Task erstellen...");
-    xTaskCreate(statusLedTask, "StatusLEDTask", 4096, NULL, 1, &statusLedTaskHandle);
+    // Startzeit speichern
+    startupTime = millis();
+    bootBegin();
     
-    // Kleine Verzögerung, um LEDs zu initialisieren
-    delay(500);
-    Serial.println("LEDs aktiv");
+    // Neue Firmware? Dann erst nach gesundem Betrieb bestätigen, sonst Rollback
+    initOtaHealth();
     
-    // WebUI initialisieren
-    Serial.println("WebUI initialisieren...");
-    try {
-        // Versuche, den Webserver zu initialisieren, mit Fehlerbehandlung
-        initWebServer();
-        Serial.println("WebUI Initialisierung gestartet");
-    } catch (...) {
-        Serial.println("Fehler bei WebUI-Initialisierung, überspringe...");
-    }
+    // Zuerst Licht: LEDs mit dem zuletzt gespeicherten Zustand
+    bootRunStage(BOOT_STAGE_LEDS, "LEDS", bootStageLeds);
     
-    // SAO-Taster initialisieren
-    initSaoButton();
+    // MAC-Adresse als Device-ID setzen
+    String macAddress = WiFi.macAddress();
+    deviceID = "Badge-" + macAddress.substring(12, 17); // Letzte 5 Zeichen der MAC
+    Serial.println("Device-ID: " + deviceID);
     
-    Serial.println("Setup abgeschlossen");
+    // WiFi-Ereignisse vor dem ersten Funkstart registrieren
+    initWiFiManager();
+    
+    // Alles Weitere parallel im Hintergrund, jeweils nach seinen Abhängigkeiten
+    bootBeginStage(BOOT_STAGE_CONNECT, "CONNECT");  // schließt der WiFiManager ab
+    bootBeginStage(BOOT_STAGE_OTA, "OTA");          // schließt der OtaAgent mit dem ersten Checkin ab
+    bootStartStage(BOOT_STAGE_STORAGE, "STORAGE", bootStageStorage, 0, 6144);
+    bootStartStage(BOOT_STAGE_CHARGER, "CHARGER", bootStageCharger, 0, 3072);
+    bootStartStage(BOOT_STAGE_DISPLAY, "DISPLAY", bootStageDisplay,
+                   BOOT_BIT(BOOT_STAGE_STORAGE) | BOOT_BIT(BOOT_STAGE_CHARGER), 4096);
+    bootStartStage(BOOT_STAGE_WIFI, "WIFI", bootStageWifi,
+                   BOOT_BIT(BOOT_STAGE_STORAGE), 4096);
+    bootStartStage(BOOT_STAGE_NETWORK, "NETWORK", bootStageNetwork,
+                   BOOT_BIT(BOOT_STAGE_WIFI) | BOOT_BIT(BOOT_STAGE_CHARGER), 8192);
+    
+    LOGI("BOOT", "Setup abgeschlossen nach %lu ms - restliche Stufen laufen im Hintergrund",
+         (unsigned long)millis());
 }
 
 void loop() {
@@ -1661,7 +1283,8 @@ void loop() {
         static unsigned long lastButtonPress = 0;
         static bool buttonPressed = false;
         
-        if (digitalRead(BOOT_BUTTON_PIN) == LOW) {  // Button ist gedrückt (LOW wegen Pullup)
+        // WLAN erst umschalten, wenn die Boot-Stufe WIFI den Funk gestartet hat
+        if (bootStageDone(BOOT_STAGE_WIFI) && digitalRead(BOOT_BUTTON_PIN) == LOW) {  // Button ist gedrückt (LOW wegen Pullup)
             if (!buttonPressed) {
                 buttonPressed = true;
                 lastButtonPress = millis();
@@ -1673,20 +1296,31 @@ void loop() {
             buttonPressed = false;
         }
         
+        // WLAN: Verbindungsversuche, Backoff, Fallback-AP
+        wifiManagerTick();
+        
         // Weitere Buttons prüfen
         checkButtons();
         
-        // Ladegerät-Update mit Fehlerbehandlung
-        if (charger != nullptr) {
+        // Ladegerät-Update mit Fehlerbehandlung (erst nach Boot-Stufe CHARGER und STORAGE)
+        bool chargerReady = bootStageDone(BOOT_STAGE_CHARGER) && bootStageDone(BOOT_STAGE_STORAGE);
+        if (chargerReady && charger != nullptr) {
             try {
                 charger->updatePowerMode();
                 
+                // Telemetrie sampeln (einziger periodischer I2C-Leser für die Web-UI)
+                telemetryTick();
+                
                 // Entferne automatisches Akku-Display-Update
                 // Aktualisierung des Displays nur noch durch Tastendruck!
             } catch (...) {
                 // Fehler ignorieren
             }
         }
+        if (chargerReady) {
+            // Die Überwachung läuft - auch ohne Ladegerät-Chip, dann eben ohne Messwerte
+            otaHealthReport(OTA_HEALTH_CHARGER);
+        }
         
         // SAO-Taster abfragen
         checkSaoButton();
@@ -1694,15 +1328,20 @@ void loop() {
         // Status-LED-Feedback für OTA-Befehle aktualisieren
         updateStatusLedFeedback();
         
-        // KRITISCH: Batterie-Monitoring ausführen (war vorher nie aufgerufen!)
-        updateStatusLED();
+        if (bootStageDone(BOOT_STAGE_NETWORK)) {
+            // UDP-Steuerung: Neustart nach WiFi-Wechsel, gebündeltes Speichern
+            udpControlTick();
+            
+            // Zeit-Synchronisation: Beacons, Leaderwahl, Messungen
+            timeSyncTick();
+            
+            // ESP-NOW-Mesh: Start/Stop nach Einstellung und WiFi-Wechseln
+            espNowMeshTick();
+        }
         
-        // Periodische OTA-Prüfung (alle 60 Sekunden)
-        static unsigned long lastOTACheck = 0;
-        if (wifiConnectEnabled && settings.otaEnabled && (millis() - lastOTACheck > 60000)) { // 10 Sekunden
-            Serial.println("Führe periodische OTA-Prüfung durch...");
-            checkForOTAUpdate();
-            lastOTACheck = millis();
+        // KRITISCH: Batterie-Monitoring ausführen (war vorher nie aufgerufen!)
+        if (chargerReady) {
+            updateStatusLED();
         }
         
         // Loop läuft auf Core 1 und ist für den Webserver reserviert
@@ -1737,12 +1376,7 @@ void updateStatusLED() {
         if (validSamples > 0) {
             voltage /= validSamples; // Durchschnitt der gültigen Messungen
             
-            // Mit Debug-Output, um Spannungswerte zu sehen - alle 10 Sekunden
-            static unsigned long lastVoltageLog = 0;
-            if (millis() - lastVoltageLog > 10000) {
-                lastVoltageLog = millis();
-                Serial.printf("🔋 Batteriespannung: %.3fV (%d von %d Samples gültig)\n", voltage, validSamples, numSamples);
-            }
+            LOGV("BAT", "🔋 Batteriespannung: %.3fV (%d von %d Samples gültig)", voltage, validSamples, numSamples);
             
             // Deep Sleep prüfen - kritische Batterieschwelle erreicht
             if (voltage <= DEEP_SLEEP_THRESHOLD) {
@@ -1757,18 +1391,16 @@ void updateStatusLED() {
                     uint8_t chargeStatus = charger->readRegister(0x0B);
                     isCharging = (chargeStatus != 0xFF) && ((chargeStatus & 0xE0) != 0);
                     
-                    Serial.print("🔌 Ladestatus: VBUS = ");
-                    Serial.print(isVbusPresent ? "Ja" : "Nein");
-                    Serial.print(", Ladevorgang = ");
-                    Serial.println(isCharging ? "Ja" : "Nein");
+                    LOGD("BAT", "🔌 Ladestatus: VBUS = %s, Ladevorgang = %s",
+                         isVbusPresent ? "Ja" : "Nein", isCharging ? "Ja" : "Nein");
                 }
                 
                 // Wenn das Gerät NICHT am Ladegerät angeschlossen ist, dann Deep Sleep
                 if (!isVbusPresent && !isCharging) {
                     // Prüfen, ob das Gerät schon lange genug läuft, um Deep Sleep zu erlauben
                     if (millis() - startupTime < MIN_RUNTIME_BEFORE_SLEEP) {
-                        Serial.printf("⚠️ Niedriger Batteriestand erkannt, aber Gerät läuft erst seit %lu Sekunden. Warte noch bis 30 Sekunden.\n", 
-                                      (millis() - startupTime) / 1000);
+                        LOGD("BAT", "⚠️ Niedriger Batteriestand erkannt, aber Gerät läuft erst seit %lu Sekunden. Warte noch bis 30 Sekunden.",
+                             (millis() - startupTime) / 1000);
                         return;
                     }
                     
@@ -1801,7 +1433,7 @@ void updateStatusLED() {
                     // Nach dem Deep Sleep startet das Gerät neu
                 } else {
                     // Gerät ist am Ladegerät angeschlossen, kein Deep Sleep notwendig
-                    Serial.println("🔋 Niedriger Batteriestand, aber Gerät wird geladen - kein Deep Sleep nötig.");
+                    LOGD("BAT", "🔋 Niedriger Batteriestand, aber Gerät wird geladen - kein Deep Sleep nötig.");
                 }
             }
             
@@ -1809,33 +1441,31 @@ void updateStatusLED() {
             if (voltage <= BOOST_OFF_THRESHOLD) {
                 if (!isBoostDisabled) {
                     isBoostDisabled = true;
-                    Serial.println("⚠️ WARNUNG: Batteriestand unter " + String(BOOST_OFF_THRESHOLD) + "V! Schalte Boost IC ab...");
+                    LOGW("BAT", "⚠️ Batteriestand unter %.2fV! Schalte Boost IC ab (LIGHT_EN LOW)", BOOST_OFF_THRESHOLD);
                     digitalWrite(LIGHT_EN, LOW); // Boost IC abschalten
-                    Serial.printf("🔋 DEBUG: LIGHT_EN Pin auf LOW gesetzt (Boost IC AUS)\n");
                 }
             } else if (isBoostDisabled && voltage > BOOST_OFF_THRESHOLD + 0.1f) { // Hysterese von 0.1V
                 isBoostDisabled = false;
-                Serial.println("✅ Batteriestand wieder über " + String(BOOST_OFF_THRESHOLD + 0.1f) + "V. Boost IC wieder aktiviert.");
+                LOGI("BAT", "✅ Batteriestand wieder über %.2fV. Boost IC wieder aktiviert (LIGHT_EN HIGH)", BOOST_OFF_THRESHOLD + 0.1f);
                 digitalWrite(LIGHT_EN, HIGH); // Boost IC wieder einschalten
-                Serial.printf("🔋 DEBUG: LIGHT_EN Pin auf HIGH gesetzt (Boost IC AN)\n");
             }
             
             // KRITISCH: NUR die Flags setzen - die LED-Steuerung übernimmt statusLedTask()!
             // Batterie-Warnstufen aktualisieren (User-Anforderung: Orange bei 3.5V, Rot bei 3.3V)
             
-            // DEBUG: Aktueller Status vor Änderungen
-            Serial.printf("🔋 DEBUG: Spannung=%.3fV, isLowBattery=%s, isWarningBattery=%s, isBoostDisabled=%s\n", 
-                         voltage, isLowBattery?"JA":"NEIN", isWarningBattery?"JA":"NEIN", isBoostDisabled?"JA":"NEIN");
+            // Aktueller Status vor Änderungen (jeder Durchlauf, daher nur VERBOSE)
+            LOGV("BAT", "Spannung=%.3fV, isLowBattery=%s, isWarningBattery=%s, isBoostDisabled=%s",
+                 voltage, isLowBattery?"JA":"NEIN", isWarningBattery?"JA":"NEIN", isBoostDisabled?"JA":"NEIN");
             
             // Warnstufe (Orange bei 3.5V)
             if (voltage <= WARNING_BATTERY_THRESHOLD && voltage > LOW_BATTERY_THRESHOLD) {
                 if (!isWarningBattery) {
                     isWarningBattery = true;
-                    Serial.println("🟠 WARNUNG: Batterie-Warnstufe erreicht bei " + String(voltage) + "V (Schwelle: " + String(WARNING_BATTERY_THRESHOLD) + "V)");
+                    LOGW("BAT", "🟠 Batterie-Warnstufe erreicht bei %.2fV (Schwelle: %.2fV)", voltage, WARNING_BATTERY_THRESHOLD);
                 }
             } else if (isWarningBattery && voltage > WARNING_BATTERY_THRESHOLD + 0.1f) {
                 isWarningBattery = false;
-                Serial.println("✅ Batterie-Warnstufe verlassen: " + String(voltage) + "V");
+                LOGI("BAT", "✅ Batterie-Warnstufe verlassen: %.2fV", voltage);
             }
             
             // Kritische Stufe (Rot bei 3.3V) - VERBESSERTE ANTI-OSZILLATIONS-LOGIK
@@ -1844,8 +1474,7 @@ void updateStatusLED() {
                 if (!isLowBattery) {
                     isLowBattery = true;
                     isWarningBattery = false; // Warnstufe deaktivieren wenn kritisch erreicht
-                    Serial.println("🔴 KRITISCH: Batteriestand kritisch niedrig bei " + String(voltage) + "V (Schwelle: " + String(LOW_BATTERY_THRESHOLD) + "V)!");
-                    Serial.printf("🔴 DEBUG: isLowBattery wurde auf TRUE gesetzt! LEDs sollten ausgeschaltet werden.\n");
+                    LOGE("BAT", "🔴 Batteriestand kritisch niedrig bei %.2fV (Schwelle: %.2fV) - LEDs werden ausgeschaltet", voltage, LOW_BATTERY_THRESHOLD);
                     
                     // KRITISCH: NICHT hier die Main LEDs manipulieren!
                     // Das LED Task prüft isLowBattery Flag und schaltet LEDs selbst aus
@@ -1855,13 +1484,12 @@ void updateStatusLED() {
             } else if (isLowBattery && voltage > LOW_BATTERY_THRESHOLD + 0.2f) { // ERHÖHTE Hysterese von 0.2V statt 0.1V gegen Oszillation!
                 // Wenn Batterie wieder über kritische Schwelle + ERHÖHTE Hysterese (3.5V statt 3.4V)
                 // ZUSÄTZLICH: Nur zurücksetzen wenn Boost IC auch wieder aktiv ist (sonst Oszillation)
-                Serial.printf("🔴 DEBUG: Prüfe Reset-Bedingung: voltage=%.3fV > %.3fV, isBoostDisabled=%s\n", 
-                             voltage, LOW_BATTERY_THRESHOLD + 0.2f, isBoostDisabled?"JA":"NEIN");
+                LOGD("BAT", "Prüfe Reset-Bedingung: voltage=%.3fV > %.3fV, isBoostDisabled=%s",
+                     voltage, LOW_BATTERY_THRESHOLD + 0.2f, isBoostDisabled?"JA":"NEIN");
                 
                 if (!isBoostDisabled || voltage > BOOST_OFF_THRESHOLD + 0.2f) {
                     isLowBattery = false;
-                    Serial.println("✅ Batteriestand wieder über kritischer Schwelle mit erhöhter Hysterese: " + String(voltage) + "V");
-                    Serial.printf("🔴 DEBUG: isLowBattery wurde auf FALSE zurückgesetzt! LEDs sollten wieder eingeschaltet werden.\n");
+                    LOGI("BAT", "✅ Batteriestand wieder über kritischer Schwelle mit erhöhter Hysterese: %.2fV - LEDs wieder an", voltage);
                     
                     // KRITISCH: NICHT hier die Main LEDs manipulieren!
                     // Das LED Task prüft isLowBattery Flag und schaltet LEDs selbst an
@@ -1870,15 +1498,14 @@ void updateStatusLED() {
                     // Prüfe ob wir noch in der Warnstufe sind
                     if (voltage <= WARNING_BATTERY_THRESHOLD + 0.1f) {
                         isWarningBattery = true;
-                        Serial.println("🟠 Zurück in Batterie-Warnstufe");
+                        LOGW("BAT", "🟠 Zurück in Batterie-Warnstufe");
                     }
                 } else {
-                    Serial.printf("🔴 Batterie bei %.3fV über Low-Threshold, aber Boost IC noch deaktiviert - bleibe in Low-Battery Modus\n", voltage);
-                    Serial.printf("🔴 DEBUG: Reset-Bedingung NICHT erfüllt - isLowBattery bleibt TRUE\n");
+                    LOGD("BAT", "🔴 Batterie bei %.3fV über Low-Threshold, aber Boost IC noch deaktiviert - bleibe in Low-Battery Modus", voltage);
                 }
             }
         } else {
-            Serial.println("⚠️ WARNUNG: Keine gültigen Batteriespannungs-Messungen erhalten!");
+            LOGW("BAT", "⚠️ Keine gültigen Batteriespannungs-Messungen erhalten!");
         }
     }
     
@@ -1929,7 +1556,7 @@ void statusLedTask(void *parameter) {
         // Memory-Check alle 2 Minuten
         if (currentTime - lastMemoryCheck > 120000) {
             size_t freeHeap = ESP.getFreeHeap();
-            Serial.printf("Status-LED-Task: Freier Heap: %d bytes, Loops: %d\n", freeHeap, loopCounter);
+            LOGD("STATUS", "Freier Heap: %u bytes, Loops: %lu", (unsigned)freeHeap, (unsigned long)loopCounter);
             lastMemoryCheck = currentTime;
             loopCounter = 0; // Reset counter
         }
@@ -1946,8 +1573,8 @@ void statusLedTask(void *parameter) {
             static bool lastLowBatteryStatusTask = false;
             static bool lastWarningBatteryStatusTask = false;
             if (isLowBattery != lastLowBatteryStatusTask || isWarningBattery != lastWarningBatteryStatusTask) {
-                Serial.printf("🔴 STATUS-TASK DEBUG: isLowBattery=%s, isWarningBattery=%s\n", 
-                             isLowBattery?"JA":"NEIN", isWarningBattery?"JA":"NEIN");
+                LOGD("STATUS", "🔴 isLowBattery=%s, isWarningBattery=%s",
+                     isLowBattery?"JA":"NEIN", isWarningBattery?"JA":"NEIN");
                 lastLowBatteryStatusTask = isLowBattery;
                 lastWarningBatteryStatusTask = isWarningBattery;
             }
@@ -1961,7 +1588,7 @@ void statusLedTask(void *parameter) {
                 statusLed0Color = blinkState ? STATUS_RED : CRGB::Black;  // Rot blinkend
                 static unsigned long lastStatusRedLog = 0;
                 if (millis() - lastStatusRedLog > 2000) {
-                    Serial.println("STATUS LED: Batterie KRITISCH - Rot blinken");
+                    LOGV("STATUS", "Batterie KRITISCH - Rot blinken");
                     lastStatusRedLog = millis();
                 }
             } else if (isWarningBattery) {
@@ -1973,7 +1600,7 @@ void statusLedTask(void *parameter) {
                 statusLed0Color = blinkState ? STATUS_YELLOW : CRGB::Black;  // Orange/Gelb blinkend
                 static unsigned long lastStatusOrangeLog = 0;
                 if (millis() - lastStatusOrangeLog > 2000) {
-                    Serial.println("STATUS LED: Batterie WARNUNG - Orange blinken");
+                    LOGV("STATUS", "Batterie WARNUNG - Orange blinken");
                     lastStatusOrangeLog = millis();
                 }
             } else {
@@ -1985,10 +1612,10 @@ void statusLedTask(void *parameter) {
                 // DEBUG: WiFi-Status detailliert loggen
                 static unsigned long lastDetailedWifiLog = 0;
                 if (millis() - lastDetailedWifiLog > 3000) {
-                    Serial.printf("📡 WIFI DEBUG: Mode=%d, Status=%d, wifiEnabled=%s, wifiConnectEnabled=%s\n", 
-                                  WiFi.getMode(), WiFi.status(), wifiEnabled?"JA":"NEIN", wifiConnectEnabled?"JA":"NEIN");
-                    Serial.printf("📡 Conditions: isWifiClientConnected=%s, isWifiAPMode=%s, isWifiOff=%s\n",
-                                  isWifiClientConnected?"JA":"NEIN", isWifiAPMode?"JA":"NEIN", isWifiOff?"JA":"NEIN");
+                    LOGV("WIFI", "📡 Mode=%d, Status=%d, wifiEnabled=%s, wifiConnectEnabled=%s",
+                         WiFi.getMode(), WiFi.status(), wifiEnabled?"JA":"NEIN", wifiConnectEnabled?"JA":"NEIN");
+                    LOGV("WIFI", "📡 Conditions: isWifiClientConnected=%s, isWifiAPMode=%s, isWifiOff=%s",
+                         isWifiClientConnected?"JA":"NEIN", isWifiAPMode?"JA":"NEIN", isWifiOff?"JA":"NEIN");
                     lastDetailedWifiLog = millis();
                 }
                 
@@ -2006,7 +1633,7 @@ void statusLedTask(void *parameter) {
                     // DEBUG: WiFi Status loggen
                     static unsigned long lastWifiConnectedLog = 0;
                     if (millis() - lastWifiConnectedLog > 5000) {
-                        Serial.printf("🌐 WiFi Status: STATION MODE VERBUNDEN (IP: %s)\n", WiFi.localIP().toString().c_str());
+                        LOGV("WIFI", "🌐 STATION MODE VERBUNDEN (IP: %s)", WiFi.localIP().toString().c_str());
                         lastWifiConnectedLog = millis();
                     }
                     
@@ -2021,7 +1648,7 @@ void statusLedTask(void *parameter) {
                     // DEBUG: WiFi Status loggen
                     static unsigned long lastWifiAPLog = 0;
                     if (millis() - lastWifiAPLog > 5000) {
-                        Serial.printf("🌐 WiFi Status: AP MODE (Name: %s)\n", WiFi.softAPSSID().c_str());
+                        LOGV("WIFI", "🌐 AP MODE (Name: %s)", WiFi.softAPSSID().c_str());
                         lastWifiAPLog = millis();
                     }
                     
@@ -2036,7 +1663,7 @@ void statusLedTask(void *parameter) {
                     // DEBUG: WiFi Status loggen
                     static unsigned long lastWifiConnectingLog = 0;
                     if (millis() - lastWifiConnectingLog > 3000) {
-                        Serial.printf("🌐 WiFi Status: STATION MODE VERBINDET... (SSID: %s)\n", wifiSSID.c_str());
+                        LOGV("WIFI", "🌐 STATION MODE VERBINDET... (SSID: %s)", wifiSSID.c_str());
                         lastWifiConnectingLog = millis();
                     }
                     
@@ -2064,7 +1691,7 @@ void statusLedTask(void *parameter) {
                     // DEBUG: WiFi Status loggen
                     static unsigned long lastWifiOffLog = 0;
                     if (millis() - lastWifiOffLog > 5000) {
-                        Serial.println("🌐 WiFi Status: DEAKTIVIERT (Atem-Effekt)");
+                        LOGV("WIFI", "🌐 DEAKTIVIERT (Atem-Effekt)");
                         lastWifiOffLog = millis();
                     }
                 }
@@ -2076,11 +1703,11 @@ void statusLedTask(void *parameter) {
             // LED 1 (Index 1): Mode Button LED (LED2 in der Anforderung)
             if (modeLedActive && millis() < modeLedOffTime) {
                 statusLeds[1] = STATUS_WHITE;
-                Serial.println("Mode LED: AN (weiß)");
+                LOGV("STATUS", "Mode LED: AN (weiß)");
             } else {
                 statusLeds[1] = CRGB(0, 0, 0);  // Aus
                 if (modeLedActive) {
-                    Serial.println("Mode LED: AUS");
+                    LOGD("STATUS", "Mode LED: AUS");
                 }
                 modeLedActive = false;
             }
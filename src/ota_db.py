@@ -0,0 +1,297 @@
+# ota_db.py
+# SQLite-Datenbank des OTA-Servers (WAL-Modus): Geräte und Checkin-Verlauf.
+#
+# - devices: eine Zeile pro Gerät. Der komplette Geräte-Eintrag liegt als
+#   JSON in "data", last_seen/firmware/status zusätzlich als indizierte
+#   Spalten. Ein Checkin schreibt nur noch die eine Zeile.
+# - checkins: Verlauf, indiziert nach Zeit und Gerät. Checkins landen erst
+#   in einem Puffer und werden gesammelt in einer Transaktion geschrieben
+#   (alle CHECKIN_FLUSH_SECONDS oder ab CHECKIN_BATCH_SIZE Einträgen).
+#   Die id wächst mit der Zeit - sie ist Sortierung und Blätter-Cursor.
+# - checkins_fts: Volltext-Index (FTS5, Trigramme) über die Textspalten für
+#   die Suche im Dashboard, per Trigger mit checkins synchron
+# - Alte Checkins löscht der Schreib-Thread stündlich in Blöcken über den
+#   Zeit-Index (retention_days)
+#
+# Beim ersten Start werden devices.json und checkins.log übernommen und
+# danach in *.migrated umbenannt.
+
+import atexit
+import json
+import os
+import sqlite3
+import threading
+import time
+from datetime import datetime, timedelta
+
+SCHEMA_VERSION = 2
+CHECKIN_BATCH_SIZE = 200
+CHECKIN_FLUSH_SECONDS = 2.0
+RETENTION_INTERVAL_SECONDS = 3600
+RETENTION_CHUNK = 5000      # Zeilen pro Lösch-Transaktion - Checkins warten nie lange
+SEARCH_MIN_LENGTH = 3       # Kürzere Suchbegriffe kann der Trigramm-Index nicht
+
+SCHEMA = """
+CREATE TABLE IF NOT EXISTS devices (
+    id TEXT PRIMARY KEY,
+    data TEXT NOT NULL,
+    last_seen TEXT,
+    firmware TEXT,
+    status TEXT
+);
+CREATE INDEX IF NOT EXISTS devices_last_seen ON devices(last_seen);
+CREATE INDEX IF NOT EXISTS devices_firmware ON devices(firmware);
+
+CREATE TABLE IF NOT EXISTS checkins (
+    id INTEGER PRIMARY KEY,
+    ts TEXT NOT NULL,
+    device_id TEXT NOT NULL,
+    hardware_type TEXT,
+    ssid TEXT,
+    version TEXT,
+    wan_ip TEXT
+);
+CREATE INDEX IF NOT EXISTS checkins_ts ON checkins(ts);
+CREATE INDEX IF NOT EXISTS checkins_device ON checkins(device_id);
+
+CREATE TABLE IF NOT EXISTS meta (
+    key TEXT PRIMARY KEY,
+    value TEXT
+);
+"""
+
+# Der Geräte-Index enthält implizit die id: Abfragen pro Gerät kommen damit
+# schon in Cursor-Reihenfolge aus dem Index, ohne Sortieren
+SCHEMA_FTS = """
+CREATE VIRTUAL TABLE IF NOT EXISTS checkins_fts USING fts5(
+    device_id, hardware_type, ssid, version, wan_ip,
+    content='checkins', content_rowid='id', tokenize='trigram'
+);
+CREATE TRIGGER IF NOT EXISTS checkins_fts_insert AFTER INSERT ON checkins BEGIN
+    INSERT INTO checkins_fts (rowid, device_id, hardware_type, ssid, version, wan_ip)
+    VALUES (new.id, new.device_id, new.hardware_type, new.ssid, new.version, new.wan_ip);
+END;
+CREATE TRIGGER IF NOT EXISTS checkins_fts_delete AFTER DELETE ON checkins BEGIN
+    INSERT INTO checkins_fts (checkins_fts, rowid, device_id, hardware_type, ssid, version, wan_ip)
+    VALUES ('delete', old.id, old.device_id, old.hardware_type, old.ssid, old.version, old.wan_ip);
+END;
+"""
+
+CHECKIN_COLUMNS = "c.id, c.ts, c.device_id, c.hardware_type, c.ssid, c.version, c.wan_ip"
+
+
+class OtaDatabase:
+    def __init__(self, path, retention_days=7):
+        self.path = path
+        self.retention_days = retention_days
+        self.fts = False                     # Volltext-Index verfügbar (SQLite mit FTS5-Trigrammen)
+        self.local = threading.local()       # Eine Verbindung pro Thread
+        self.write_lock = threading.Lock()   # Schreiber nacheinander, Leser parallel (WAL)
+        self.pending = []                    # Noch nicht geschriebene Checkins
+        self.pending_lock = threading.Lock()
+        self.flush_event = threading.Event()
+
+        with self.write_lock:
+            conn = self.connection()
+            conn.executescript(SCHEMA)
+            self._upgrade(conn)
+
+        self.writer = threading.Thread(target=self._checkin_writer, name="checkin-writer", daemon=True)
+        self.writer.start()
+        atexit.register(self.flush_checkins)   # Puffer beim Beenden nicht verlieren
+
+    def connection(self):
+        conn = getattr(self.local, "conn", None)
+        if conn is None:
+            conn = sqlite3.connect(self.path, timeout=10)
+            conn.execute("PRAGMA journal_mode=WAL")
+            conn.execute("PRAGMA synchronous=NORMAL")   # Mit WAL sicher gegen Abstürze, nur nicht gegen Stromausfall
+            self.local.conn = conn
+        return conn
+
+    def _upgrade(self, conn):
+        row = conn.execute("SELECT value FROM meta WHERE key = 'schema_version'").fetchone()
+        version = int(row[0]) if row else SCHEMA_VERSION
+        if version < 2:
+            # Version 1: Geräte-Index über (device_id, ts) - sortierte nicht nach id
+            conn.execute("DROP INDEX IF EXISTS checkins_device_ts")
+        try:
+            exists = conn.execute("SELECT 1 FROM sqlite_master WHERE name = 'checkins_fts'").fetchone()
+            conn.executescript(SCHEMA_FTS)
+            if not exists:
+                conn.execute("INSERT INTO checkins_fts (checkins_fts) VALUES ('rebuild')")
+            self.fts = True
+        except sqlite3.OperationalError as e:
+            print(f"Kein Volltext-Index ({e}) - Suche durchsucht den Verlauf")
+        conn.execute("INSERT OR REPLACE INTO meta (key, value) VALUES ('schema_version', ?)",
+                     (str(SCHEMA_VERSION),))
+        conn.commit()
+
+    # --- Geräte ---------------------------------------------------------
+
+    def load_devices(self):
+        """Alle Geräte als dict (für den Cache im Server)"""
+        rows = self.connection().execute("SELECT id, data FROM devices")
+        return {device_id: json.loads(data) for device_id, data in rows}
+
+    def save_device(self, device_id, device):
+        data = json.dumps(device)
+        with self.write_lock:
+            conn = self.connection()
+            conn.execute(
+                "INSERT INTO devices (id, data, last_seen, firmware, status) VALUES (?, ?, ?, ?, ?) "
+                "ON CONFLICT(id) DO UPDATE SET data = excluded.data, last_seen = excluded.last_seen, "
+                "firmware = excluded.firmware, status = excluded.status",
+                (device_id, data, device.get("last_seen"), device.get("firmware"), device.get("status")))
+            conn.commit()
+
+    def delete_device(self, device_id):
+        with self.write_lock:
+            conn = self.connection()
+            conn.execute("DELETE FROM devices WHERE id = ?", (device_id,))
+            conn.commit()
+
+    # --- Checkins -------------------------------------------------------
+
+    def add_checkin(self, ts, device_id, hardware_type, ssid, version, wan_ip):
+        """Checkin vormerken - geschrieben wird gesammelt im Hintergrund"""
+        with self.pending_lock:
+            self.pending.append((ts, device_id, hardware_type, ssid, version, wan_ip))
+            full = len(self.pending) >= CHECKIN_BATCH_SIZE
+        if full:
+            self.flush_event.set()
+
+    def flush_checkins(self):
+        with self.pending_lock:
+            batch, self.pending = self.pending, []
+        if not batch:
+            return
+        with self.write_lock:
+            conn = self.connection()
+            conn.executemany(
+                "INSERT INTO checkins (ts, device_id, hardware_type, ssid, version, wan_ip) "
+                "VALUES (?, ?, ?, ?, ?, ?)", batch)
+            conn.commit()
+
+    def _checkin_writer(self):
+        next_retention = 0
+        while True:
+            self.flush_event.wait(CHECKIN_FLUSH_SECONDS)
+            self.flush_event.clear()
+            try:
+                self.flush_checkins()
+                if time.monotonic() >= next_retention:
+                    next_retention = time.monotonic() + RETENTION_INTERVAL_SECONDS
+                    self.apply_retention()
+            except sqlite3.Error as e:
+                print(f"Fehler beim Schreiben der Checkins: {e}")
+                time.sleep(CHECKIN_FLUSH_SECONDS)
+
+    def search_checkins(self, search="", device_id="", since="", until="", before=None, limit=50):
+        """Checkins, neueste zuerst, höchstens limit. before ist der Cursor
+        (next_cursor der vorigen Seite). Suchbegriffe ab SEARCH_MIN_LENGTH
+        Zeichen gehen über den Volltext-Index, kürzere und solche mit
+        Gerätefilter vergleichen per LIKE.
+        Rückgabe: Zeilen (id, ts, device_id, hardware_type, ssid, version,
+        wan_ip) und der Cursor für die nächste Seite (None = keine weitere)."""
+        self.flush_checkins()
+        where, params = [], []
+        if before is not None:
+            where.append("c.id < ?")
+            params.append(before)
+        if device_id:
+            where.append("c.device_id = ?")
+            params.append(device_id)
+        if since:
+            where.append("c.ts >= ?")
+            params.append(since)
+        if until:
+            where.append("c.ts < ?")
+            params.append(until)
+
+        # Mit Gerätefilter ist der Geräte-Index enger als jeder Suchbegriff
+        if search and self.fts and len(search) >= SEARCH_MIN_LENGTH and not device_id:
+            # Vom FTS-Index in rowid-Reihenfolge, LIMIT bricht früh ab
+            where = ["checkins_fts.rowid < ?" if clause == "c.id < ?" else clause for clause in where]
+            where.insert(0, "checkins_fts MATCH ?")
+            params.insert(0, '"' + search.replace('"', '""') + '"')
+            sql = (f"SELECT {CHECKIN_COLUMNS} FROM checkins_fts JOIN checkins c ON c.id = checkins_fts.rowid "
+                   f"WHERE {' AND '.join(where)} ORDER BY checkins_fts.rowid DESC LIMIT ?")
+        else:
+            if search:
+                pattern = "%" + search.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_") + "%"
+                columns = ("c.device_id", "c.hardware_type", "c.ssid", "c.version", "c.wan_ip")
+                where.append("(" + " OR ".join(f"{column} LIKE ? ESCAPE '\\'" for column in columns) + ")")
+                params.extend([pattern] * len(columns))
+            sql = (f"SELECT {CHECKIN_COLUMNS} FROM checkins c "
+                   f"{'WHERE ' + ' AND '.join(where) if where else ''} ORDER BY c.id DESC LIMIT ?")
+        params.append(limit)
+
+        rows = self.connection().execute(sql, params).fetchall()
+        next_cursor = rows[-1][0] if len(rows) == limit else None
+        return rows, next_cursor
+
+    def delete_checkins_before(self, ts):
+        """Verlauf vor ts löschen - blockweise über den Zeit-Index, jeder Block
+        eine eigene kurze Transaktion"""
+        self.flush_checkins()
+        deleted = 0
+        while True:
+            with self.write_lock:
+                conn = self.connection()
+                count = conn.execute(
+                    "DELETE FROM checkins WHERE id IN "
+                    "(SELECT id FROM checkins WHERE ts < ? ORDER BY ts LIMIT ?)",
+                    (ts, RETENTION_CHUNK)).rowcount
+                conn.commit()
+            deleted += count
+            if count < RETENTION_CHUNK:
+                return deleted
+
+    def apply_retention(self):
+        cutoff = (datetime.utcnow() - timedelta(days=self.retention_days)).isoformat()
+        deleted = self.delete_checkins_before(cutoff)
+        if deleted:
+            print(f"Log-Bereinigung abgeschlossen. {deleted} Einträge älter als {self.retention_days} Tage wurden gelöscht.")
+
+    # --- Migration ------------------------------------------------------
+
+    def migrate(self, device_file, log_file):
+        """devices.json und checkins.log einmalig übernehmen"""
+        if os.path.exists(device_file):
+            with open(device_file, "r") as f:
+                devices = json.load(f)
+            for device_id, device in devices.items():
+                self.save_device(device_id, device)
+            os.replace(device_file, device_file + ".migrated")
+            print(f"{len(devices)} Geräte aus {device_file} übernommen")
+
+        if os.path.exists(log_file):
+            rows = []
+            with open(log_file, "r") as f:
+                for line in f:
+                    row = parse_log_line(line)
+                    if row:
+                        rows.append(row)
+            with self.write_lock:
+                conn = self.connection()
+                conn.executemany(
+                    "INSERT INTO checkins (ts, device_id, hardware_type, ssid, version, wan_ip) "
+                    "VALUES (?, ?, ?, ?, ?, ?)", rows)
+                conn.commit()
+            os.replace(log_file, log_file + ".migrated")
+            print(f"{len(rows)} Checkins aus {log_file} übernommen")
+
+
+def parse_log_line(line):
+    """Zeile aus checkins.log: "zeit - id - typ - ssid - version - ip"
+    (die SSID darf selbst " - " enthalten)"""
+    parts = line.rstrip("\n").split(" - ")
+    if len(parts) < 6:
+        return None
+    return (parts[0], parts[1], parts[2], " - ".join(parts[3:-2]), parts[-2], parts[-1])
+
+
+def format_checkin(row):
+    """Checkin (ohne id) im bisherigen Log-Format (Anzeige im Dashboard)"""
+    return " - ".join("" if value is None else str(value) for value in row[1:]) + "\n"
@@ -0,0 +1,223 @@
+# ota_delta.py
+# Download-Formate für den OTA-Server, beide entpackt das Badge während des
+# Downloads (OtaDecoder.cpp):
+#
+# Delta-Updates ("BDLT"): Binär-Diff zwischen der laufenden und der neuen
+# Firmware. Das Badge baut das neue Image aus seiner laufenden Partition plus
+# Delta zusammen und prüft es per SHA-256.
+#
+# Format:
+#   Kopf (16 Bytes, unkomprimiert): "BDLT", Version (1), 3 Bytes reserviert,
+#                                   Basis-Größe (u32 LE), Ziel-Größe (u32 LE)
+#   Danach ein raw-deflate-Strom (32 KB Fenster) mit Operationen:
+#     0x00                          Ende
+#     0x01 offset len               COPY: len Bytes aus der Basis ab offset
+#     0x02 len daten                ADD:  len neue Bytes
+#     0x03 offset len daten         DIFF: len Bytes Basis ab offset + daten (mod 256)
+#   offset und len sind u32 LE.
+#
+# DIFF fängt die typischen Firmware-Änderungen ab: verschobene Funktionen
+# ändern nur einzelne Adress-Bytes, die Differenz ist fast überall 0 und
+# komprimiert entsprechend gut.
+#
+# Komprimierte Images ("BCMP"): das volle Image als raw-deflate-Strom mit
+# kleinem Fenster (4 KB), so braucht das Badge zum Entpacken kaum RAM.
+#
+# Format:
+#   Kopf (44 Bytes): "BCMP", Version (1), Fenster-Bits, 2 Bytes reserviert,
+#                    Image-Größe (u32 LE), SHA-256 des Images (32 Bytes)
+#   Danach der raw-deflate-Strom
+#
+# Aufruf von Hand:  python ota_delta.py alt.bin neu.bin neu.bdlt
+#                   python ota_delta.py --compress neu.bin neu.bcmp
+
+import hashlib
+import struct
+import sys
+import zlib
+
+DELTA_MAGIC = b"BDLT"
+DELTA_VERSION = 1
+DELTA_HEADER = struct.Struct("<4sB3xII")
+
+OP_END = 0x00
+OP_COPY = 0x01
+OP_ADD = 0x02
+OP_DIFF = 0x03
+
+MATCH_BLOCK = 32      # Kürzester Treffer, der gesucht wird
+INDEX_STEP = 8        # Basis wird nur in diesem Raster indiziert (Speicher)
+DIFF_GIVE_UP = 32     # DIFF endet, wenn der Score so weit unter dem Bestwert liegt
+
+COMPRESSED_MAGIC = b"BCMP"
+COMPRESSED_VERSION = 1
+COMPRESSED_HEADER = struct.Struct("<4sBB2xI32s")
+COMPRESSED_WINDOW_BITS = 12   # 4 KB - so groß ist der Entpack-Puffer im Badge
+
+
+def _match_length(base, boff, target, toff):
+    """Länge der exakten Übereinstimmung (erst in Blöcken, dann Byte für Byte)"""
+    length = 0
+    limit = min(len(base) - boff, len(target) - toff)
+    while length + 256 <= limit and base[boff + length:boff + length + 256] == target[toff + length:toff + length + 256]:
+        length += 256
+    while length < limit and base[boff + length] == target[toff + length]:
+        length += 1
+    return length
+
+
+def _diff_length(base, boff, target, toff):
+    """Wie weit sich eine ungefähre Übereinstimmung lohnt (bsdiff-Score:
+    gleiche Bytes +1, andere -1, der beste Schnittpunkt gewinnt)"""
+    limit = min(len(base) - boff, len(target) - toff)
+    score = best_score = best_length = 0
+    length = 0
+    while length < limit:
+        score += 1 if base[boff + length] == target[toff + length] else -1
+        length += 1
+        if score > best_score:
+            best_score, best_length = score, length
+        elif score < best_score - DIFF_GIVE_UP:
+            break
+    return best_length
+
+
+def make_delta(base, target):
+    """Delta von base nach target (bytes) erzeugen"""
+    index = {}
+    for offset in range(0, len(base) - MATCH_BLOCK + 1, INDEX_STEP):
+        index.setdefault(base[offset:offset + MATCH_BLOCK], offset)
+
+    ops = bytearray()
+    literal = bytearray()
+
+    def flush_literal():
+        if literal:
+            ops.extend(struct.pack("<BI", OP_ADD, len(literal)))
+            ops.extend(literal)
+            del literal[:]
+
+    pos = 0
+    while pos + MATCH_BLOCK <= len(target):
+        boff = index.get(target[pos:pos + MATCH_BLOCK])
+        if boff is None:
+            literal.append(target[pos])
+            pos += 1
+            continue
+
+        # Treffer nach hinten in die Literale verlängern
+        back = 0
+        while back < len(literal) and back < boff and base[boff - back - 1] == literal[-back - 1]:
+            back += 1
+        if back:
+            del literal[-back:]
+        boff -= back
+        pos -= back
+
+        exact = _match_length(base, boff, target, pos)
+        flush_literal()
+        ops.extend(struct.pack("<BII", OP_COPY, boff, exact))
+        pos += exact
+        boff += exact
+
+        approx = _diff_length(base, boff, target, pos)
+        if approx:
+            ops.extend(struct.pack("<BII", OP_DIFF, boff, approx))
+            ops.extend((target[pos + i] - base[boff + i]) & 0xFF for i in range(approx))
+            pos += approx
+
+    literal.extend(target[pos:])
+    flush_literal()
+    ops.append(OP_END)
+
+    compressor = zlib.compressobj(9, zlib.DEFLATED, -15)
+    body = compressor.compress(bytes(ops)) + compressor.flush()
+    return DELTA_HEADER.pack(DELTA_MAGIC, DELTA_VERSION, len(base), len(target)) + body
+
+
+def apply_delta(base, delta):
+    """Delta anwenden (Gegenprobe beim Erzeugen, gleiche Logik wie im Badge)"""
+    magic, version, base_size, target_size = DELTA_HEADER.unpack_from(delta)
+    if magic != DELTA_MAGIC or version != DELTA_VERSION:
+        raise ValueError("Kein BDLT-Delta")
+    if base_size != len(base):
+        raise ValueError("Falsche Basis")
+
+    ops = zlib.decompress(delta[DELTA_HEADER.size:], -15)
+    out = bytearray()
+    pos = 0
+    while True:
+        op = ops[pos]
+        pos += 1
+        if op == OP_END:
+            break
+        if op == OP_COPY:
+            offset, length = struct.unpack_from("<II", ops, pos)
+            pos += 8
+            out.extend(base[offset:offset + length])
+        elif op == OP_ADD:
+            (length,) = struct.unpack_from("<I", ops, pos)
+            pos += 4
+            out.extend(ops[pos:pos + length])
+            pos += length
+        elif op == OP_DIFF:
+            offset, length = struct.unpack_from("<II", ops, pos)
+            pos += 8
+            out.extend((base[offset + i] + ops[pos + i]) & 0xFF for i in range(length))
+            pos += length
+        else:
+            raise ValueError(f"Unbekannte Operation {op:#x}")
+
+    if len(out) != target_size:
+        raise ValueError("Falsche Zielgröße")
+    return bytes(out)
+
+
+def make_compressed(image):
+    """Image komprimieren (BCMP)"""
+    compressor = zlib.compressobj(9, zlib.DEFLATED, -COMPRESSED_WINDOW_BITS)
+    body = compressor.compress(image) + compressor.flush()
+    header = COMPRESSED_HEADER.pack(COMPRESSED_MAGIC, COMPRESSED_VERSION, COMPRESSED_WINDOW_BITS,
+                                    len(image), hashlib.sha256(image).digest())
+    return header + body
+
+
+def read_compressed(data):
+    """BCMP entpacken und gegen Größe und SHA-256 aus dem Kopf prüfen"""
+    magic, version, window_bits, size, sha256 = COMPRESSED_HEADER.unpack_from(data)
+    if magic != COMPRESSED_MAGIC or version != COMPRESSED_VERSION:
+        raise ValueError("Kein BCMP-Image")
+    image = zlib.decompress(data[COMPRESSED_HEADER.size:], -window_bits)
+    if len(image) != size or hashlib.sha256(image).digest() != sha256:
+        raise ValueError("Image beschädigt")
+    return image
+
+
+if __name__ == "__main__":
+    if len(sys.argv) == 4 and sys.argv[1] == "--compress":
+        with open(sys.argv[2], "rb") as f:
+            image = f.read()
+        data = make_compressed(image)
+        if read_compressed(data) != image:
+            print("Gegenprobe fehlgeschlagen!")
+            sys.exit(1)
+        with open(sys.argv[3], "wb") as f:
+            f.write(data)
+        print(f"Komprimiert: {len(data)} Bytes ({len(data) * 100 // max(len(image), 1)}% von {len(image)})")
+        sys.exit(0)
+
+    if len(sys.argv) != 4:
+        print("Aufruf: python ota_delta.py alt.bin neu.bin neu.bdlt")
+        print("        python ota_delta.py --compress neu.bin neu.bcmp")
+        sys.exit(1)
+    with open(sys.argv[1], "rb") as f:
+        base = f.read()
+    with open(sys.argv[2], "rb") as f:
+        target = f.read()
+    delta = make_delta(base, target)
+    if apply_delta(base, delta) != target:
+        print("Gegenprobe fehlgeschlagen!")
+        sys.exit(1)
+    with open(sys.argv[3], "wb") as f:
+        f.write(delta)
+    print(f"Delta: {len(delta)} Bytes ({len(delta) * 100 // max(len(target), 1)}% von {len(target)})")
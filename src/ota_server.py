@@ -7,94 +7,512 @@ from datetime import datetime, timedelta
 import json
 from werkzeug.utils import secure_filename
 import requests
-import re
+import hashlib
+import threading
+import time
+from ota_delta import make_delta, apply_delta, make_compressed, read_compressed
+from ota_db import OtaDatabase, format_checkin
 
 app = Flask(__name__)
 app.secret_key = 'supersecret'
 
 FIRMWARE_DIR = "firmwares"
-DEVICE_DB = "devices.json"
-LOG_FILE = "checkins.log"
+DATABASE_FILE = "ota.db"
+DEVICE_DB = "devices.json"      # Nur noch für die Übernahme in die Datenbank
+LOG_FILE = "checkins.log"       # dito
 FIRMWARE_METADATA_FILE = "firmware_metadata.json"
+DELTA_DIR = "deltas"
+DELTA_MAX_RATIO = 0.6   # Größere Deltas lohnen nicht - dann volles Image
+COMPRESSED_DIR = "compressed"
+COMPRESSED_MAX_RATIO = 0.9   # Spart das Komprimieren weniger, rohes Image senden
+LOG_RETENTION_DAYS = 7       # Checkin-Verlauf, stündlich bereinigt
+LOG_PAGE_MAX = 500           # Höchstens so viele Einträge pro /api/logs-Seite
+
+# Update-Verteilung: Checken viele Badges gleichzeitig ein, laden nie alle auf einmal
+DISPATCH_MAX_CONCURRENT = 4         # Gleichzeitige Downloads
+DISPATCH_RATE_PER_MIN = 12          # Token-Bucket: neue Update-Freigaben pro Minute ...
+DISPATCH_BURST = 4                  # ... und wie viele davon auf einmal
+DISPATCH_GRANT_TIMEOUT = timedelta(minutes=10)  # Ohne Checkin danach gilt der Download als gescheitert
+ROLLOUT_DEFAULT_PERCENT = 100       # Neue Firmwares gehen an alle zugewiesenen Geräte
+ROLLOUT_DEFAULT_MAX_ROLLBACKS = 2   # Rollbacks, ab denen der Rollout pausiert
+# Gescheiterte Downloads (WLAN, Gerät offline) sagen wenig über die Firmware:
+# Pause erst, wenn es viele sind und ein großer Teil der Freigaben scheitert
+ROLLOUT_FAILURE_MIN = 5
+ROLLOUT_MAX_FAILURE_RATE = 0.5
 
 os.makedirs(FIRMWARE_DIR, exist_ok=True)
+os.makedirs(DELTA_DIR, exist_ok=True)
+os.makedirs(COMPRESSED_DIR, exist_ok=True)
 
-devices = {}
-if os.path.exists(DEVICE_DB):
-    with open(DEVICE_DB, "r") as f:
-        devices = json.load(f)
-else:
-    devices = {}
+# Deltas, die gerade im Hintergrund erzeugt werden
+delta_jobs = set()
+delta_lock = threading.Lock()
+
+# Komprimierte Images, die gerade im Hintergrund erzeugt werden
+compress_jobs = set()
+compress_lock = threading.Lock()
+
+class TokenBucket:
+    """rate Freigaben pro Sekunde, höchstens burst auf Vorrat"""
+    def __init__(self, rate, burst):
+        self.rate = rate
+        self.burst = burst
+        self.tokens = burst
+        self.stamp = time.monotonic()
+
+    def _refill(self):
+        now = time.monotonic()
+        self.tokens = min(self.burst, self.tokens + (now - self.stamp) * self.rate)
+        self.stamp = now
+
+    def take(self):
+        self._refill()
+        if self.tokens < 1:
+            return False
+        self.tokens -= 1
+        return True
+
+    def available(self):
+        self._refill()
+        return self.tokens
+
+# Laufende Downloads: Geräte-ID -> Firmware, SHA-256, Version, Zeitpunkt der Freigabe
+dispatch_grants = {}
+dispatch_lock = threading.Lock()
+update_bucket = TokenBucket(DISPATCH_RATE_PER_MIN / 60.0, DISPATCH_BURST)
+
+# Geräte liegen in SQLite; devices ist der Cache im Speicher, jede Änderung
+# wird über save_device() sofort als einzelne Zeile geschrieben
+db = OtaDatabase(DATABASE_FILE, retention_days=LOG_RETENTION_DAYS)
+db.migrate(DEVICE_DB, LOG_FILE)
+devices = db.load_devices()
+devices_lock = threading.RLock()
+
+def save_device(device_id, device=None):
+    """Gerät in Cache und Datenbank übernehmen. Unter devices_lock, damit
+    gleichzeitige Anfragen ihren Stand in der richtigen Reihenfolge schreiben.
+    Wer ein Gerät liest und ändert, hält devices_lock bis hierher."""
+    with devices_lock:
+        if device is not None:
+            devices[device_id] = device
+        if device_id in devices:
+            db.save_device(device_id, json.loads(json.dumps(devices[device_id])))
 
-# Firmware-Metadaten laden
+def delete_device_record(device_id):
+    with devices_lock:
+        devices.pop(device_id, None)
+        db.delete_device(device_id)
+
+def devices_snapshot():
+    """Status nach letztem Checkin auffrischen, Kopie für API und Templates"""
+    now = datetime.utcnow()
+    with devices_lock:
+        for dev in devices.values():
+            last_seen = datetime.fromisoformat(dev.get("last_seen", "1970-01-01T00:00:00"))
+            if now - last_seen < timedelta(minutes=2):
+                dev["status"] = dev.get("status") if dev.get("status") in ("Update läuft", "Prüfung", "Rollback") else "Online"
+            else:
+                dev["status"] = "Offline"
+        return json.loads(json.dumps(devices))
+
+# Firmware-Metadaten laden. Checkins und Web-UI ändern sie aus mehreren
+# Anfrage-Threads - Änderungen und Schreiben nur unter metadata_lock
 firmware_metadata = {}
 if os.path.exists(FIRMWARE_METADATA_FILE):
     with open(FIRMWARE_METADATA_FILE, "r") as f:
         firmware_metadata = json.load(f)
 else:
     firmware_metadata = {}
+metadata_lock = threading.RLock()
 
-def cleanup_old_logs():
-    """Lösche Log-Einträge älter als 7 Tage"""
-    if not os.path.exists(LOG_FILE):
-        return
-    
-    cutoff_date = datetime.utcnow() - timedelta(days=7)
-    temp_log_file = LOG_FILE + ".tmp"
-    
-    try:
-        with open(LOG_FILE, "r") as infile, open(temp_log_file, "w") as outfile:
-            for line in infile:
-                # Versuche das Datum aus der Log-Zeile zu extrahieren
-                if line.strip():
-                    try:
-                        # Format: 2024-01-01T12:00:00.123456 - Badge-12345 - LED-Modd.Badge - SSID - 1.4.1 - 192.168.1.100
-                        date_str = line.split(" - ")[0]
-                        log_date = datetime.fromisoformat(date_str)
-                        if log_date > cutoff_date:
-                            outfile.write(line)
-                    except:
-                        # Wenn Datum-Parsing fehlschlägt, behalte die Zeile
-                        outfile.write(line)
-        
-        # Ersetze die alte Datei
-        os.replace(temp_log_file, LOG_FILE)
-        print(f"Log-Bereinigung abgeschlossen. Einträge älter als 7 Tage wurden gelöscht.")
-    except Exception as e:
-        print(f"Fehler bei der Log-Bereinigung: {e}")
-        if os.path.exists(temp_log_file):
-            os.remove(temp_log_file)
+def save_firmware_metadata():
+    """Über eine temporäre Datei schreiben - ein Abbruch mittendrin hinterlässt
+    nie eine halbe firmware_metadata.json, mit der der Server nicht mehr startet"""
+    with metadata_lock:
+        tmp = FIRMWARE_METADATA_FILE + ".tmp"
+        with open(tmp, "w") as f:
+            json.dump(firmware_metadata, f, indent=2)
+        os.replace(tmp, FIRMWARE_METADATA_FILE)
+
+def metadata_snapshot():
+    """Kopie für Templates, die über alle Firmwares iterieren"""
+    with metadata_lock:
+        return json.loads(json.dumps(firmware_metadata))
 
 def get_log_entries(search_term="", limit=50):
-    """Lade Log-Einträge mit optionaler Suche"""
-    if not os.path.exists(LOG_FILE):
-        return []
-    
-    entries = []
+    """Lade die neuesten Log-Einträge mit optionaler Suche (Teilstring)"""
     try:
-        with open(LOG_FILE, "r") as f:
-            lines = f.readlines()
-            
-        # Filtere nach Suchbegriff
-        if search_term:
-            search_pattern = re.compile(search_term, re.IGNORECASE)
-            lines = [line for line in lines if search_pattern.search(line)]
-        
-        # Nehme nur die letzten Einträge
-        entries = lines[-limit:] if len(lines) > limit else lines
-        
+        rows, _ = db.search_checkins(search_term, limit=limit)
+        return [format_checkin(row) for row in rows]
     except Exception as e:
         print(f"Fehler beim Lesen der Logs: {e}")
-    
-    return entries
+        return []
 
-@app.route("/api/device_checkin", methods=["POST"])
-def device_checkin():
+def firmware_integrity(filename):
+    """Größe und SHA-256 einer Firmware - das Gerät prüft den Download damit.
+    Wird beim Upload berechnet; ältere Einträge werden hier nachgetragen."""
+    filepath = os.path.join(FIRMWARE_DIR, filename)
+    if not os.path.exists(filepath):
+        return 0, ""
+    with metadata_lock:
+        meta = firmware_metadata.setdefault(filename, {})
+        if "sha256" in meta and meta.get("file_size") == os.path.getsize(filepath):
+            return meta["file_size"], meta["sha256"]
+
+    sha = hashlib.sha256()
+    with open(filepath, "rb") as f:
+        for block in iter(lambda: f.read(65536), b""):
+            sha.update(block)
+    with metadata_lock:
+        meta = firmware_metadata.setdefault(filename, {})
+        meta["sha256"] = sha.hexdigest()
+        meta["file_size"] = os.path.getsize(filepath)
+        save_firmware_metadata()
+        return meta["file_size"], meta["sha256"]
+
+def delta_name(base_sha, target_sha):
+    return f"{base_sha[:16]}-{target_sha[:16]}.bdlt"
+
+def firmware_by_sha(sha256):
+    """Firmware-Datei zu einer SHA-256 (die laufende Firmware eines Geräts)"""
+    with metadata_lock:
+        entries = list(firmware_metadata.items())
+    for filename, meta in entries:
+        if meta.get("sha256") == sha256 and os.path.exists(os.path.join(FIRMWARE_DIR, filename)):
+            return filename
+    return None
+
+def build_delta(base_file, target_file, name):
+    """Delta erzeugen, gegenprüfen und cachen (läuft im Hintergrund).
+    Lohnt es sich nicht, merkt sich eine leere .none-Datei das."""
+    path = os.path.join(DELTA_DIR, name)
+    try:
+        with open(os.path.join(FIRMWARE_DIR, base_file), "rb") as f:
+            base = f.read()
+        with open(os.path.join(FIRMWARE_DIR, target_file), "rb") as f:
+            target = f.read()
+
+        delta = make_delta(base, target)
+        if apply_delta(base, delta) != target:
+            print(f"Delta {base_file} -> {target_file}: Gegenprobe fehlgeschlagen")
+            open(path + ".none", "w").close()
+        elif len(delta) > len(target) * DELTA_MAX_RATIO:
+            print(f"Delta {base_file} -> {target_file}: {len(delta)} Bytes, lohnt nicht")
+            open(path + ".none", "w").close()
+        else:
+            with open(path + ".tmp", "wb") as f:
+                f.write(delta)
+            os.replace(path + ".tmp", path)
+            print(f"Delta {base_file} -> {target_file}: {len(delta)} von {len(target)} Bytes")
+    except Exception as e:
+        print(f"Fehler beim Erzeugen des Deltas {name}: {e}")
+    finally:
+        with delta_lock:
+            delta_jobs.discard(name)
+
+def start_delta(base_file, base_sha, target_file, target_sha):
+    name = delta_name(base_sha, target_sha)
+    path = os.path.join(DELTA_DIR, name)
+    if os.path.exists(path) or os.path.exists(path + ".none"):
+        return
+    with delta_lock:
+        if name in delta_jobs:
+            return
+        delta_jobs.add(name)
+    threading.Thread(target=build_delta, args=(base_file, target_file, name), daemon=True).start()
+
+def delta_for(running_sha256, target_file, target_sha):
+    """Pfad des Deltas von der laufenden zur Ziel-Firmware oder None (dann
+    volles Image). Fehlt es noch, wird es für die nächsten Geräte erzeugt."""
+    if not running_sha256 or running_sha256 == target_sha:
+        return None
+    base_file = firmware_by_sha(running_sha256)
+    if not base_file:
+        return None
+    path = os.path.join(DELTA_DIR, delta_name(running_sha256, target_sha))
+    if os.path.exists(path):
+        return path
+    start_delta(base_file, running_sha256, target_file, target_sha)
+    return None
+
+def build_compressed(filename, path):
+    """Image komprimieren, gegenprüfen und cachen (läuft im Hintergrund).
+    Lohnt es sich nicht, merkt sich eine leere .none-Datei das."""
+    try:
+        with open(os.path.join(FIRMWARE_DIR, filename), "rb") as f:
+            image = f.read()
+        data = make_compressed(image)
+        if read_compressed(data) != image:
+            print(f"Komprimiert {filename}: Gegenprobe fehlgeschlagen")
+            open(path + ".none", "w").close()
+        elif len(data) > len(image) * COMPRESSED_MAX_RATIO:
+            print(f"Komprimiert {filename}: {len(data)} Bytes, lohnt nicht")
+            open(path + ".none", "w").close()
+        else:
+            with open(path + ".tmp", "wb") as f:
+                f.write(data)
+            os.replace(path + ".tmp", path)
+            print(f"Komprimiert {filename}: {len(data)} von {len(image)} Bytes")
+    except Exception as e:
+        print(f"Fehler beim Komprimieren von {filename}: {e}")
+    finally:
+        with compress_lock:
+            compress_jobs.discard(path)
+
+def start_compressed(filename, sha256):
+    path = os.path.join(COMPRESSED_DIR, f"{sha256[:16]}.bcmp")
+    if os.path.exists(path) or os.path.exists(path + ".none"):
+        return
+    with compress_lock:
+        if path in compress_jobs:
+            return
+        compress_jobs.add(path)
+    threading.Thread(target=build_compressed, args=(filename, path), daemon=True).start()
+
+def compressed_for(filename, sha256):
+    """Pfad des komprimierten Images (BCMP) oder None (dann rohes Image).
+    Der Name hängt am Inhalt, ein erneuter Upload unter gleichem Namen
+    erzeugt ein neues. Fehlt es noch, wird es im Hintergrund erzeugt."""
+    path = os.path.join(COMPRESSED_DIR, f"{sha256[:16]}.bcmp")
+    if os.path.exists(path):
+        return path
+    start_compressed(filename, sha256)
+    return None
+
+def update_response(filename, running_sha256="", **extra):
+    """Update-Antwort mit URL, Größe und Prüfsumme der Firmware, dem
+    komprimierten Image und - läuft auf dem Gerät eine bekannte Firmware -
+    dem Delta dorthin"""
+    size, sha256 = firmware_integrity(filename)
+    response = {"update": True, "url": f"http://{request.host}/firmwares/{filename}"}
+    if size:
+        response["size"] = size
+        response["sha256"] = sha256
+        delta_path = delta_for(running_sha256, filename, sha256)
+        if delta_path:
+            response["delta"] = {
+                "url": f"http://{request.host}/deltas/{os.path.basename(delta_path)}",
+                "size": os.path.getsize(delta_path),
+                "base_sha256": running_sha256
+            }
+        compressed_path = compressed_for(filename, sha256)
+        if compressed_path:
+            response["compressed"] = {
+                "url": f"http://{request.host}/compressed/{os.path.basename(compressed_path)}",
+                "size": os.path.getsize(compressed_path)
+            }
+    response.update(extra)
+    return response
+
+def record_ota_result(device_id, device, ota_result, running_sha256):
+    """Ergebnis der letzten neuen Firmware vom Badge übernehmen (OtaHealth.cpp):
+    "pending" (läuft, noch nicht bestätigt), "confirmed" oder "rolled_back"
+    (verworfen, mit SHA-256 und Grund). Rollbacks werden pro Firmware gezählt."""
+    status = ota_result.get("status")
+    if status == "pending":
+        device["status"] = "Prüfung"
+        return
+    if status == "confirmed":
+        firmware = firmware_by_sha(running_sha256)
+        print(f"{device_id}: Firmware {firmware or running_sha256[:16]} bestätigt")
+        device["confirmed_sha256"] = running_sha256
+        with metadata_lock:
+            if firmware and firmware in firmware_metadata:
+                meta = firmware_metadata[firmware]
+                meta["confirmations"] = meta.get("confirmations", 0) + 1
+                rollout_event(firmware, "confirmations")
+        return
+    if status != "rolled_back":
+        return
+
+    sha256 = ota_result.get("sha256", "")
+    reason = ota_result.get("reason", "")
+    firmware = firmware_by_sha(sha256)
+    print(f"ROLLBACK auf {device_id}: Firmware {firmware or sha256[:16]} verworfen ({reason})")
+    device["status"] = "Rollback"
+    device["rollback"] = {
+        "sha256": sha256,
+        "firmware": firmware or "",
+        "reason": reason,
+        "at": datetime.utcnow().isoformat()
+    }
+    device.pop("update_sent", None)
+    device.pop("expected_version", None)
+    with metadata_lock:
+        if firmware and firmware in firmware_metadata:
+            meta = firmware_metadata[firmware]
+            meta["rollbacks"] = meta.get("rollbacks", 0) + 1
+            rollout_event(firmware, "rollbacks")
+
+def rolled_back_on(device, filename):
+    """Hat das Gerät genau diese Firmware schon einmal verworfen? Dann nicht
+    erneut anbieten - sonst lädt es sie nach jedem Rollback wieder"""
+    rollback = device.get("rollback")
+    if not rollback:
+        return False
+    _, sha256 = firmware_integrity(filename)
+    return bool(sha256) and sha256 == rollback.get("sha256")
+
+def rollout_policy(filename):
+    """Rollout-Einstellungen und -Zähler einer Firmware (mit Standardwerten).
+    Das Ergebnis nur unter metadata_lock ändern."""
+    with metadata_lock:
+        rollout = firmware_metadata.setdefault(filename, {}).setdefault("rollout", {})
+        if "max_failures" in rollout:  # Früherer Name, zählte auch Fehlschläge
+            rollout.setdefault("max_rollbacks", rollout.pop("max_failures"))
+        rollout.setdefault("percent", ROLLOUT_DEFAULT_PERCENT)
+        rollout.setdefault("max_rollbacks", ROLLOUT_DEFAULT_MAX_ROLLBACKS)
+        rollout.setdefault("paused", False)
+        rollout.setdefault("pause_reason", "")
+        for counter in ("granted", "completed", "failures", "rollbacks", "confirmations", "granted_since_resume"):
+            rollout.setdefault(counter, 0)
+        return rollout
+
+def rollout_snapshot(filenames):
+    """Kopien der Rollouts für API und Dashboard"""
+    with metadata_lock:
+        return {fw: dict(rollout_policy(fw)) for fw in filenames if fw in firmware_metadata}
+
+def update_rollout(filename, percent=None, max_rollbacks=None, paused=None):
+    """Rollout ändern. Fortsetzen setzt die Problemzähler zurück, sonst
+    hielte der nächste Fehler den Rollout sofort wieder an."""
+    percent = None if percent is None else max(0, min(100, int(percent)))
+    max_rollbacks = None if max_rollbacks is None else max(1, int(max_rollbacks))
+    with metadata_lock:
+        rollout = rollout_policy(filename)
+        if percent is not None:
+            rollout["percent"] = percent
+        if max_rollbacks is not None:
+            rollout["max_rollbacks"] = max_rollbacks
+        if paused is not None:
+            if rollout["paused"] and not paused:
+                rollout["failures"] = 0
+                rollout["rollbacks"] = 0
+                rollout["granted_since_resume"] = 0
+                rollout["pause_reason"] = ""
+            elif paused and not rollout["paused"]:
+                rollout["pause_reason"] = "von Hand"
+            rollout["paused"] = bool(paused)
+        save_firmware_metadata()
+        print(f"Rollout {filename}: {rollout['percent']}%, pausiert={rollout['paused']}")
+        return dict(rollout)
+
+def rollout_event(filename, event):
+    """Zähler erhöhen (granted/completed/failures/rollbacks/confirmations).
+    Der Rollout pausiert, wenn die Rollbacks max_rollbacks erreichen oder
+    seit dem letzten Fortsetzen ein großer Teil der Downloads scheitert."""
+    with metadata_lock:
+        if not filename or filename not in firmware_metadata:
+            return
+        rollout = rollout_policy(filename)
+        rollout[event] += 1
+        if event == "granted":
+            rollout["granted_since_resume"] += 1
+
+        reason = ""
+        if event == "rollbacks" and rollout["rollbacks"] >= rollout["max_rollbacks"]:
+            reason = f"{rollout['rollbacks']} Rollbacks"
+        elif (event == "failures" and rollout["failures"] >= ROLLOUT_FAILURE_MIN and
+              rollout["failures"] >= rollout["granted_since_resume"] * ROLLOUT_MAX_FAILURE_RATE):
+            reason = f"{rollout['failures']} von {rollout['granted_since_resume']} Downloads gescheitert"
+        if reason and not rollout["paused"]:
+            rollout["paused"] = True
+            rollout["pause_reason"] = reason
+            print(f"ROLLOUT {filename} automatisch angehalten: {reason}")
+        save_firmware_metadata()
+
+def in_cohort(device_id, filename, percent):
+    """Feste Kohorte pro Gerät und Firmware - mehr Prozent nehmen nur Geräte dazu"""
+    bucket = int(hashlib.sha256(f"{filename}:{device_id}".encode()).hexdigest()[:8], 16) % 100
+    return bucket < percent
+
+def expire_grants(now):
+    """Freigaben ohne Checkin danach gelten als gescheitert (dispatch_lock halten)"""
+    for device_id, grant in list(dispatch_grants.items()):
+        if now - grant["since"] > DISPATCH_GRANT_TIMEOUT:
+            del dispatch_grants[device_id]
+            print(f"{device_id}: Download von {grant['firmware']} ohne Rückmeldung abgelaufen")
+            rollout_event(grant["firmware"], "failures")
+
+def finish_grant(device_id, version, running_sha256, ota_result):
+    """Erster Checkin nach einer Freigabe: der Download ist vorbei - mit
+    neuer Firmware (sie meldet sich danach noch als bestätigt oder
+    zurückgerollt) oder gescheitert. Stürzt die neue Firmware vor ihrem
+    ersten Checkin ab, meldet die vorige den Rollback - installiert war sie."""
+    with dispatch_lock:
+        grant = dispatch_grants.pop(device_id, None)
+    if not grant:
+        return
+    installed = running_sha256 == grant["sha256"] or ota_result.get("sha256") == grant["sha256"]
+    if installed or (not running_sha256 and version == grant["version"]):
+        rollout_event(grant["firmware"], "completed")
+    else:
+        print(f"{device_id}: Update auf {grant['firmware']} nicht installiert")
+        rollout_event(grant["firmware"], "failures")
+
+def dispatch_update(device_id, filename, force=False):
+    """Darf das Gerät jetzt laden? None = ja (Freigabe eingetragen), sonst der
+    Grund: rollout_paused, not_in_cohort oder throttled (gleichzeitige
+    Downloads bzw. Token-Bucket). Force-Updates umgehen alle Grenzen."""
+    _, sha256 = firmware_integrity(filename)
+    now = datetime.utcnow()
+    with dispatch_lock:
+        expire_grants(now)
+        if not force:
+            rollout = rollout_policy(filename)
+            if rollout["paused"]:
+                return "rollout_paused"
+            if not in_cohort(device_id, filename, rollout["percent"]):
+                return "not_in_cohort"
+            if len(dispatch_grants) >= DISPATCH_MAX_CONCURRENT or not update_bucket.take():
+                return "throttled"
+        dispatch_grants[device_id] = {
+            "firmware": filename,
+            "sha256": sha256,
+            "version": firmware_metadata.get(filename, {}).get("version", ""),
+            "since": now
+        }
+        rollout_event(filename, "granted")
+    return None
+
+def dispatch_status():
+    with dispatch_lock:
+        active = {device_id: {"firmware": grant["firmware"], "since": grant["since"].isoformat()}
+                  for device_id, grant in dispatch_grants.items()}
+        tokens = update_bucket.available()
+    return {
+        "active": active,
+        "max_concurrent": DISPATCH_MAX_CONCURRENT,
+        "rate_per_min": DISPATCH_RATE_PER_MIN,
+        "tokens": round(tokens, 2)
+    }
+
+def checkin_response(payload):
+    """Antwort auf einen Checkin. Reine Status-Antworten (keine Aktion für das
+    Gerät) bekommen ein ETag - schickt das Gerät es beim nächsten Checkin als
+    If-None-Match zurück und hat sich nichts geändert, reicht ein 304 ohne Body.
+    Aktionen (Update, Reboot, set_version) werden nie per 304 unterdrückt."""
+    if payload.get("update") or payload.get("reboot") or "set_version" in payload:
+        return jsonify(payload)
+
+    body = json.dumps(payload, sort_keys=True, separators=(",", ":"))
+    etag = '"' + hashlib.sha1(body.encode()).hexdigest()[:16] + '"'
+    if request.headers.get("If-None-Match") == etag:
+        return app.response_class(status=304, headers={"ETag": etag})
+
+    response = app.response_class(body, mimetype="application/json")
+    response.headers["ETag"] = etag
+    return response
+
+def process_checkin():
+    """Checkin auswerten - nur unter devices_lock (siehe device_checkin)"""
     data = request.get_json()
     device_id = data.get("id")
     version = data.get("version")
     ssid = data.get("ssid")
     hardware_type = data.get("hardware_type", "LED-Modd.Badge")  # Neuer Parameter
+    running_sha256 = data.get("running_sha256", "")  # Basis für Delta-Updates
+    ota_result = data.get("ota_result") or {}  # Bestätigung/Rollback der letzten neuen Firmware
     wan_ip = request.remote_addr
     now = datetime.utcnow().isoformat()
 
@@ -122,9 +540,9 @@ def device_checkin():
             "set_version": "force"  # ESP32 soll seine Version auf "force" setzen
         }
         print(f"Sende Version-Sync-Antwort: {response_data}")
-        return jsonify(response_data)
+        return checkin_response(response_data)
     if device.get("locked", False):
-        return jsonify({"locked": True})
+        return checkin_response({"locked": True})
 
     device.update({
         "ssid": ssid,
@@ -137,6 +555,9 @@ def device_checkin():
         "wan_ip": wan_ip,
         "locked": device.get("locked", False)
     })
+    if ota_result:
+        record_ota_result(device_id, device, ota_result, running_sha256)
+    finish_grant(device_id, version, running_sha256, ota_result)
     
     # Prüfe ob ein Reboot angefordert wurde
     if device.get("reboot_requested", False):
@@ -144,19 +565,12 @@ def device_checkin():
         # Reboot-Flag zurücksetzen
         device["reboot_requested"] = False
         device["reboot_requested_at"] = ""
+        save_device(device_id, device)
         
-        with open(DEVICE_DB, "w") as f:
-            json.dump(devices, f, indent=2)
-        
-        return jsonify({"reboot": True, "message": "Reboot angefordert"})
+        return checkin_response({"reboot": True, "message": "Reboot angefordert"})
     
-    devices[device_id] = device
-
-    with open(DEVICE_DB, "w") as f:
-        json.dump(devices, f, indent=2)
-
-    with open(LOG_FILE, "a") as log:
-        log.write(f"{now} - {device_id} - {hardware_type} - {ssid} - {version} - {wan_ip}\n")
+    save_device(device_id, device)
+    db.add_checkin(now, device_id, hardware_type, ssid, version, wan_ip)
 
     assigned_firmware = device.get("firmware")
     
@@ -175,9 +589,7 @@ def device_checkin():
                 device["status"] = "Online"
                 
                 # Speichere Änderungen
-                devices[device_id] = device
-                with open(DEVICE_DB, "w") as f:
-                    json.dump(devices, f, indent=2)
+                save_device(device_id, device)
                 
                 response_data = {
                     "update": False,
@@ -186,7 +598,7 @@ def device_checkin():
                     "message": "Aus Force-Update-Schleife befreit"
                 }
                 print(f"Sende Notfall-Fix-Antwort: {response_data}")
-                return jsonify(response_data)
+                return checkin_response(response_data)
     
     # Prüfe ob Force-Update angefordert wurde (unabhängig von zugewiesener Firmware)
     if version == "force":
@@ -217,11 +629,9 @@ def device_checkin():
             fw_version = fw_meta.get("version", "")
             
             # Sende Update nur einmal - ESP32 wird nach erfolgreichem Update mit neuer Version checken
-            response_data = {
-                "update": True, 
-                "url": f"http://{request.host}/firmwares/{assigned_firmware}",
-                "set_version": fw_version  # Setze auf echte Firmware-Version, nicht "force"
-            }
+            # set_version: Setze auf echte Firmware-Version, nicht "force"
+            response_data = update_response(assigned_firmware, running_sha256, set_version=fw_version)
+            dispatch_update(device_id, assigned_firmware, force=True)
             print(f"Sende Force-Update-Antwort: {response_data}")
             
             # Setze Status auf "Update läuft" und merke dir, dass Update gesendet wurde
@@ -230,14 +640,12 @@ def device_checkin():
             device["expected_version"] = fw_version  # Erwartete Version nach Update
             
             # Speichere Änderungen
-            devices[device_id] = device
-            with open(DEVICE_DB, "w") as f:
-                json.dump(devices, f, indent=2)
+            save_device(device_id, device)
             
-            return jsonify(response_data)
+            return checkin_response(response_data)
         else:
             print(f"Keine kompatible Firmware für Force-Update gefunden")
-            return jsonify({"update": False, "locked": False, "reason": "no_firmware_available"})
+            return checkin_response({"update": False, "locked": False, "reason": "no_firmware_available"})
     
     # Prüfe ob das Gerät nach einem Force-Update mit neuer Version zurückgekommen ist
     if device.get("update_sent", False) and device.get("expected_version"):
@@ -254,11 +662,9 @@ def device_checkin():
             device.pop("expected_version", None)
             
             # Speichere Änderungen
-            devices[device_id] = device
-            with open(DEVICE_DB, "w") as f:
-                json.dump(devices, f, indent=2)
+            save_device(device_id, device)
             
-            return jsonify({"update": False, "locked": False, "message": "Update erfolgreich abgeschlossen"})
+            return checkin_response({"update": False, "locked": False, "message": "Update erfolgreich abgeschlossen"})
         elif version != "force":
             print(f"Update-Fehler oder unerwartete Version: Erwartet='{expected_version}', Erhalten='{version}'")
             
@@ -268,11 +674,9 @@ def device_checkin():
             device.pop("update_sent", None)
             device.pop("expected_version", None)
             
-            devices[device_id] = device
-            with open(DEVICE_DB, "w") as f:
-                json.dump(devices, f, indent=2)
+            save_device(device_id, device)
             
-            return jsonify({"update": False, "locked": False, "message": "Update abgeschlossen, aber Version stimmt nicht überein"})
+            return checkin_response({"update": False, "locked": False, "message": "Update abgeschlossen, aber Version stimmt nicht überein"})
     
     print(f"Kein Force-Update - Version ist '{version}', nicht 'force'")
     
@@ -286,44 +690,60 @@ def device_checkin():
         # Prüfe ob Hardware-Typ kompatibel ist
         if fw_hardware_type and fw_hardware_type != hardware_type:
             print(f"Hardware-Typ nicht kompatibel: Gerät={hardware_type}, Firmware={fw_hardware_type}")
-            return jsonify({"update": False, "locked": False, "reason": "hardware_type_mismatch"})
+            return checkin_response({"update": False, "locked": False, "reason": "hardware_type_mismatch"})
         
         # Prüfe ob Version-Update nötig ist
         if fw_version and version != fw_version:
+            if rolled_back_on(device, assigned_firmware):
+                print(f"{device_id} hat {assigned_firmware} bereits verworfen - kein Update")
+                return checkin_response({"update": False, "locked": False, "reason": "rolled_back"})
+            if running_sha256 and running_sha256 == firmware_integrity(assigned_firmware)[1]:
+                # Läuft schon - nur die gemeldete Version ist eine andere
+                return checkin_response({"update": False, "locked": False})
+            if ota_result.get("status") == "pending":
+                # Das Badge installiert erst nach der Bestätigung der laufenden Firmware
+                return checkin_response({"update": False, "locked": False, "reason": "pending_verify"})
+            denied = dispatch_update(device_id, assigned_firmware)
+            if denied:
+                print(f"Update für {device_id} zurückgestellt: {denied}")
+                return checkin_response({"update": False, "locked": False, "reason": denied})
             print(f"Update verfügbar: Aktuell={version}, Verfügbar={fw_version}")
-            return jsonify({"update": True, "url": f"http://{request.host}/firmwares/{assigned_firmware}"})
+            return checkin_response(update_response(assigned_firmware, running_sha256))
         else:
             print(f"Kein Update nötig: Aktuell={version}, Verfügbar={fw_version}")
     
-    return jsonify({"update": False, "locked": False})
+    return checkin_response({"update": False, "locked": False})
+
+@app.route("/api/device_checkin", methods=["POST"])
+def device_checkin():
+    # Lesen, Ändern und Speichern des Geräts am Stück - sonst gehen
+    # gleichzeitige Änderungen (Force-Update, Sperre, Reboot) verloren
+    with devices_lock:
+        return process_checkin()
 
 @app.route("/api/reboot/<device_id>", methods=["POST"])
 def reboot_device(device_id):
     try:
-        if device_id in devices:
-            device = devices[device_id]
-            if device.get("wan_ip"):
-                print(f"Reboot-Anfrage für {device_id} (IP: {device['wan_ip']})")
-                
-                # Da der OTA Server im Internet ist, können wir die ESP32-Geräte 
-                # nicht direkt über ihre lokale IP erreichen
-                # Stattdessen markieren wir das Gerät für einen Reboot beim nächsten Checkin
-                
-                device["reboot_requested"] = True
-                device["reboot_requested_at"] = datetime.utcnow().isoformat()
-                
-                with open(DEVICE_DB, "w") as f:
-                    json.dump(devices, f, indent=2)
-                
-                print(f"Reboot für {device_id} beim nächsten Checkin angefordert")
-                return jsonify({
-                    "success": True, 
-                    "message": f"Reboot für {device_id} angefordert. Das Gerät wird beim nächsten Checkin neustarten."
-                })
-            else:
+        with devices_lock:
+            device = devices.get(device_id)
+            if not device:
+                return jsonify({"success": False, "message": "Gerät nicht gefunden"})
+            if not device.get("wan_ip"):
                 return jsonify({"success": False, "message": f"Keine IP-Adresse für {device_id} verfügbar"})
-        else:
-            return jsonify({"success": False, "message": "Gerät nicht gefunden"})
+            print(f"Reboot-Anfrage für {device_id} (IP: {device['wan_ip']})")
+            
+            # Da der OTA Server im Internet ist, können wir die ESP32-Geräte 
+            # nicht direkt über ihre lokale IP erreichen
+            # Stattdessen markieren wir das Gerät für einen Reboot beim nächsten Checkin
+            device["reboot_requested"] = True
+            device["reboot_requested_at"] = datetime.utcnow().isoformat()
+            save_device(device_id)
+        
+        print(f"Reboot für {device_id} beim nächsten Checkin angefordert")
+        return jsonify({
+            "success": True, 
+            "message": f"Reboot für {device_id} angefordert. Das Gerät wird beim nächsten Checkin neustarten."
+        })
     except Exception as e:
         print(f"Fehler beim Reboot von {device_id}: {str(e)}")
         return jsonify({"success": False, "message": f"Server-Fehler: {str(e)}"})
@@ -331,25 +751,29 @@ def reboot_device(device_id):
 @app.route("/api/devices", methods=["GET"])
 def get_devices():
     """API-Endpunkt für AJAX-Updates der Geräteliste"""
-    now = datetime.utcnow()
-    
-    for dev in devices.values():
-        last_seen = datetime.fromisoformat(dev.get("last_seen", "1970-01-01T00:00:00"))
-        if now - last_seen < timedelta(minutes=2):
-            dev["status"] = dev.get("status") if dev.get("status") == "Update läuft" else "Online"
-        else:
-            dev["status"] = "Offline"
-    
-    return jsonify(devices)
+    return jsonify(devices_snapshot())
 
 @app.route("/api/logs", methods=["GET"])
 def get_logs():
-    """API-Endpunkt für AJAX-Updates der Logs"""
-    search_term = request.args.get("search", "")
-    limit = int(request.args.get("limit", 50))
+    """API-Endpunkt für AJAX-Updates der Logs, neueste zuerst.
+    Parameter: search (Teilstring), device, since/until (ISO-Zeit), limit und
+    cursor (next_cursor der vorigen Antwort für die nächste, ältere Seite)"""
+    try:
+        limit = max(1, min(LOG_PAGE_MAX, int(request.args.get("limit", 50))))
+        cursor = request.args.get("cursor")
+        cursor = int(cursor) if cursor else None
+    except ValueError:
+        return jsonify({"error": "Ungültiger Parameter"}), 400
     
-    entries = get_log_entries(search_term, limit)
-    return jsonify({"logs": entries, "count": len(entries)})
+    rows, next_cursor = db.search_checkins(
+        request.args.get("search", ""),
+        device_id=request.args.get("device", ""),
+        since=request.args.get("since", ""),
+        until=request.args.get("until", ""),
+        before=cursor,
+        limit=limit)
+    entries = [format_checkin(row) for row in rows]
+    return jsonify({"logs": entries, "count": len(entries), "next_cursor": next_cursor})
 
 @app.route("/api/stats", methods=["GET"])
 def get_stats():
@@ -358,8 +782,9 @@ def get_stats():
     
     online_count = 0
     locked_count = 0
+    snapshot = devices_snapshot()
     
-    for dev in devices.values():
+    for dev in snapshot.values():
         last_seen = datetime.fromisoformat(dev.get("last_seen", "1970-01-01T00:00:00"))
         if now - last_seen < timedelta(minutes=2):
             online_count += 1
@@ -367,7 +792,7 @@ def get_stats():
             locked_count += 1
     
     stats = {
-        "total_devices": len(devices),
+        "total_devices": len(snapshot),
         "online_devices": online_count,
         "locked_devices": locked_count,
         "available_firmwares": len(os.listdir(FIRMWARE_DIR))
@@ -375,30 +800,85 @@ def get_stats():
     
     return jsonify(stats)
 
+@app.route("/api/rollout", methods=["GET"])
+def get_rollouts():
+    """Rollouts aller Firmwares und laufende Downloads"""
+    with metadata_lock:
+        filenames = list(firmware_metadata)
+    rollouts = rollout_snapshot([fw for fw in filenames if os.path.exists(os.path.join(FIRMWARE_DIR, fw))])
+    return jsonify({"rollouts": rollouts, "dispatch": dispatch_status()})
+
+@app.route("/api/rollout/<filename>", methods=["POST"])
+def set_rollout_api(filename):
+    """Rollout ändern: {"percent": 10, "max_rollbacks": 2, "paused": false}"""
+    if filename not in firmware_metadata:
+        return jsonify({"error": "Unbekannte Firmware"}), 404
+    data = request.get_json() or {}
+    try:
+        max_rollbacks = data.get("max_rollbacks", data.get("max_failures"))  # Früherer Name
+        rollout = update_rollout(filename, data.get("percent"), max_rollbacks, data.get("paused"))
+    except (TypeError, ValueError):
+        return jsonify({"error": "Ungültige Werte"}), 400
+    return jsonify(rollout)
+
+@app.route("/rollout/<filename>", methods=["POST"])
+def set_rollout(filename):
+    if filename in firmware_metadata:
+        try:
+            update_rollout(filename, request.form.get("percent"), request.form.get("max_rollbacks"))
+            flash(f"Rollout für {filename} geändert.", "success")
+        except (TypeError, ValueError):
+            flash("Ungültige Rollout-Werte.", "error")
+    return redirect(url_for('index'))
+
+@app.route("/rollout/<filename>/pause")
+def pause_rollout(filename):
+    if filename in firmware_metadata:
+        update_rollout(filename, paused=True)
+        flash(f"Rollout für {filename} angehalten.", "warning")
+    return redirect(url_for('index'))
+
+@app.route("/rollout/<filename>/resume")
+def resume_rollout(filename):
+    if filename in firmware_metadata:
+        update_rollout(filename, paused=False)
+        flash(f"Rollout für {filename} fortgesetzt.", "success")
+    return redirect(url_for('index'))
+
 @app.route("/firmwares/<filename>")
 def download_firmware(filename):
-    return send_from_directory(FIRMWARE_DIR, filename)
+    # conditional=True beantwortet Range-Anfragen mit 206 - abgebrochene
+    # Downloads setzt das Gerät dort fort, wo sie abgerissen sind
+    return send_from_directory(FIRMWARE_DIR, filename, conditional=True)
+
+@app.route("/deltas/<filename>")
+def download_delta(filename):
+    return send_from_directory(DELTA_DIR, filename, conditional=True)
+
+@app.route("/compressed/<filename>")
+def download_compressed(filename):
+    return send_from_directory(COMPRESSED_DIR, filename, conditional=True)
 
 @app.route("/force_update/<device_id>")
 def force_update(device_id):
     print(f"Force-Update angefordert für {device_id}")
     
-    if device_id in devices:
-        devices[device_id]["version"] = "force"
-        devices[device_id]["status"] = "Update läuft"
-        print(f"Version für {device_id} auf 'force' gesetzt")
-    else:
-        # Gerät noch nicht in DB - erstelle Eintrag
-        devices[device_id] = {
-            "version": "force",
-            "status": "Update läuft",
-            "last_seen": datetime.utcnow().isoformat(),
-            "hardware_type": "LED-Modd.Badge"
-        }
-        print(f"Neues Gerät {device_id} mit Version 'force' erstellt")
-    
-    with open(DEVICE_DB, "w") as f:
-        json.dump(devices, f, indent=2)
+    with devices_lock:
+        if device_id in devices:
+            devices[device_id]["version"] = "force"
+            devices[device_id]["status"] = "Update läuft"
+            devices[device_id].pop("rollback", None)  # Bewusst erneut versuchen
+            print(f"Version für {device_id} auf 'force' gesetzt")
+        else:
+            # Gerät noch nicht in DB - erstelle Eintrag
+            devices[device_id] = {
+                "version": "force",
+                "status": "Update läuft",
+                "last_seen": datetime.utcnow().isoformat(),
+                "hardware_type": "LED-Modd.Badge"
+            }
+            print(f"Neues Gerät {device_id} mit Version 'force' erstellt")
+        save_device(device_id)
     
     flash(f"Update für {device_id} forciert.", "info")
     return redirect(url_for('index'))
@@ -407,12 +887,12 @@ def force_update(device_id):
 def set_type(device_id):
     dtype = request.form.get("type")
     firmware = request.form.get("firmware")
-    if device_id in devices:
-        devices[device_id]["type"] = dtype
-        devices[device_id]["firmware"] = firmware
-        with open(DEVICE_DB, "w") as f:
-            json.dump(devices, f, indent=2)
-        flash(f"Gerät {device_id} aktualisiert.", "success")
+    with devices_lock:
+        if device_id in devices:
+            devices[device_id]["type"] = dtype
+            devices[device_id]["firmware"] = firmware
+            save_device(device_id)
+            flash(f"Gerät {device_id} aktualisiert.", "success")
     return redirect(url_for('index'))
 
 @app.route("/upload", methods=["POST"])
@@ -426,62 +906,66 @@ def upload():
         filepath = os.path.join(FIRMWARE_DIR, filename)
         file.save(filepath)
         
+        # Neue Firmware zuerst nur an einen Teil der Geräte (Kanarienvögel)
+        try:
+            rollout_percent = int(request.form.get('rollout_percent', ROLLOUT_DEFAULT_PERCENT))
+        except ValueError:
+            rollout_percent = ROLLOUT_DEFAULT_PERCENT
+        
         # Metadaten für die Firmware speichern
-        firmware_metadata[filename] = {
-            "version": version,
-            "hardware_type": hardware_type,
-            "upload_date": datetime.utcnow().isoformat(),
-            "file_size": os.path.getsize(filepath)
-        }
+        with metadata_lock:
+            firmware_metadata[filename] = {
+                "version": version,
+                "hardware_type": hardware_type,
+                "upload_date": datetime.utcnow().isoformat(),
+                "file_size": os.path.getsize(filepath)
+            }
+            rollout_policy(filename)["percent"] = max(0, min(100, rollout_percent))
+            save_firmware_metadata()
+        _, target_sha = firmware_integrity(filename)  # SHA-256 berechnen und speichern
+        start_compressed(filename, target_sha)
         
-        with open(FIRMWARE_METADATA_FILE, "w") as f:
-            json.dump(firmware_metadata, f, indent=2)
+        # Deltas von den bisherigen Firmwares gleichen Typs vorbereiten
+        with metadata_lock:
+            others = list(firmware_metadata.items())
+        for other, meta in others:
+            if other != filename and meta.get("hardware_type") == hardware_type and meta.get("sha256"):
+                start_delta(other, meta["sha256"], filename, target_sha)
         
         flash(f"Firmware hochgeladen: {filename} (v{version}, {hardware_type})", "success")
     return redirect(url_for('index'))
 
 @app.route("/lock/<device_id>")
 def lock(device_id):
-    if device_id in devices:
-        devices[device_id]["locked"] = True
-        flash(f"Gerät {device_id} gesperrt.", "warning")
-        with open(DEVICE_DB, "w") as f:
-            json.dump(devices, f, indent=2)
+    with devices_lock:
+        if device_id in devices:
+            devices[device_id]["locked"] = True
+            save_device(device_id)
+            flash(f"Gerät {device_id} gesperrt.", "warning")
     return redirect(url_for('index'))
 
 @app.route("/unlock/<device_id>")
 def unlock(device_id):
-    if device_id in devices:
-        devices[device_id]["locked"] = False
-        flash(f"Gerät {device_id} entsperrt.", "success")
-        with open(DEVICE_DB, "w") as f:
-            json.dump(devices, f, indent=2)
+    with devices_lock:
+        if device_id in devices:
+            devices[device_id]["locked"] = False
+            save_device(device_id)
+            flash(f"Gerät {device_id} entsperrt.", "success")
     return redirect(url_for('index'))
 
 @app.route("/delete/<device_id>")
 def delete_device(device_id):
     if device_id in devices:
-        del devices[device_id]
+        delete_device_record(device_id)
         flash(f"Gerät {device_id} gelöscht.", "info")
-        with open(DEVICE_DB, "w") as f:
-            json.dump(devices, f, indent=2)
     return redirect(url_for('index'))
 
 @app.route("/")
 def index():
-    # Log-Bereinigung alle 7 Tage
-    cleanup_old_logs()
-    
     log_entries = get_log_entries(limit=50)
     available_firmwares = os.listdir(FIRMWARE_DIR)
     now = datetime.utcnow()
-
-    for dev in devices.values():
-        last_seen = datetime.fromisoformat(dev.get("last_seen", "1970-01-01T00:00:00"))
-        if now - last_seen < timedelta(minutes=2):
-            dev["status"] = dev.get("status") if dev.get("status") == "Update läuft" else "Online"
-        else:
-            dev["status"] = "Offline"
+    device_list = devices_snapshot()
 
     html = '''
     <!DOCTYPE html>
@@ -682,7 +1166,7 @@ def index():
                             <p class="text-muted">Wähle eine .bin Datei für dein LED Badge</p>
                             
                             <div class="row">
-                                <div class="col-md-6">
+                                <div class="col-md-4">
                                     <label class="form-label">Firmware-Datei:</label>
                                     <input type="file" name="firmware" class="form-control" accept=".bin" required>
                                 </div>
@@ -699,6 +1183,10 @@ def index():
                                         <option value="LED-Badge-Mini">LED-Badge-Mini</option>
                                     </select>
                                 </div>
+                                <div class="col-md-2">
+                                    <label class="form-label">Rollout %:</label>
+                                    <input type="number" name="rollout_percent" class="form-control" min="0" max="100" value="100">
+                                </div>
                             </div>
                             
                             <button type="submit" class="btn btn-primary mt-3">
@@ -709,6 +1197,68 @@ def index():
                 </div>
             </div>
 
+            <!-- Rollouts -->
+            <div class="card mb-4">
+                <div class="card-header d-flex justify-content-between align-items-center">
+                    <h5 class="mb-0"><i class="fas fa-layer-group me-2"></i>Rollouts</h5>
+                    <small>
+                        Downloads: {{ dispatch.active|length }} / {{ dispatch.max_concurrent }},
+                        {{ dispatch.rate_per_min }} Freigaben pro Minute
+                    </small>
+                </div>
+                <div class="card-body">
+                    {% if rollouts %}
+                        {% for fw, rollout in rollouts.items() %}
+                            <div class="row align-items-center mb-3">
+                                <div class="col-md-4">
+                                    <strong>{{ fw }}</strong>
+                                    {% if firmware_metadata[fw].get('version') %}(v{{ firmware_metadata[fw].get('version') }}){% endif %}<br>
+                                    {% if rollout.paused %}
+                                        <span class="badge bg-danger">Pausiert: {{ rollout.pause_reason }}</span>
+                                    {% else %}
+                                        <span class="badge bg-success">Aktiv, {{ rollout.percent }} %</span>
+                                    {% endif %}
+                                    <small class="text-muted d-block">
+                                        {{ rollout.granted }} freigegeben, {{ rollout.completed }} installiert,
+                                        {{ rollout.confirmations }} bestätigt, {{ rollout.rollbacks }} Rollbacks,
+                                        {{ rollout.failures }} Fehlschläge
+                                    </small>
+                                </div>
+                                <div class="col-md-6">
+                                    <form action="/rollout/{{ fw }}" method="post" class="row g-2">
+                                        <div class="col-5">
+                                            <div class="input-group input-group-sm">
+                                                <input type="number" name="percent" min="0" max="100" value="{{ rollout.percent }}" class="form-control">
+                                                <span class="input-group-text">%</span>
+                                            </div>
+                                        </div>
+                                        <div class="col-4">
+                                            <input type="number" name="max_rollbacks" min="1" value="{{ rollout.max_rollbacks }}" class="form-control form-control-sm" title="Pause ab so vielen Rollbacks">
+                                        </div>
+                                        <div class="col-3">
+                                            <button type="submit" class="btn btn-primary btn-sm w-100">Setzen</button>
+                                        </div>
+                                    </form>
+                                </div>
+                                <div class="col-md-2">
+                                    {% if rollout.paused %}
+                                        <a href="/rollout/{{ fw }}/resume" class="btn btn-success btn-sm w-100">
+                                            <i class="fas fa-play me-1"></i>Fortsetzen
+                                        </a>
+                                    {% else %}
+                                        <a href="/rollout/{{ fw }}/pause" class="btn btn-warning btn-sm w-100">
+                                            <i class="fas fa-pause me-1"></i>Anhalten
+                                        </a>
+                                    {% endif %}
+                                </div>
+                            </div>
+                        {% endfor %}
+                    {% else %}
+                        <p class="text-muted mb-0">Noch keine Firmware hochgeladen.</p>
+                    {% endif %}
+                </div>
+            </div>
+
             <!-- Geräte -->
             <div class="card">
                 <div class="card-header d-flex justify-content-between align-items-center">
@@ -733,7 +1283,7 @@ def index():
                                                         <strong>Typ:</strong> {{ info.hardware_type or info.type }}
                                                     </small>
                                                 </div>
-                                                <span class="badge {% if info.status == 'Online' %}bg-success{% elif info.status == 'Update läuft' %}bg-warning{% else %}bg-danger{% endif %}">
+                                                <span class="badge {% if info.status == 'Online' %}bg-success{% elif info.status in ('Update läuft', 'Prüfung') %}bg-warning{% else %}bg-danger{% endif %}">
                                                     {{ info.status }}
                                                 </span>
                                             </div>
@@ -760,6 +1310,14 @@ def index():
                                                 </div>
                                             </div>
 
+                                            {% if info.rollback %}
+                                                <div class="alert alert-danger py-1 px-2 mb-3 small">
+                                                    <i class="fas fa-undo me-1"></i>
+                                                    Rollback: {{ info.rollback.firmware or info.rollback.sha256[:16] }}
+                                                    ({{ info.rollback.reason }}, {{ info.rollback.at[:16] }})
+                                                </div>
+                                            {% endif %}
+
                                             <form action="/set_type/{{ dev_id }}" method="post" class="mb-3">
                                                 <div class="row">
                                                     <div class="col-6">
@@ -851,6 +1409,9 @@ def index():
                             <div class="log-entry">{{ entry.strip() }}</div>
                         {% endfor %}
                     </div>
+                    <button id="logMore" onclick="loadOlderLogs()" class="btn btn-outline-secondary btn-sm mt-2" style="display: none;">
+                        <i class="fas fa-chevron-down me-1"></i>Ältere laden
+                    </button>
                 </div>
             </div>
         </div>
@@ -905,16 +1466,25 @@ def index():
                     });
             }
             
-            function updateLogs() {
+            // Cursor der nächsten (älteren) Seite, null = keine weitere
+            let logCursor = null;
+            
+            function fetchLogs(cursor) {
                 const searchTerm = document.getElementById('logSearch').value;
                 const limit = document.getElementById('logLimit').value;
+                let url = `/api/logs?search=${encodeURIComponent(searchTerm)}&limit=${limit}`;
+                if (cursor !== null) {
+                    url += `&cursor=${cursor}`;
+                }
                 
                 showUpdateIndicator();
-                fetch(`/api/logs?search=${encodeURIComponent(searchTerm)}&limit=${limit}`)
+                return fetch(url)
                     .then(response => response.json())
                     .then(data => {
                         const logContainer = document.getElementById('logContainer');
-                        logContainer.innerHTML = '';
+                        if (cursor === null) {
+                            logContainer.innerHTML = '';
+                        }
                         
                         data.logs.forEach(entry => {
                             const logEntry = document.createElement('div');
@@ -923,8 +1493,23 @@ def index():
                             logContainer.appendChild(logEntry);
                         });
                         
+                        logCursor = data.next_cursor;
+                        document.getElementById('logMore').style.display = logCursor === null ? 'none' : '';
                         hideUpdateIndicator();
-                    })
+                    });
+            }
+            
+            function loadOlderLogs() {
+                if (logCursor !== null) {
+                    fetchLogs(logCursor).catch(error => {
+                        console.error('Fehler beim Laden älterer Logs:', error);
+                        hideUpdateIndicator();
+                    });
+                }
+            }
+            
+            function updateLogs() {
+                fetchLogs(null)
                     .catch(error => {
                         console.error('Fehler beim Aktualisieren der Logs:', error);
                         hideUpdateIndicator();
@@ -987,14 +1572,17 @@ def index():
                 // Statistiken alle 30 Sekunden aktualisieren
                 setInterval(updateStats, 30000);
                 
-                // Logs alle 60 Sekunden aktualisieren
+                // Logs sofort (mit Blätter-Cursor) und dann alle 60 Sekunden aktualisieren
+                updateLogs();
                 setInterval(updateLogs, 60000);
             });
         </script>
     </body>
     </html>
     '''
-    return render_template_string(html, devices=devices, logs=log_entries, available_firmwares=available_firmwares, firmware_metadata=firmware_metadata, now=now)
+    rollouts = rollout_snapshot(available_firmwares)
+    return render_template_string(html, devices=device_list, log_entries=log_entries, available_firmwares=available_firmwares, firmware_metadata=metadata_snapshot(), now=now,
+                                  rollouts=rollouts, dispatch=dispatch_status())
 
 if __name__ == "__main__":
     app.run(host="0.0.0.0", port=5000, debug=True)
\ No newline at end of file
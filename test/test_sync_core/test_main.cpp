@@ -0,0 +1,301 @@
+// Host-Tests für SyncCore: simulierte Badges mit eigener Quarz-Drift tauschen
+// Beacons und NTP-Messungen über ein Netz mit Latenz, Jitter und Ausreißern.
+// Ablauf wie in TimeSync.cpp (Beacon jede Sekunde, Messung alle 0,5 s bzw.
+// 2 s, neue Wahl alle 100 ms).
+//
+//   pio test -e native
+
+#include <unity.h>
+#include "SyncCore.h"
+
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+#define SIM_STEP_US 10000LL              // Auflösung der Simulation
+#define SIM_ELECTION_US 100000LL         // TIME_SYNC_ELECTION_MS
+#define SIM_BEACON_US 1000000LL          // TIME_SYNC_BEACON_MS
+#define SIM_REQUEST_FAST_US 500000LL     // TIME_SYNC_REQUEST_FAST_MS
+#define SIM_REQUEST_SLOW_US 2000000LL    // TIME_SYNC_REQUEST_SLOW_MS
+
+// Einweg-Laufzeit im simulierten WLAN, dazu Ausreißer
+#define SIM_LATENCY_MIN_US 1000
+#define SIM_LATENCY_MAX_US 15000
+
+// Eine NTP-Messung kann die Asymmetrie von Hin- und Rückweg nicht sehen: jeder
+// Follower liegt bis zur halben Differenz neben dem Leader, zwei Follower
+// zusammen also bis zur ganzen. Dazu 1 ms für Drift zwischen den Messungen.
+#define SIM_MAX_SPREAD_US (SIM_LATENCY_MAX_US - SIM_LATENCY_MIN_US + 1000)
+
+struct SimNode {
+    uint32_t id;
+    double drift;        // relative Gangabweichung des Quarzes
+    int64_t offset;      // lokaler Zähler beim Simulationsstart
+    int64_t joinAt;
+    bool started;
+    bool alive;          // false nach kill()
+    ClockSync clock;
+    SyncElection election;
+    uint32_t leader;
+    uint32_t leaderChanges;
+    int64_t pendingT1;
+    int64_t nextBeacon;
+    int64_t nextRequest;
+    int64_t nextElection;
+
+    int64_t local(int64_t t) const { return offset + (int64_t)(t * (1.0 + drift)); }
+    int64_t shared(int64_t t) const { return clock.toShared(local(t)); }
+};
+
+class Simulation {
+public:
+    explicit Simulation(uint32_t seed) : now(0), rng(seed) {}
+
+    int addNode(uint32_t id, double driftPpm, int64_t offset, int64_t joinAt = 0) {
+        SimNode node = {};
+        node.id = id;
+        node.drift = driftPpm * 1e-6;
+        node.offset = offset;
+        node.joinAt = joinAt;
+        nodes.push_back(node);
+        return (int)nodes.size() - 1;
+    }
+
+    void kill(int index) { nodes[index].alive = false; }
+
+    void runUntil(int64_t end) {
+        for (; now <= end; now += SIM_STEP_US) {
+            while (!events.empty() && events.top().at <= now) {
+                Event event = events.top();
+                events.pop();
+                event.run();
+            }
+            for (size_t i = 0; i < nodes.size(); i++) {
+                step((int)i);
+            }
+        }
+    }
+
+    SimNode& node(int index) { return nodes[index]; }
+
+    // Gemeinsamer Leader aller laufenden Badges, 0 ohne Einigkeit
+    uint32_t agreedLeader() const {
+        uint32_t leader = 0;
+        for (const SimNode& node : nodes) {
+            if (!node.alive) continue;
+            if (node.leader == 0 || (leader != 0 && node.leader != leader)) return 0;
+            leader = node.leader;
+        }
+        return leader;
+    }
+
+    // Größter Abstand der gemeinsamen Zeit zwischen laufenden Badges
+    int64_t spreadUs() const {
+        bool first = true;
+        int64_t low = 0, high = 0;
+        for (const SimNode& node : nodes) {
+            if (!node.alive) continue;
+            int64_t shared = node.shared(now);
+            if (first || shared < low) low = shared;
+            if (first || shared > high) high = shared;
+            first = false;
+        }
+        return high - low;
+    }
+
+    int64_t time() const { return now; }
+
+private:
+    struct Event {
+        int64_t at;
+        std::function<void()> run;
+        bool operator<(const Event& other) const { return at > other.at; }
+    };
+
+    // Jedes 20. Paket zusätzlich 50-200 ms (WLAN-Powersave, Retries)
+    int64_t latency() {
+        int64_t delay = std::uniform_int_distribution<int>(SIM_LATENCY_MIN_US, SIM_LATENCY_MAX_US)(rng);
+        if (std::uniform_int_distribution<int>(0, 19)(rng) == 0) {
+            delay += std::uniform_int_distribution<int>(50000, 200000)(rng);
+        }
+        return delay;
+    }
+
+    void send(int64_t delay, std::function<void()> run) {
+        events.push({now + delay, run});
+    }
+
+    void step(int i) {
+        SimNode& self = nodes[i];
+        if (!self.started) {
+            if (now < self.joinAt) return;
+            self.started = true;
+            self.alive = true;
+            self.election.begin(self.id, self.local(now));
+            self.nextBeacon = self.nextRequest = self.nextElection = now;
+        }
+        if (!self.alive) return;
+
+        if (now >= self.nextElection) {
+            self.nextElection = now + SIM_ELECTION_US;
+            uint32_t leader = self.election.update(self.local(now));
+            if (leader != self.leader) {
+                if (leader != self.id) {
+                    self.clock.resetSamples();
+                }
+                self.leader = leader;
+                self.leaderChanges++;
+            }
+        }
+
+        if (now >= self.nextBeacon) {
+            self.nextBeacon = now + SIM_BEACON_US;
+            bool eligible = self.election.isEligible();
+            for (size_t j = 0; j < nodes.size(); j++) {
+                if ((int)j == i) continue;
+                send(latency(), [this, i, j, eligible]() {
+                    SimNode& peer = nodes[j];
+                    if (peer.alive && nodes[i].alive) {
+                        peer.election.onBeacon(nodes[i].id, eligible, (uint32_t)i, peer.local(now));
+                    }
+                });
+            }
+        }
+
+        if (self.leader != 0 && self.leader != self.id && now >= self.nextRequest) {
+            self.nextRequest = now + (self.clock.isSynced() ? SIM_REQUEST_SLOW_US : SIM_REQUEST_FAST_US);
+            int leaderIndex = (int)self.election.leaderAddress();
+            int64_t t1 = self.local(now);
+            self.pendingT1 = t1;
+            send(latency(), [this, i, leaderIndex, t1]() {
+                SimNode& leader = nodes[leaderIndex];
+                if (!leader.alive) return;
+                int64_t t2 = leader.shared(now);
+                int64_t processing = std::uniform_int_distribution<int>(0, 3000)(rng);
+                int64_t t3 = leader.clock.toShared(leader.local(now + processing));
+                uint32_t leaderId = leader.id;
+                send(processing + latency(), [this, i, leaderId, t1, t2, t3]() {
+                    SimNode& self = nodes[i];
+                    if (!self.alive || self.pendingT1 != t1 || self.leader != leaderId) return;
+                    self.pendingT1 = 0;
+                    self.clock.addSample(t1, t2, t3, self.local(now));
+                    self.election.setClockSynced(self.clock.isSynced());
+                });
+            });
+        }
+    }
+
+    int64_t now;
+    std::mt19937 rng;
+    std::vector<SimNode> nodes;
+    std::priority_queue<Event> events;
+};
+
+// Vier Badges mit bis zu ±40 ppm und beliebigen Startzählern
+static void addFleet(Simulation& sim) {
+    sim.addNode(500, 40, 1000000);
+    sim.addNode(300, -30, 50000000);
+    sim.addNode(900, 10, 300000000);
+    sim.addNode(700, 25, 900000000);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_clock_sync_filters_jitter() {
+    ClockSync clock;
+    // Leader 5 s voraus, Laufzeit 10 ms; eine Messung mit 200 ms Verzögerung
+    // auf dem Rückweg darf das Ergebnis nicht verschieben
+    const int64_t offset = 5000000;
+    for (int i = 0; i < SYNC_FILTER_SAMPLES; i++) {
+        int64_t t1 = 1000000LL + i * 500000LL;
+        int64_t back = (i == 4) ? 200000 : 5000;
+        int64_t t2 = t1 + 5000 + offset;
+        int64_t t3 = t2 + 100;
+        clock.addSample(t1, t2, t3, t3 - offset + back);
+    }
+    TEST_ASSERT_TRUE(clock.isSynced());
+    int64_t local = 6000000;
+    TEST_ASSERT_INT64_WITHIN(500, local + offset, clock.toShared(local));
+}
+
+void test_single_leader_elected() {
+    Simulation sim(1);
+    addFleet(sim);
+    sim.runUntil(15000000);
+
+    // Kleinste ID unter den Startenden führt, alle sind sich einig
+    TEST_ASSERT_EQUAL_UINT32(300, sim.agreedLeader());
+    TEST_ASSERT_LESS_THAN_INT64(SIM_MAX_SPREAD_US, sim.spreadUs());
+}
+
+void test_clocks_stay_together_with_drift() {
+    Simulation sim(2);
+    addFleet(sim);
+    sim.runUntil(30000000);
+
+    // Zwei Minuten lang in jedem Schritt - auch nach Latenz-Ausreißern
+    int64_t worst = 0;
+    for (int64_t t = 30000000; t <= 150000000; t += 1000000) {
+        sim.runUntil(t);
+        if (sim.spreadUs() > worst) worst = sim.spreadUs();
+    }
+    TEST_ASSERT_EQUAL_UINT32(300, sim.agreedLeader());
+    TEST_ASSERT_LESS_THAN_INT64(SIM_MAX_SPREAD_US, worst);
+}
+
+void test_late_low_id_joins_without_jump() {
+    Simulation sim(3);
+    addFleet(sim);
+    int late = sim.addNode(100, -50, 7000000, 20000000);
+    sim.runUntil(19990000);
+    uint32_t changesBefore = sim.node(0).leaderChanges;
+
+    // Übernimmt erst, wenn die eigene Uhr schon zur Gruppe passt
+    int64_t worst = 0;
+    for (int64_t t = 20000000; t <= 60000000; t += 100000) {
+        sim.runUntil(t);
+        if (sim.node(late).election.isLeader()) {
+            TEST_ASSERT_TRUE(sim.node(late).clock.isSynced());
+        }
+        if (t >= 30000000 && sim.spreadUs() > worst) worst = sim.spreadUs();
+    }
+    TEST_ASSERT_EQUAL_UINT32(100, sim.agreedLeader());
+    TEST_ASSERT_EQUAL_UINT32(changesBefore + 1, sim.node(0).leaderChanges);
+    TEST_ASSERT_LESS_THAN_INT64(SIM_MAX_SPREAD_US, worst);
+}
+
+void test_leader_failure_hands_over() {
+    Simulation sim(4);
+    addFleet(sim);
+    sim.runUntil(40000000);
+    TEST_ASSERT_EQUAL_UINT32(300, sim.agreedLeader());
+
+    sim.kill(1);  // ID 300
+    int64_t killedAt = sim.time();
+
+    // Nach dem Peer-Timeout übernimmt die nächstkleinere ID
+    int64_t handover = 0;
+    int64_t worst = 0;
+    for (int64_t t = killedAt; t <= killedAt + 60000000; t += 100000) {
+        sim.runUntil(t);
+        if (handover == 0 && sim.agreedLeader() == 500) handover = t - killedAt;
+        if (sim.spreadUs() > worst) worst = sim.spreadUs();
+    }
+    TEST_ASSERT_EQUAL_UINT32(500, sim.agreedLeader());
+    TEST_ASSERT_NOT_EQUAL(0, handover);
+    TEST_ASSERT_LESS_OR_EQUAL_INT64(SYNC_PEER_TIMEOUT_US + 2 * SIM_BEACON_US, handover);
+    // Die Gruppenzeit läuft beim Wechsel ohne Sprung weiter
+    TEST_ASSERT_LESS_THAN_INT64(SIM_MAX_SPREAD_US, worst);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_clock_sync_filters_jitter);
+    RUN_TEST(test_single_leader_elected);
+    RUN_TEST(test_clocks_stay_together_with_drift);
+    RUN_TEST(test_late_low_id_joins_without_jump);
+    RUN_TEST(test_leader_failure_hands_over);
+    return UNITY_END();
+}
@@ -0,0 +1,113 @@
+"""
+Steuert ein oder viele Badges über das binäre UDP-Protokoll (src/UdpControl.h).
+Auf den Badges muss die Gruppensteuerung eingeschaltet sein (Netzwerk-Seite,
+standardmäßig aus).
+
+Beispiele:
+  python3 tools/badge_udp.py --mode 1 --primary 160           # alle per Multicast
+  python3 tools/badge_udp.py --target 192.168.1.42 --brightness 80
+  python3 tools/badge_udp.py --target 255.255.255.255 --mode 6 --persist
+  python3 tools/badge_udp.py --ack                             # Badges suchen (nur Status)
+
+Die Sequenznummer wird aus der Uhrzeit abgeleitet, damit sie auch über
+Neustarts des Skripts hinweg steigt. Mit --repeat wird dasselbe Paket
+mehrfach gesendet - Badges verwerfen die Duplikate.
+"""
+
+import argparse
+import socket
+import struct
+import time
+
+PORT = 4210
+MULTICAST_GROUP = "239.255.42.42"
+
+MAGIC = b"BL"
+VERSION = 1
+TYPE_SET = 0x01
+TYPE_STATUS = 0x02
+
+FIELD_MODE = 0x01
+FIELD_PRIMARY = 0x02
+FIELD_SECONDARY = 0x04
+FIELD_BRIGHTNESS = 0x08
+FIELD_SPEED = 0x10
+
+FLAG_ACK = 0x01
+FLAG_PERSIST = 0x02
+
+# magic(2) version type sequence fields flags mode primary secondary brightness speed
+PACKET = struct.Struct("<2sBBIBBBBBBH")
+
+
+def build_packet(sequence, args):
+    fields = 0
+    values = {"mode": 0, "primary": 0, "secondary": 0, "brightness": 0, "speed": 0}
+    for name, bit in (("mode", FIELD_MODE), ("primary", FIELD_PRIMARY), ("secondary", FIELD_SECONDARY),
+                      ("brightness", FIELD_BRIGHTNESS), ("speed", FIELD_SPEED)):
+        value = getattr(args, name)
+        if value is not None:
+            fields |= bit
+            values[name] = value
+    flags = (FLAG_ACK if args.ack else 0) | (FLAG_PERSIST if args.persist else 0)
+    return PACKET.pack(MAGIC, VERSION, TYPE_SET, sequence, fields, flags,
+                       values["mode"], values["primary"], values["secondary"],
+                       values["brightness"], values["speed"])
+
+
+def print_status(data, address):
+    if len(data) < PACKET.size:
+        return
+    magic, version, ptype, sequence, _, _, mode, primary, secondary, brightness, speed = \
+        PACKET.unpack_from(data)
+    if magic != MAGIC or version != VERSION or ptype != TYPE_STATUS:
+        return
+    print("%-15s  Modus %2d  Farben %3d/%3d  Helligkeit %3d  Tempo %4d ms  (Seq %d)" % (
+        address[0], mode, primary, secondary, brightness, speed, sequence))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Badges per UDP steuern")
+    parser.add_argument("--target", default=MULTICAST_GROUP,
+                        help="Ziel-IP, Broadcast oder Multicast-Gruppe (Standard: %(default)s)")
+    parser.add_argument("--port", type=int, default=PORT)
+    parser.add_argument("--mode", type=int, choices=range(25), metavar="0-24")
+    parser.add_argument("--primary", type=int, choices=range(256), metavar="0-255")
+    parser.add_argument("--secondary", type=int, choices=range(256), metavar="0-255")
+    parser.add_argument("--brightness", type=int, choices=range(256), metavar="0-255")
+    parser.add_argument("--speed", type=int, choices=range(1, 65536), metavar="1-65535")
+    parser.add_argument("--persist", action="store_true", help="Werte auf den Badges speichern")
+    parser.add_argument("--ack", action="store_true", help="Status-Antworten der Badges anzeigen")
+    parser.add_argument("--repeat", type=int, default=2, help="Paket so oft senden (Standard: %(default)s)")
+    parser.add_argument("--wait", type=float, default=1.0, help="Wartezeit auf Antworten in Sekunden")
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_BROADCAST, 1)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, 1)
+
+    sequence = int(time.time() * 1000) & 0xFFFFFFFF
+    packet = build_packet(sequence, args)
+    for _ in range(max(1, args.repeat)):
+        sock.sendto(packet, (args.target, args.port))
+        time.sleep(0.005)
+
+    if not args.ack:
+        return
+
+    sock.settimeout(0.1)
+    deadline = time.time() + args.wait
+    seen = set()
+    while time.time() < deadline:
+        try:
+            data, address = sock.recvfrom(64)
+        except socket.timeout:
+            continue
+        if address[0] not in seen:
+            seen.add(address[0])
+            print_status(data, address)
+    print("%d Badge(s) geantwortet" % len(seen))
+
+
+if __name__ == "__main__":
+    main()
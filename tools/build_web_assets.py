@@ -0,0 +1,139 @@
+"""
+Erzeugt src/WebAssets.h aus den HTML-Seiten in web/.
+
+Jede Seite wird konservativ minifiziert (Kommentare, Einrückung und Leerzeilen
+entfernen), mit gzip komprimiert und als PROGMEM-Array samt starkem ETag
+abgelegt. Der Webserver liefert die Bytes unverändert mit
+"Content-Encoding: gzip" aus.
+
+Läuft automatisch vor jedem Build (platformio.ini: extra_scripts = pre:...)
+oder manuell:  python3 tools/build_web_assets.py
+"""
+
+import gzip
+import hashlib
+import os
+import re
+
+try:
+    Import("env")  # noqa: F821 - von PlatformIO/SCons bereitgestellt
+    PROJECT_DIR = env.subst("$PROJECT_DIR")  # noqa: F821
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+WEB_DIR = os.path.join(PROJECT_DIR, "web")
+OUTPUT_FILE = os.path.join(PROJECT_DIR, "src", "WebAssets.h")
+
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+}
+
+
+def minify(text):
+    """Entfernt nur, was sicher überflüssig ist - Zeilenumbrüche bleiben
+    erhalten, damit JavaScript ohne Semikolons weiterhin funktioniert."""
+    text = re.sub(r"<!--(?!\[if).*?-->", "", text, flags=re.S)
+    lines = []
+    in_script = False
+    in_pre = False
+    for raw in text.split("\n"):
+        line = raw if in_pre else raw.strip()
+        lower = line.lower()
+        if "<script" in lower:
+            in_script = True
+        if "<pre" in lower or "<textarea" in lower:
+            in_pre = True
+        if not line:
+            pass
+        elif in_script and line.startswith("//"):
+            pass  # Reine Kommentarzeile im Skript
+        else:
+            lines.append(line)
+        if "</script>" in lower:
+            in_script = False
+        if "</pre>" in lower or "</textarea>" in lower:
+            in_pre = False
+    return "\n".join(lines)
+
+
+def symbol_for(filename):
+    return re.sub(r"[^A-Za-z0-9]", "_", filename).upper()
+
+
+def build_asset(path):
+    filename = os.path.basename(path)
+    ext = os.path.splitext(filename)[1].lower()
+    with open(path, "r", encoding="utf-8") as f:
+        source = f.read()
+    minified = minify(source).encode("utf-8")
+    # mtime=0: gleicher Inhalt ergibt gleiche Bytes und damit gleichen ETag
+    compressed = gzip.compress(minified, compresslevel=9, mtime=0)
+    etag = '\\"' + hashlib.sha256(compressed).hexdigest()[:16] + '\\"'
+    return {
+        "filename": filename,
+        "symbol": symbol_for(filename),
+        "content_type": CONTENT_TYPES.get(ext, "application/octet-stream"),
+        "source_size": len(source.encode("utf-8")),
+        "minified_size": len(minified),
+        "data": compressed,
+        "etag": etag,
+    }
+
+
+def render_header(assets):
+    out = []
+    out.append("// Automatisch erzeugt von tools/build_web_assets.py - nicht von Hand bearbeiten!")
+    out.append("// Quellen: web/")
+    out.append("#ifndef WEB_ASSETS_H")
+    out.append("#define WEB_ASSETS_H")
+    out.append("")
+    out.append("#include <Arduino.h>")
+    out.append("")
+    out.append("struct WebAsset {")
+    out.append("    const uint8_t* data;       // gzip-komprimierter Inhalt im Flash")
+    out.append("    size_t length;")
+    out.append("    const char* contentType;")
+    out.append("    const char* etag;          // Starker ETag über die komprimierten Bytes")
+    out.append("};")
+    for asset in assets:
+        out.append("")
+        out.append("// %s: %d Bytes, minifiziert %d, gzip %d" % (
+            asset["filename"], asset["source_size"], asset["minified_size"], len(asset["data"])))
+        out.append("static const uint8_t WEB_%s_GZ[] PROGMEM = {" % asset["symbol"])
+        data = asset["data"]
+        for i in range(0, len(data), 16):
+            out.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+        out.append("};")
+        out.append('static const WebAsset WEB_ASSET_%s = { WEB_%s_GZ, sizeof(WEB_%s_GZ), "%s", "%s" };' % (
+            asset["symbol"], asset["symbol"], asset["symbol"], asset["content_type"], asset["etag"]))
+    out.append("")
+    out.append("#endif // WEB_ASSETS_H")
+    out.append("")
+    return "\n".join(out)
+
+
+def main():
+    files = sorted(
+        os.path.join(WEB_DIR, name) for name in os.listdir(WEB_DIR)
+        if os.path.splitext(name)[1].lower() in CONTENT_TYPES
+    )
+    assets = [build_asset(path) for path in files]
+    header = render_header(assets)
+
+    # Nur schreiben, wenn sich etwas geändert hat - sonst baut PlatformIO jedes Mal neu
+    if os.path.exists(OUTPUT_FILE):
+        with open(OUTPUT_FILE, "r", encoding="utf-8") as f:
+            if f.read() == header:
+                return
+
+    with open(OUTPUT_FILE, "w", encoding="utf-8") as f:
+        f.write(header)
+
+    for asset in assets:
+        print("Web-Asset %-14s %6d -> %6d Bytes (gzip), ETag %s" % (
+            asset["filename"], asset["source_size"], len(asset["data"]), asset["etag"].replace('\\"', "")))
+
+
+main()